@@ -0,0 +1,314 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "bank_archive.h"
+#include "bank_lz.h"
+#include "bank_money.h"
+
+#define ARCHIVE_MAGIC 0x524B4E42u   // "BNKR"
+#define ARCHIVE_VERSION 1
+
+// Type byte of a record: the LedgerType, plus flags for values stored as their float bits. Only
+// archives written while amounts were floats have them (for values that were not whole cents);
+// they read back rounded to the paisa.
+#define ARCHIVE_TYPE_MASK 0x0f
+#define ARCHIVE_RAW_AMOUNT 0x10
+#define ARCHIVE_RAW_BALANCE 0x20
+
+// Column bytes per record at most: timestamp 10, account 5, type 1, amount 10, balance 10
+#define ARCHIVE_MAX_RECORD_BYTES 36
+#define ARCHIVE_BALANCE_SLOTS 2048  // power of two, at least twice ARCHIVE_BLOCK_RECORDS
+
+// File layout: header, block directory, then the compressed blocks
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    int count;
+    int blockRecords;
+    int blocks;
+    unsigned int directoryCrc;
+} ArchiveHeader;
+
+// Last balance seen for an account while a block is encoded or decoded
+typedef struct {
+    int account_number;     // 0 = empty
+    int known;              // cents holds the balance (0 after a balance stored as float bits)
+    long long cents;
+} BalanceSlot;
+
+unsigned int crcTable[256];
+pthread_once_t crcTableOnce = PTHREAD_ONCE_INIT;
+
+void initCrcTable() {
+    for (unsigned int i = 0; i < 256; i++) {
+        unsigned int c = i;
+        for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crcTable[i] = c;
+    }
+}
+
+// CRC-32 (the zlib/gzip polynomial)
+unsigned int archiveCrc(const void *data, size_t size) {
+    pthread_once(&crcTableOnce, initCrcTable);
+    const unsigned char *p = (const unsigned char *)data;
+    unsigned int c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) c = crcTable[(c ^ p[i]) & 0xff] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+void putVarint(unsigned char *out, int *pos, unsigned long long v) {
+    while (v >= 0x80) {
+        out[(*pos)++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    out[(*pos)++] = (unsigned char)v;
+}
+
+int getVarint(const unsigned char *in, int size, int *pos, unsigned long long *v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= size) return 0;
+        unsigned char b = in[(*pos)++];
+        *v |= (unsigned long long)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return 1;
+    }
+    return 0;
+}
+
+unsigned long long zigzag(long long v) {
+    return ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63);
+}
+
+long long unzigzag(unsigned long long v) {
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+// A value stored as float bits by an old archive
+Money floatBitsMoney(const unsigned char *in) {
+    float value;
+    memcpy(&value, in, sizeof(float));
+    return moneyFromDouble(value);
+}
+
+BalanceSlot *balanceSlot(BalanceSlot *slots, int account_number) {
+    unsigned int h = (unsigned int)account_number * 0x9E3779B1u;
+    unsigned int slot = (h >> 21) & (ARCHIVE_BALANCE_SLOTS - 1);
+    while (slots[slot].account_number != 0 && slots[slot].account_number != account_number) {
+        slot = (slot + 1) & (ARCHIVE_BALANCE_SLOTS - 1);
+    }
+    slots[slot].account_number = account_number;
+    return &slots[slot];
+}
+
+// The balance a record should show: the account's previous balance in the block moved by the
+// amount (known = 0 when there is nothing to predict from)
+long long predictBalance(const BalanceSlot *slot, int type, int amountKnown, long long amountCents) {
+    if (!slot->known) return 0;
+    if (amountKnown && (type == LEDGER_DEPOSIT || type == LEDGER_INTEREST)) return slot->cents + amountCents;
+    if (amountKnown && type == LEDGER_WITHDRAW) return slot->cents - amountCents;
+    return slot->cents;
+}
+
+// Column-encode n records into out (room for n * ARCHIVE_MAX_RECORD_BYTES); returns the size
+int encodeBlock(const LedgerRecord *records, int n, unsigned char *out) {
+    BalanceSlot slots[ARCHIVE_BALANCE_SLOTS];
+    memset(slots, 0, sizeof(slots));
+    int pos = 0;
+
+    long long previousTime = 0;
+    for (int i = 0; i < n; i++) {
+        putVarint(out, &pos, zigzag(records[i].timestamp - previousTime));
+        previousTime = records[i].timestamp;
+    }
+    int previousAccount = 0;
+    for (int i = 0; i < n; i++) {
+        putVarint(out, &pos, zigzag((long long)records[i].account_number - previousAccount));
+        previousAccount = records[i].account_number;
+    }
+    for (int i = 0; i < n; i++) {
+        out[pos++] = (unsigned char)(records[i].type & ARCHIVE_TYPE_MASK);
+    }
+    for (int i = 0; i < n; i++) {
+        putVarint(out, &pos, zigzag(records[i].amount));
+    }
+    for (int i = 0; i < n; i++) {
+        BalanceSlot *slot = balanceSlot(slots, records[i].account_number);
+        long long predicted = predictBalance(slot, records[i].type & ARCHIVE_TYPE_MASK, 1, records[i].amount);
+        putVarint(out, &pos, zigzag(records[i].balance - predicted));
+        slot->known = 1;
+        slot->cents = records[i].balance;
+    }
+    return pos;
+}
+
+// Decode a block written by encodeBlock(); returns 1 if it held exactly n records
+int decodeBlock(const unsigned char *in, int size, LedgerRecord *records, int n) {
+    BalanceSlot slots[ARCHIVE_BALANCE_SLOTS];
+    long long amounts[ARCHIVE_BLOCK_RECORDS];
+    unsigned char types[ARCHIVE_BLOCK_RECORDS];
+    memset(slots, 0, sizeof(slots));
+    if (n > ARCHIVE_BLOCK_RECORDS) return 0;
+    int pos = 0;
+    unsigned long long v;
+
+    long long previousTime = 0;
+    for (int i = 0; i < n; i++) {
+        if (!getVarint(in, size, &pos, &v)) return 0;
+        records[i].timestamp = previousTime + unzigzag(v);
+        previousTime = records[i].timestamp;
+    }
+    long long previousAccount = 0;
+    for (int i = 0; i < n; i++) {
+        if (!getVarint(in, size, &pos, &v)) return 0;
+        previousAccount += unzigzag(v);
+        records[i].account_number = (int)previousAccount;
+    }
+    if (size - pos < n) return 0;
+    for (int i = 0; i < n; i++) {
+        types[i] = in[pos++];
+        records[i].type = types[i] & ARCHIVE_TYPE_MASK;
+    }
+    for (int i = 0; i < n; i++) {
+        if (types[i] & ARCHIVE_RAW_AMOUNT) {
+            if (size - pos < (int)sizeof(float)) return 0;
+            records[i].amount = floatBitsMoney(in + pos);
+            pos += sizeof(float);
+            amounts[i] = 0;
+        } else {
+            if (!getVarint(in, size, &pos, &v)) return 0;
+            amounts[i] = unzigzag(v);
+            records[i].amount = amounts[i];
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        BalanceSlot *slot = balanceSlot(slots, records[i].account_number);
+        if (types[i] & ARCHIVE_RAW_BALANCE) {
+            if (size - pos < (int)sizeof(float)) return 0;
+            records[i].balance = floatBitsMoney(in + pos);
+            pos += sizeof(float);
+            slot->known = 0;
+        } else {
+            if (!getVarint(in, size, &pos, &v)) return 0;
+            long long predicted = predictBalance(slot, types[i] & ARCHIVE_TYPE_MASK, !(types[i] & ARCHIVE_RAW_AMOUNT), amounts[i]);
+            slot->known = 1;
+            slot->cents = predicted + unzigzag(v);
+            records[i].balance = slot->cents;
+        }
+    }
+    return pos == size;
+}
+
+long long archiveWrite(FILE *file, const LedgerRecord *records, int count) {
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.count = count;
+    header.blockRecords = ARCHIVE_BLOCK_RECORDS;
+    header.blocks = (count + ARCHIVE_BLOCK_RECORDS - 1) / ARCHIVE_BLOCK_RECORDS;
+    ArchiveBlock *directory = (ArchiveBlock *)calloc(header.blocks > 0 ? header.blocks : 1, sizeof(ArchiveBlock));
+    int rawCapacity = ARCHIVE_BLOCK_RECORDS * ARCHIVE_MAX_RECORD_BYTES;
+    unsigned char *raw = (unsigned char *)malloc(rawCapacity);
+    unsigned char *packed = (unsigned char *)malloc(LZ_COMPRESS_BOUND(rawCapacity));
+
+    // Blocks first, after room for the header and directory, which are written last
+    long long offset = (long long)sizeof(header) + (long long)header.blocks * (long long)sizeof(ArchiveBlock);
+    int ok = fseek(file, (long)offset, SEEK_SET) == 0;
+    for (int b = 0; b < header.blocks && ok; b++) {
+        int n = count - b * ARCHIVE_BLOCK_RECORDS;
+        if (n > ARCHIVE_BLOCK_RECORDS) n = ARCHIVE_BLOCK_RECORDS;
+        int rawSize = encodeBlock(records + b * ARCHIVE_BLOCK_RECORDS, n, raw);
+        int size = lzCompress(raw, rawSize, packed, LZ_COMPRESS_BOUND(rawCapacity));
+        ok = size >= 0 && fwrite(packed, 1, size, file) == (size_t)size;
+        directory[b].offset = offset;
+        directory[b].size = size;
+        directory[b].rawSize = rawSize;
+        directory[b].records = n;
+        directory[b].crc = ok ? archiveCrc(packed, size) : 0;
+        offset += size;
+    }
+    header.directoryCrc = archiveCrc(directory, header.blocks * sizeof(ArchiveBlock));
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1 &&
+         fwrite(directory, sizeof(ArchiveBlock), header.blocks, file) == (size_t)header.blocks && fflush(file) == 0;
+    free(directory);
+    free(raw);
+    free(packed);
+    return ok ? offset : -1;
+}
+
+int archiveOpen(ArchiveReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->cachedBlock = -1;
+    reader->file = fopen(path, "rb");
+    if (!reader->file) return 0;
+    ArchiveHeader header;
+    int ok = fread(&header, sizeof(header), 1, reader->file) == 1 && header.magic == ARCHIVE_MAGIC &&
+             header.version == ARCHIVE_VERSION && header.blockRecords > 0 && header.blockRecords <= ARCHIVE_BLOCK_RECORDS &&
+             header.count >= 0 && header.blocks == (header.count + header.blockRecords - 1) / header.blockRecords;
+    if (ok) {
+        reader->directory = (ArchiveBlock *)malloc((header.blocks > 0 ? header.blocks : 1) * sizeof(ArchiveBlock));
+        ok = fread(reader->directory, sizeof(ArchiveBlock), header.blocks, reader->file) == (size_t)header.blocks &&
+             archiveCrc(reader->directory, header.blocks * sizeof(ArchiveBlock)) == header.directoryCrc;
+    }
+    for (int b = 0; b < header.blocks && ok; b++) {
+        const ArchiveBlock *block = &reader->directory[b];
+        int expected = b < header.blocks - 1 ? header.blockRecords : header.count - b * header.blockRecords;
+        ok = block->records == expected && block->size >= 0 && block->rawSize >= 0 &&
+             block->rawSize <= block->records * ARCHIVE_MAX_RECORD_BYTES && block->size <= LZ_COMPRESS_BOUND(block->rawSize);
+        if (block->size > reader->bufferSize) reader->bufferSize = block->size;
+        if (block->rawSize > reader->bufferSize) reader->bufferSize = block->rawSize;
+    }
+    if (!ok) {
+        archiveClose(reader);
+        return 0;
+    }
+    reader->count = header.count;
+    reader->blocks = header.blocks;
+    reader->cache = (LedgerRecord *)malloc(header.blockRecords * sizeof(LedgerRecord));
+    reader->compressed = (unsigned char *)malloc(reader->bufferSize > 0 ? reader->bufferSize : 1);
+    reader->raw = (unsigned char *)malloc(reader->bufferSize > 0 ? reader->bufferSize : 1);
+    return 1;
+}
+
+void archiveClose(ArchiveReader *reader) {
+    if (reader->file) fclose(reader->file);
+    free(reader->directory);
+    free(reader->cache);
+    free(reader->compressed);
+    free(reader->raw);
+    memset(reader, 0, sizeof(*reader));
+    reader->cachedBlock = -1;
+}
+
+// Read, check and decode one block into the cache
+int archiveLoadBlock(ArchiveReader *reader, int b) {
+    if (b == reader->cachedBlock) return 1;
+    const ArchiveBlock *block = &reader->directory[b];
+    reader->cachedBlock = -1;
+    if (fseek(reader->file, (long)block->offset, SEEK_SET) != 0) return 0;
+    if (fread(reader->compressed, 1, block->size, reader->file) != (size_t)block->size) return 0;
+    if (archiveCrc(reader->compressed, block->size) != block->crc) return 0;
+    if (lzDecompress(reader->compressed, block->size, reader->raw, block->rawSize) != block->rawSize) return 0;
+    if (!decodeBlock(reader->raw, block->rawSize, reader->cache, block->records)) return 0;
+    reader->cachedBlock = b;
+    return 1;
+}
+
+int archiveRead(ArchiveReader *reader, int index, LedgerRecord *rec) {
+    if (!reader->file || index < 0 || index >= reader->count) return 0;
+    int blockRecords = reader->directory[0].records;
+    if (!archiveLoadBlock(reader, index / blockRecords)) return 0;
+    *rec = reader->cache[index % blockRecords];
+    return 1;
+}
+
+int archiveReadAll(ArchiveReader *reader, LedgerRecord *records) {
+    int n = 0;
+    for (int b = 0; b < reader->blocks; b++) {
+        if (!archiveLoadBlock(reader, b)) return -1;
+        memcpy(records + n, reader->cache, reader->directory[b].records * sizeof(LedgerRecord));
+        n += reader->directory[b].records;
+    }
+    return n;
+}
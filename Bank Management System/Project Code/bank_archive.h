@@ -0,0 +1,56 @@
+#ifndef BANK_ARCHIVE_H
+#define BANK_ARCHIVE_H
+
+#include <stdio.h>
+#include "bank_core.h"
+
+// Cold-tier ledger archive. An old, sealed ledger segment is rewritten as an archive file of
+// compressed blocks that decode back to the same records in the same order, so ledger positions
+// stay valid and history reads decompress one block on demand.
+// Each block is column-encoded first - delta timestamps and account numbers, amounts as cents,
+// balances as the difference from the account's previous balance in the block plus or minus the
+// amount (zero for ordinary postings) - then compressed with bank_lz.c and CRC-32 checked.
+
+#define ARCHIVE_BLOCK_RECORDS 1024
+
+typedef struct {
+    long long offset;       // of the compressed block in the file
+    int size;               // compressed bytes
+    int rawSize;            // column-encoded bytes before compression
+    int records;
+    unsigned int crc;       // CRC-32 of the compressed bytes
+} ArchiveBlock;
+
+// Reader with a one-block cache, so reading consecutive records decodes each block once
+typedef struct {
+    FILE *file;
+    int count;              // records in the archive
+    int blocks;
+    ArchiveBlock *directory;
+    int cachedBlock;        // -1 = none
+    LedgerRecord *cache;
+    unsigned char *compressed;
+    unsigned char *raw;
+    int bufferSize;
+} ArchiveReader;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Write count records as an archive to file (opened "wb"); returns the bytes written, -1 on error
+long long archiveWrite(FILE *file, const LedgerRecord *records, int count);
+
+// Open an archive and check its directory; returns 1 on success
+int archiveOpen(ArchiveReader *reader, const char *path);
+void archiveClose(ArchiveReader *reader);
+// Read record index, decompressing its block if it is not the cached one; returns 1 on success
+int archiveRead(ArchiveReader *reader, int index, LedgerRecord *rec);
+// Decode every record into records (room for reader->count); returns how many, -1 on a damaged block
+int archiveReadAll(ArchiveReader *reader, LedgerRecord *records);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,686 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "bank_core.h"
+#include "bank_money.h"
+#include "bank_velocity.h"
+#include "bank_interest.h"
+
+// Benchmark for the banking core - builds a synthetic data set of N accounts plus their
+// transactions in bench_data/accounts_<N>/, then times every operation at that size.
+// Deposits and withdrawals include the velocity rule check; "velocity" replays the ledger
+// through the rule engine on its own. "scan_records" and "scan_columns" total every balance,
+// once through whole Account records as they were held before the hot/cold split and once
+// through the balance column. "interest_scalar" and "interest_simd" time the interest kernel on
+// its own over n synthetic balances; "interest" is a whole run with its ledger entries and files.
+// "parse_sscanf" and "parse_record" read back an accounts.txt of n records, once with the
+// sscanf format the record parser replaced and once with accountParseRecord(); "format_printf"
+// and "format_record" write the lines the same two ways.
+//
+// Usage: bank_bench [sizes...]          (default: 10000 100000 1000000)
+//        e.g. bank_bench 10000 10000000
+//
+// Each result is one JSON object per line on stdout, so runs can be diffed or plotted:
+//   {"accounts":100000,"op":"deposit","count":100000,"seconds":0.41,"ops_per_sec":243902,"p50_us":3.1,"p99_us":9.8,"p999_us":41.0}
+// A readable table goes to stderr.
+
+#define BENCH_MAX_OPS 100000       // login/deposit/withdraw/update samples per size
+#define BENCH_HISTORY_VIEWS 1000   // accounts whose full history is read back
+#define BENCH_DELETES 200
+#define BENCH_COMMIT_OPS 5000      // durable (fsynced) deposits per commit mode
+#define BENCH_COMMIT_THREADS 16
+#define BENCH_COMMIT_MICROS 1000   // group commit latency budget
+#define BENCH_RECONCILE_POSTINGS 1000   // deposits between the full and the incremental reconciliation
+#define BENCH_SCANS 20             // passes of each balance scan
+#define BENCH_INTEREST_PASSES 5    // passes of each interest kernel
+#define BENCH_PARSE_FILE "accounts.txt"
+
+double nowSeconds() {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+// xorshift64 - reproducible account picks across runs
+unsigned long long benchRandomState = 88172645463325252ULL;
+
+unsigned long long benchRandom() {
+    benchRandomState ^= benchRandomState << 13;
+    benchRandomState ^= benchRandomState >> 7;
+    benchRandomState ^= benchRandomState << 17;
+    return benchRandomState;
+}
+
+int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+double percentile(const double *sorted, long n, double p) {
+    if (n == 0) return 0.0;
+    long i = (long)(p * (n - 1) + 0.5);
+    return sorted[i];
+}
+
+// Sort the latency samples of one operation and print its line of results.
+// Throughput is n / seconds; concurrent runs pass their wall-clock time.
+void reportOpTimed(long accounts, const char *op, double *samples, long n, double total) {
+    qsort(samples, n, sizeof(double), compareDoubles);
+    double p50 = percentile(samples, n, 0.50) * 1e6;
+    double p99 = percentile(samples, n, 0.99) * 1e6;
+    double p999 = percentile(samples, n, 0.999) * 1e6;
+    double rate = total > 0 ? n / total : 0.0;
+    printf("{\"accounts\":%ld,\"op\":\"%s\",\"count\":%ld,\"seconds\":%.6f,\"ops_per_sec\":%.0f,\"p50_us\":%.2f,\"p99_us\":%.2f,\"p999_us\":%.2f}\n",
+           accounts, op, n, total, rate, p50, p99, p999);
+    fflush(stdout);
+    fprintf(stderr, "%10ld  %-9s %9ld ops %10.0f ops/s   p50 %9.2f us   p99 %9.2f us   p999 %9.2f us\n",
+            accounts, op, n, rate, p50, p99, p999);
+}
+
+// Sequential runs: the time taken is the sum of the samples
+void reportOp(long accounts, const char *op, double *samples, long n) {
+    double total = 0.0;
+    for (long i = 0; i < n; i++) total += samples[i];
+    reportOpTimed(accounts, op, samples, n, total);
+}
+
+void makeDirectory(const char *path) {
+#ifdef _WIN32
+    _mkdir(path);
+#else
+    mkdir(path, 0755);
+#endif
+}
+
+int changeDirectory(const char *path) {
+#ifdef _WIN32
+    return _chdir(path);
+#else
+    return chdir(path);
+#endif
+}
+
+// Remove the data files of an earlier run so every size starts from empty
+void clearDataFiles() {
+    remove("accounts.dat");
+    remove(BENCH_PARSE_FILE);
+    remove("accounts.col");
+    remove("accounts.cls");
+    remove("interest.run");
+    remove("accounts.journal");
+    remove("accounts.seq");
+    remove("bank.ckpt");
+    remove("bank.ckpt.delta");
+    remove("reconcile.ckpt");
+    remove("reconcile.csv");
+    for (int segment = 0; ; segment++) {
+        char filename[32];
+        char archive[32];
+        sprintf(filename, "ledger_%04d.seg", segment);
+        sprintf(archive, "ledger_%04d.arc", segment);
+        int removed = remove(filename) == 0;
+        if (remove(archive) == 0) removed = 1;
+        if (!removed) break;
+    }
+}
+
+long fileSize(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Bytes of ledger on disk - plain segments and archived ones
+long long ledgerFootprint() {
+    long long total = 0;
+    for (int segment = 0; ; segment++) {
+        char filename[32];
+        sprintf(filename, "ledger_%04d.seg", segment);
+        long plain = fileSize(filename);
+        sprintf(filename, "ledger_%04d.arc", segment);
+        long archived = fileSize(filename);
+        if (plain < 0 && archived < 0) break;
+        if (plain > 0) total += plain;
+        if (archived > 0) total += archived;
+    }
+    return total;
+}
+
+void syntheticAccount(long i, Account *acc) {
+    memset(acc, 0, sizeof(*acc));
+    sprintf(acc->name, "Customer %ld", i);
+    sprintf(acc->father_name, "Father %ld", i);
+    sprintf(acc->mobile_number, "03%09ld", i);
+    sprintf(acc->address, "House %ld, Street %ld, Karachi", i, i % 500);
+    sprintf(acc->password, "pw%ld", i);
+}
+
+// One posting thread of the group commit run - its samples go to samples[first..first+count)
+typedef struct {
+    long first;
+    long count;
+    long accounts;
+    double *samples;
+} CommitWorker;
+
+void *commitWorker(void *arg) {
+    CommitWorker *w = (CommitWorker *)arg;
+    unsigned long long state = 0x9E3779B97F4A7C15ULL * (unsigned long long)(w->first + 1);
+    for (long i = 0; i < w->count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int account_number = 2500 + (int)(state % (unsigned long long)w->accounts);
+        double t = nowSeconds();
+        bankDeposit(account_number, 100, NULL);
+        w->samples[w->first + i] = nowSeconds() - t;
+    }
+    return NULL;
+}
+
+// Durable deposits: one fsync per posting from a single caller, then group commit with
+// BENCH_COMMIT_THREADS concurrent callers sharing each fsync
+void runCommitBench(long n, double *samples, long ops) {
+    bankSetGroupCommit(0, 0);
+    long long rounds = bankCommitRounds();
+    for (long i = 0; i < ops; i++) {
+        int account_number = 2500 + (int)(benchRandom() % n);
+        double t = nowSeconds();
+        bankDeposit(account_number, 100, NULL);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "deposit_fsync", samples, ops);
+    fprintf(stderr, "%10s  %lld fsync rounds\n", "", bankCommitRounds() - rounds);
+
+    bankSetGroupCommit(BENCH_COMMIT_MICROS, 0);
+    rounds = bankCommitRounds();
+    pthread_t threads[BENCH_COMMIT_THREADS];
+    CommitWorker workers[BENCH_COMMIT_THREADS];
+    double start = nowSeconds();
+    for (int k = 0; k < BENCH_COMMIT_THREADS; k++) {
+        workers[k].first = ops * k / BENCH_COMMIT_THREADS;
+        workers[k].count = ops * (k + 1) / BENCH_COMMIT_THREADS - workers[k].first;
+        workers[k].accounts = n;
+        workers[k].samples = samples;
+        pthread_create(&threads[k], NULL, commitWorker, &workers[k]);
+    }
+    for (int k = 0; k < BENCH_COMMIT_THREADS; k++) {
+        pthread_join(threads[k], NULL);
+    }
+    double wall = nowSeconds() - start;
+    reportOpTimed(n, "deposit_group", samples, ops, wall);
+    fprintf(stderr, "%10s  %lld fsync rounds across %d threads\n", "", bankCommitRounds() - rounds, BENCH_COMMIT_THREADS);
+    bankSetGroupCommit(-1, 0);
+}
+
+// Replay the deposits and withdrawals of the ledger segments through the velocity rules, with a
+// fresh state per account as the core keeps it. Throughput comes from an untimed pass, latency
+// from a second pass that times every event.
+void runVelocityBench(long n) {
+    long capacity = 1 << 16;
+    long events = 0;
+    LedgerRecord *records = (LedgerRecord *)malloc(capacity * sizeof(LedgerRecord));
+    for (int segment = 0; ; segment++) {
+        char filename[32];
+        sprintf(filename, "ledger_%04d.seg", segment);
+        FILE *file = fopen(filename, "rb");
+        if (!file) break;
+        LedgerRecord rec;
+        while (fread(&rec, sizeof(rec), 1, file) == 1) {
+            if (rec.type != LEDGER_DEPOSIT && rec.type != LEDGER_WITHDRAW) continue;
+            if (rec.account_number < 2500 || rec.account_number >= 2500 + n) continue;
+            if (events == capacity) {
+                capacity *= 2;
+                records = (LedgerRecord *)realloc(records, capacity * sizeof(LedgerRecord));
+            }
+            records[events++] = rec;
+        }
+        fclose(file);
+    }
+
+    VelocityRule rules[VELOCITY_MAX_RULES];
+    int ruleCount = velocityParseRules(velocityDefaultRules, rules, VELOCITY_MAX_RULES);
+    VelocityState **states = (VelocityState **)calloc(n, sizeof(VelocityState *));
+    double *samples = (double *)malloc((events > 0 ? events : 1) * sizeof(double));
+    long held = 0;
+    double wall = 0.0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (long i = 0; i < n; i++) {
+            if (states[i]) velocityReset(states[i]);
+        }
+        double start = nowSeconds();
+        for (long i = 0; i < events; i++) {
+            const LedgerRecord *rec = &records[i];
+            double t = pass == 1 ? nowSeconds() : 0.0;
+            VelocityState **state = &states[rec->account_number - 2500];
+            if (!*state) {
+                *state = (VelocityState *)malloc(sizeof(VelocityState));
+                velocityReset(*state);
+            }
+            if (velocityCheck(*state, rules, ruleCount, rec->type, rec->timestamp, rec->amount) != VELOCITY_ALLOW && pass == 0) held++;
+            velocityRecord(*state, rec->type, rec->timestamp, rec->amount);
+            if (pass == 1) samples[i] = nowSeconds() - t;
+        }
+        if (pass == 0) wall = nowSeconds() - start;
+    }
+    reportOpTimed(n, "velocity", samples, events, wall);
+    fprintf(stderr, "%10s  %ld of %ld replayed postings would need verification or be blocked\n", "", held, events);
+
+    for (long i = 0; i < n; i++) free(states[i]);
+    free(states);
+    free(samples);
+    free(records);
+}
+
+// Total every balance, first over a heap copy of the accounts.dat records (248-byte strides,
+// the layout the table had before the hot/cold split), then over the balance column
+void runScanBench(long n, double *samples) {
+    FILE *file = fopen("accounts.dat", "rb");
+    if (!file) return;
+    unsigned int header[4];
+    Account *records = NULL;
+    long count = 0;
+    if (fread(header, sizeof(header), 1, file) == 1) {
+        count = (long)header[3];
+        records = (Account *)malloc((count > 0 ? count : 1) * sizeof(Account));
+        if (fread(records, sizeof(Account), count, file) != (size_t)count) count = 0;
+    }
+    fclose(file);
+
+    Money total = 0;
+    for (int pass = 0; pass <= BENCH_SCANS; pass++) {   // pass 0 warms the cache, untimed
+        double t = nowSeconds();
+        Money sum = 0;
+        for (long i = 0; i < count; i++) sum += records[i].balance;
+        if (pass > 0) samples[pass - 1] = nowSeconds() - t;
+        total = sum;
+    }
+    reportOp(n, "scan_records", samples, BENCH_SCANS);
+    double recordTime = samples[BENCH_SCANS / 2];
+    free(records);
+
+    Money columnTotal = 0;
+    for (int pass = 0; pass <= BENCH_SCANS; pass++) {
+        double t = nowSeconds();
+        columnTotal = bankTotalBalance();
+        if (pass > 0) samples[pass - 1] = nowSeconds() - t;
+    }
+    reportOp(n, "scan_columns", samples, BENCH_SCANS);
+    double columnTime = samples[BENCH_SCANS / 2];
+    char totalText[MONEY_TEXT_MAX], columnText[MONEY_TEXT_MAX];
+    moneyFormat(total, totalText);
+    moneyFormat(columnTotal, columnText);
+    fprintf(stderr, "%10s  total %s / %s, median scan %.2f ms -> %.2f ms (%.1fx)\n", "", totalText, columnText,
+            recordTime * 1e3, columnTime * 1e3, columnTime > 0 ? recordTime / columnTime : 0.0);
+}
+
+// The interest kernels over n balances of up to 2 million in the default classes (90% savings,
+// 7% current, 3% premium), then a real one-day run over the data set
+void runInterestBench(long n, double *samples) {
+    InterestRates rates;
+    InterestTable table;
+    interestParseRates(interestDefaultRates, &rates);
+    interestPrepare(&rates, 1, &table);
+    long long *cents = (long long *)malloc(n * sizeof(long long));
+    unsigned char *classes = (unsigned char *)malloc(n);
+    long long *scalar = (long long *)malloc(n * sizeof(long long));
+    long long *simd = (long long *)malloc(n * sizeof(long long));
+    memset(scalar, 0, n * sizeof(long long));   // fault the pages in before timing
+    memset(simd, 0, n * sizeof(long long));
+    for (long i = 0; i < n; i++) {
+        cents[i] = (long long)(benchRandom() % 200000000ULL);
+        int pick = (int)(benchRandom() % 100);
+        classes[i] = (unsigned char)(pick < 90 ? 0 : pick < 97 ? 1 : 2);
+    }
+    for (int pass = 0; pass < BENCH_INTEREST_PASSES; pass++) {
+        double t = nowSeconds();
+        interestAccrueScalar(&table, cents, classes, scalar, (int)n);
+        samples[pass] = nowSeconds() - t;
+    }
+    reportOp(n, "interest_scalar", samples, BENCH_INTEREST_PASSES);
+    double scalarTime = samples[BENCH_INTEREST_PASSES / 2];
+    for (int pass = 0; pass < BENCH_INTEREST_PASSES; pass++) {
+        double t = nowSeconds();
+        interestAccrue(&table, cents, classes, simd, (int)n);
+        samples[pass] = nowSeconds() - t;
+    }
+    reportOp(n, "interest_simd", samples, BENCH_INTEREST_PASSES);
+    double simdTime = samples[BENCH_INTEREST_PASSES / 2];
+    int same = memcmp(scalar, simd, n * sizeof(long long)) == 0;
+    fprintf(stderr, "%10s  %s kernel %.1fx the scalar one, %s results\n", "", interestKernelName(),
+            simdTime > 0 ? scalarTime / simdTime : 0.0, same ? "same" : "DIFFERENT");
+    free(cents);
+    free(classes);
+    free(scalar);
+    free(simd);
+
+    Money total = 0;
+    double t = nowSeconds();
+    int credited = bankAccrueInterest(1, &total);
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "interest", samples, 1);
+    char totalText[MONEY_TEXT_MAX];
+    moneyFormat(total, totalText);
+    fprintf(stderr, "%10s  %d accounts credited %s\n", "", credited, totalText);
+}
+
+// Write an accounts.txt of n records with printf and with accountFormatRecord(), then parse it
+// back from memory with the old sscanf format and with accountParseRecord(). Throughput comes
+// from an untimed pass, latency from a second pass that times every line, as in the velocity run.
+void runParseBench(long n, double *samples) {
+    FILE *file = fopen(BENCH_PARSE_FILE, "wb");
+    if (!file) return;
+    Account acc;
+    char line[ACCOUNT_RECORD_MAX + 1];
+    double wall = 0.0;
+    for (int pass = 0; pass < 2; pass++) {
+        double start = nowSeconds();
+        for (long i = 0; i < n; i++) {
+            double t = pass == 1 ? nowSeconds() : 0.0;
+            syntheticAccount(i, &acc);
+            sprintf(acc.address, "House %ld Street %ld Karachi", i, i % 500);   // the record has no quoting
+            acc.account_number = 2500 + (int)i;
+            acc.balance = (Money)(benchRandom() % 200000000ULL);
+            fprintf(file, "%s,%s,%s,%s,%s,%d,%.2f\n", acc.name, acc.father_name, acc.mobile_number, acc.address,
+                    acc.password, acc.account_number, (double)acc.balance / 100.0);
+            if (pass == 1) samples[i] = nowSeconds() - t;
+        }
+        if (pass == 0) wall = nowSeconds() - start;
+    }
+    reportOpTimed(n, "format_printf", samples, n, wall);
+    double printfTime = wall;
+    fclose(file);
+
+    file = fopen(BENCH_PARSE_FILE, "wb");
+    if (!file) return;
+    for (int pass = 0; pass < 2; pass++) {
+        double start = nowSeconds();
+        for (long i = 0; i < n; i++) {
+            double t = pass == 1 ? nowSeconds() : 0.0;
+            syntheticAccount(i, &acc);
+            sprintf(acc.address, "House %ld Street %ld Karachi", i, i % 500);   // the record has no quoting
+            acc.account_number = 2500 + (int)i;
+            acc.balance = (Money)(benchRandom() % 200000000ULL);
+            int length = accountFormatRecord(&acc, line);
+            line[length++] = '\n';
+            fwrite(line, 1, length, file);
+            if (pass == 1) samples[i] = nowSeconds() - t;
+        }
+        if (pass == 0) wall = nowSeconds() - start;
+    }
+    reportOpTimed(n, "format_record", samples, n, wall);
+    fprintf(stderr, "%10s  record formatter %.1fx printf\n", "", wall > 0 ? printfTime / wall : 0.0);
+    fclose(file);
+
+    // Parse the second pass's n lines, held in memory and split at the newlines as fgets()
+    // would hand them over, so only the parsing is timed
+    long size = fileSize(BENCH_PARSE_FILE);
+    char *text = (char *)malloc(size + 1);
+    file = fopen(BENCH_PARSE_FILE, "rb");
+    if (!file || fread(text, 1, size, file) != (size_t)size) {
+        if (file) fclose(file);
+        free(text);
+        remove(BENCH_PARSE_FILE);
+        return;
+    }
+    fclose(file);
+    text[size] = '\0';
+    for (long i = 0; i < size; i++) {
+        if (text[i] == '\n') text[i] = '\0';
+    }
+    const char *start = text;
+    for (long i = 0; i < n; i++) start += strlen(start) + 1;
+
+    long parsed = 0;
+    Money total = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        const char *p = start;
+        double begin = nowSeconds();
+        for (long i = 0; i < n; i++) {
+            double t = pass == 1 ? nowSeconds() : 0.0;
+            float balance;
+            if (sscanf(p, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", acc.name, acc.father_name,
+                       acc.mobile_number, acc.address, acc.password, &acc.account_number, &balance) == 7 && pass == 0) {
+                parsed++;
+                total += moneyFromDouble(balance);
+            }
+            p += strlen(p) + 1;
+            if (pass == 1) samples[i] = nowSeconds() - t;
+        }
+        if (pass == 0) wall = nowSeconds() - begin;
+    }
+    reportOpTimed(n, "parse_sscanf", samples, n, wall);
+    double sscanfTime = wall;
+    long sscanfParsed = parsed;
+    Money sscanfTotal = total;
+
+    parsed = 0;
+    total = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        const char *p = start;
+        double begin = nowSeconds();
+        for (long i = 0; i < n; i++) {
+            double t = pass == 1 ? nowSeconds() : 0.0;
+            int used = accountParseRecord(p, &acc);
+            if (used > 0 && pass == 0) {
+                parsed++;
+                total += acc.balance;
+            }
+            p += used + strlen(p + used) + 1;
+            if (pass == 1) samples[i] = nowSeconds() - t;
+        }
+        if (pass == 0) wall = nowSeconds() - begin;
+    }
+    reportOpTimed(n, "parse_record", samples, n, wall);
+    char sscanfText[MONEY_TEXT_MAX], recordText[MONEY_TEXT_MAX];
+    moneyFormat(sscanfTotal, sscanfText);
+    moneyFormat(total, recordText);
+    fprintf(stderr, "%10s  record parser %.1fx sscanf; %ld / %ld records, balances %s / %s\n", "",
+            wall > 0 ? sscanfTime / wall : 0.0, sscanfParsed, parsed, sscanfText, recordText);
+    free(text);
+    remove(BENCH_PARSE_FILE);
+}
+
+void runSize(long n) {
+    char dir[64];
+    sprintf(dir, "bench_data/accounts_%ld", n);
+    makeDirectory("bench_data");
+    makeDirectory(dir);
+    if (changeDirectory(dir) != 0) {
+        fprintf(stderr, "bank_bench: cannot enter %s\n", dir);
+        return;
+    }
+    clearDataFiles();
+    bankOpen();
+
+    long ops = n < BENCH_MAX_OPS ? n : BENCH_MAX_OPS;
+    double *samples = (double *)malloc(((n > ops ? n : ops) + BENCH_SCANS) * sizeof(double));
+    Account acc;
+    double t;
+
+    // createAccount - builds the data set
+    for (long i = 0; i < n; i++) {
+        syntheticAccount(i, &acc);
+        t = nowSeconds();
+        bankCreateAccount(&acc);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "create", samples, n);
+
+    for (long i = 0; i < ops; i++) {
+        syntheticAccount((long)(benchRandom() % n), &acc);
+        Account out;
+        t = nowSeconds();
+        bankLogin(acc.mobile_number, acc.password, &out);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "login", samples, ops);
+
+    for (long i = 0; i < ops; i++) {
+        int account_number = 2500 + (int)(benchRandom() % n);
+        Money amount = (Money)(100 + benchRandom() % 10000) * 100;
+        t = nowSeconds();
+        bankDeposit(account_number, amount, NULL);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "deposit", samples, ops);
+
+    for (long i = 0; i < ops; i++) {
+        int account_number = 2500 + (int)(benchRandom() % n);
+        Money amount = (Money)(1 + benchRandom() % 50) * 100;
+        t = nowSeconds();
+        bankWithdraw(account_number, amount, NULL);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "withdraw", samples, ops);
+
+    runCommitBench(n, samples, n < BENCH_COMMIT_OPS ? n : BENCH_COMMIT_OPS);
+
+    // History view - read an account's whole history, as the history screen would page through it
+    long views = n < BENCH_HISTORY_VIEWS ? n : BENCH_HISTORY_VIEWS;
+    for (long i = 0; i < views; i++) {
+        int account_number = 2500 + (int)(benchRandom() % n);
+        LedgerRecord rec;
+        t = nowSeconds();
+        int total = bankHistoryCount(account_number);
+        for (int k = 0; k < total; k++) bankHistoryEntry(account_number, k, &rec);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "history", samples, views);
+
+    for (long i = 0; i < ops; i++) {
+        long k = (long)(benchRandom() % n);
+        syntheticAccount(k, &acc);
+        acc.account_number = 2500 + (int)k;
+        sprintf(acc.address, "Flat %ld, Block %ld, Lahore", i, k % 40);
+        t = nowSeconds();
+        bankUpdateAccount(&acc);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "update", samples, ops);
+
+    // Checkpoint the ledger index, then cold start - reopen the same data set, once from the
+    // checkpoint and once scanning every ledger segment as if there were none
+    t = nowSeconds();
+    bankCheckpoint();
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "checkpoint", samples, 1);
+
+    bankClose();
+    t = nowSeconds();
+    bankOpen();
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "reopen", samples, 1);
+
+    runScanBench(n, samples);
+
+    bankClose();
+    remove("bank.ckpt");
+    remove("bank.ckpt.delta");
+    t = nowSeconds();
+    bankOpen();
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "reopen_scan", samples, 1);
+
+    runVelocityBench(n);
+
+    // Reconciliation - every account, then only the accounts posted to after that run
+    int checked = 0;
+    t = nowSeconds();
+    int found = bankReconcile("reconcile.csv", 0, 0, &checked);
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "reconcile", samples, 1);
+    fprintf(stderr, "%10s  %d accounts checked, %d discrepancies\n", "", checked, found);
+    for (long i = 0; i < BENCH_RECONCILE_POSTINGS; i++) {
+        bankDeposit(2500 + (int)(benchRandom() % n), 100, NULL);
+    }
+    t = nowSeconds();
+    found = bankReconcile("reconcile.csv", 1, 0, &checked);
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "reconcile_incremental", samples, 1);
+    fprintf(stderr, "%10s  %d accounts checked, %d discrepancies\n", "", checked, found);
+
+    runInterestBench(n, samples);
+
+    long deletes = n < BENCH_DELETES ? n : BENCH_DELETES;
+    for (long i = 0; i < deletes; i++) {
+        int account_number = 2500 + (int)(n - 1 - i);
+        t = nowSeconds();
+        bankDeleteAccount(account_number);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "delete", samples, deletes);
+
+    // Reclaim the deleted accounts and their ledger entries right away
+    bankSetDeleteRetention(0);
+    bankSetArchiveAge(-1);
+    t = nowSeconds();
+    bankCompact();
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "compact", samples, 1);
+
+    // Archive every sealed segment, then read history and cold start from the archive tier
+    long long footprint = ledgerFootprint();
+    bankSetArchiveAge(0);
+    t = nowSeconds();
+    bankCompact();
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "archive", samples, 1);
+    fprintf(stderr, "%10s  ledger on disk %.1f MB -> %.1f MB\n", "", footprint / 1e6, ledgerFootprint() / 1e6);
+
+    for (long i = 0; i < views; i++) {
+        int account_number = 2500 + (int)(benchRandom() % n);
+        LedgerRecord rec;
+        t = nowSeconds();
+        int total = bankHistoryCount(account_number);
+        for (int k = 0; k < total; k++) bankHistoryEntry(account_number, k, &rec);
+        samples[i] = nowSeconds() - t;
+    }
+    reportOp(n, "history_archived", samples, views);
+
+    bankClose();
+    remove("bank.ckpt");
+    remove("bank.ckpt.delta");
+    t = nowSeconds();
+    bankOpen();
+    samples[0] = nowSeconds() - t;
+    reportOp(n, "reopen_scan_archived", samples, 1);
+
+    bankClose();
+    runParseBench(n, samples);
+    free(samples);
+    changeDirectory("../..");
+}
+
+int main(int argc, char *argv[]) {
+    long defaultSizes[] = {10000, 100000, 1000000};
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            long n = atol(argv[i]);
+            if (n > 0) runSize(n);
+        }
+    } else {
+        for (int i = 0; i < 3; i++) runSize(defaultSizes[i]);
+    }
+    return 0;
+}
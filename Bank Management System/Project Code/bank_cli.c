@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "bank_core.h"
+
+// Headless batch runner - replays a script of banking operations against the
+// data files in the current directory, with no window or display needed.
+//
+// One operation per line in the line protocol of bank_protocol.c ('#' starts a comment):
+//   create,<name>,<father name>,<mobile>,<address>,<password>
+//   login,<mobile>,<password>
+//   deposit,<account>,<amount>[,verified]
+//   withdraw,<account>,<amount>[,verified]
+//   update,<account>,<name>,<father name>,<address>,<password>
+//   delete,<account>           (restorable with undelete,<account> for 30 days)
+//   compact                    (reclaim accounts deleted longer ago than that)
+//   balance,<account>
+//   history,<account>[,<first>,<count>]
+//   statements,<from>,<to>,<directory>[,<workers>]   (dates as dd/mm/yyyy, under reports/)
+//   reconcile,<report>,full|incremental[,<workers>]  (the report goes to reports/)
+//   class,<account>,<interest class>
+//   interest,<days>            (credit interest on every account, see bankSetInterestRates)
+//
+// Usage: bank_cli [-q] [-m metrics.prom] [-v rules] [script.csv]   (reads stdin when no script is given)
+// The script runs as an admin session, so it may act on any account without logging in.
+// Each reply is printed unless -q is given; failures always go to stderr.
+// -m writes the run's counters and latency histograms in the Prometheus text format.
+// -v replaces the velocity rules as bank_server -v does; an empty file turns them off.
+
+// Wall-clock seconds - CPU time would leave out the fsync and group commit waits
+double nowSeconds() {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+int main(int argc, char *argv[]) {
+    int quiet = 0;
+    const char *scriptPath = NULL;
+    const char *metricsPath = NULL;
+    const char *rulesPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) quiet = 1;
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) metricsPath = argv[++i];
+        else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) rulesPath = argv[++i];
+        else scriptPath = argv[i];
+    }
+
+    FILE *script = scriptPath ? fopen(scriptPath, "r") : stdin;
+    if (!script) {
+        fprintf(stderr, "bank_cli: cannot open %s\n", scriptPath);
+        return 1;
+    }
+    if (!bankOpen()) {
+        fprintf(stderr, "bank_cli: cannot open account data\n");
+        return 1;
+    }
+    if (rulesPath) {
+        char *rules = bankReadTextFile(rulesPath);
+        int count = -1;
+        if (!rules) {
+            fprintf(stderr, "bank_cli: cannot read %s\n", rulesPath);
+        } else {
+            count = bankSetVelocityRules(rules);
+            if (count < 0) fprintf(stderr, "bank_cli: %s:%d: bad velocity rule\n", rulesPath, -count);
+            free(rules);
+        }
+        if (count < 0) {
+            bankClose();
+            return 1;
+        }
+    }
+
+    BankSession session;
+    bankInitSession(&session, 1);
+    char line[BANK_REQUEST_MAX];
+    char *reply = (char *)malloc(BANK_REPLY_MAX);
+    long lineNo = 0, ops = 0, failures = 0;
+    double start = nowSeconds();
+    while (fgets(line, sizeof(line), script)) {
+        lineNo++;
+        // A line that does not fit is dropped whole, as the server does, rather than run in pieces
+        int tooLong = 0;
+        if (!strchr(line, '\n')) {
+            int c = getc(script);
+            tooLong = c != EOF;
+            while (c != EOF && c != '\n') c = getc(script);
+        }
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        ops++;
+        BankStatus status = BANK_ERR_INVALID;
+        if (tooLong) snprintf(reply, BANK_REPLY_MAX, "ERR %d Request too long!\n", (int)BANK_ERR_INVALID);
+        else status = bankExecute(&session, line, reply, BANK_REPLY_MAX);
+        if (status != BANK_OK) {
+            failures++;
+            fprintf(stderr, "line %ld: %s", lineNo, reply);
+        } else if (!quiet) {
+            fputs(reply, stdout);
+        }
+    }
+    double seconds = nowSeconds() - start;
+    if (metricsPath) {
+        FILE *metrics = fopen(metricsPath, "w");
+        if (metrics) {
+            fwrite(reply, 1, bankMetricsText(reply, BANK_REPLY_MAX), metrics);
+            fclose(metrics);
+        } else {
+            fprintf(stderr, "bank_cli: cannot write %s\n", metricsPath);
+        }
+    }
+    bankClose();
+    free(reply);
+    if (script != stdin) fclose(script);
+
+    fprintf(stderr, "%ld operations, %ld failed, %.3f s (%.0f ops/s)\n", ops, failures, seconds, seconds > 0 ? ops / seconds : 0.0);
+    return failures > 0 ? 2 : 0;
+}
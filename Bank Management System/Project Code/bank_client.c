@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "bank_client.h"
+#include "bank_money.h"
+#include "bank_net.h"
+#include "bank_profile.h"
+
+// Connection to bank_server, or INVALID_SOCKET when running on the embedded core
+socket_t serverSocket = INVALID_SOCKET;
+NetConn serverConn;
+char *clientReply = NULL;
+BankSession clientSession;   // the embedded core's session; the server keeps its own
+int clientLocal = 0;         // the data files were opened by clientOpen
+
+// Send one request and collect its reply into clientReply; history replies carry extra lines
+BankStatus clientRequest(const char *request) {
+    char line[BANK_REQUEST_MAX];
+    snprintf(line, sizeof(line), "%s\n", request);
+    if (serverSocket == INVALID_SOCKET && clientLocal) {
+        return bankExecute(&clientSession, line, clientReply, BANK_REPLY_MAX);
+    }
+
+    // Nothing to talk to when clientOpen failed to reach the server
+    if (serverSocket == INVALID_SOCKET || !netSendAll(serverSocket, line, (int)strlen(line)) || netReadLine(&serverConn, clientReply, BANK_REPLY_MAX) <= 0) {
+        snprintf(clientReply, BANK_REPLY_MAX, "ERR %d %s\n", (int)BANK_ERR_IO, bankStatusMessage(BANK_ERR_IO));
+        return BANK_ERR_IO;
+    }
+    int code = (int)BANK_ERR_IO;
+    if (strncmp(clientReply, "OK", 2) == 0) {
+        code = (int)BANK_OK;
+        int total, n;
+        if (strncmp(request, "history,", 8) == 0 && sscanf(clientReply, "OK %d %d", &total, &n) == 2) {
+            int used = (int)strlen(clientReply);
+            for (int i = 0; i < n && used < BANK_REPLY_MAX - 1; i++) {
+                int len = netReadLine(&serverConn, clientReply + used, BANK_REPLY_MAX - used);
+                if (len <= 0) break;
+                used += len;
+            }
+        }
+    } else {
+        sscanf(clientReply, "ERR %d", &code);
+    }
+    return (BankStatus)code;
+}
+
+BankStatus clientOpen(const char *host, int port) {
+    clientReply = (char *)malloc(BANK_REPLY_MAX);
+    if (netStartup()) {
+        serverSocket = netConnect(host, port);
+    }
+    if (serverSocket != INVALID_SOCKET) {
+        netInitConn(&serverConn, serverSocket);
+        // A server at its connection limit answers ERR 10 and hangs up, so ask once to find out
+        BankStatus status = clientRequest("count");
+        if (status != BANK_OK) {
+            closeSocket(serverSocket);
+            serverSocket = INVALID_SOCKET;
+        }
+        return status;
+    }
+    clientLocal = 1;
+    bankInitSession(&clientSession, 0);
+    return bankOpen() ? BANK_OK : BANK_ERR_IO;
+}
+
+void clientClose(void) {
+    if (serverSocket != INVALID_SOCKET) {
+        netSendAll(serverSocket, "quit\n", 5);
+        closeSocket(serverSocket);
+        serverSocket = INVALID_SOCKET;
+    } else if (clientLocal) {
+        bankClose();
+        clientLocal = 0;
+    }
+    free(clientReply);
+    clientReply = NULL;
+}
+
+// Parse the "OK <account>" reply of login/get/deposit/withdraw/update
+void parseAccountReply(Account *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (strncmp(clientReply, "OK ", 3) == 0) accountParseRecord(clientReply + 3, out);
+}
+
+BankStatus clientCreateAccount(Account *acc) {
+    char request[BANK_REQUEST_MAX];
+    snprintf(request, sizeof(request), "create,%s,%s,%s,%s,%s", acc->name, acc->father_name, acc->mobile_number, acc->address, acc->password);
+    BankStatus status = clientRequest(request);
+    if (status == BANK_OK) {
+        acc->account_number = atoi(clientReply + 3);
+        acc->balance = 0;
+    }
+    return status;
+}
+
+BankStatus clientLogin(const char *mobile, const char *password, Account *out) {
+    char request[BANK_REQUEST_MAX];
+    snprintf(request, sizeof(request), "login,%s,%s", mobile, password);
+    BankStatus status = clientRequest(request);
+    if (status == BANK_OK) parseAccountReply(out);
+    return status;
+}
+
+BankStatus clientLogout(void) {
+    return clientRequest("logout");
+}
+
+BankStatus clientDeposit(int account_number, Money amount, const char *answer, Account *out) {
+    char request[BANK_REQUEST_MAX];
+    char text[MONEY_TEXT_MAX];
+    moneyFormat(amount, text);
+    if (answer && answer[0]) snprintf(request, sizeof(request), "deposit,%d,%s,%s", account_number, text, answer);
+    else snprintf(request, sizeof(request), "deposit,%d,%s", account_number, text);
+    BankStatus status = clientRequest(request);
+    if (status == BANK_OK) parseAccountReply(out);
+    return status;
+}
+
+BankStatus clientWithdraw(int account_number, Money amount, const char *answer, Account *out) {
+    char request[BANK_REQUEST_MAX];
+    char text[MONEY_TEXT_MAX];
+    moneyFormat(amount, text);
+    if (answer && answer[0]) snprintf(request, sizeof(request), "withdraw,%d,%s,%s", account_number, text, answer);
+    else snprintf(request, sizeof(request), "withdraw,%d,%s", account_number, text);
+    BankStatus status = clientRequest(request);
+    if (status == BANK_OK) parseAccountReply(out);
+    return status;
+}
+
+BankStatus clientUpdateAccount(const Account *user) {
+    char request[BANK_REQUEST_MAX];
+    snprintf(request, sizeof(request), "update,%d,%s,%s,%s,%s", user->account_number, user->name, user->father_name, user->address, user->password);
+    return clientRequest(request);
+}
+
+BankStatus clientDeleteAccount(int account_number) {
+    char request[BANK_REQUEST_MAX];
+    snprintf(request, sizeof(request), "delete,%d", account_number);
+    return clientRequest(request);
+}
+
+int clientAccountCount(void) {
+    if (clientRequest("count") != BANK_OK) return 0;
+    return atoi(clientReply + 3);
+}
+
+int clientHistory(int account_number, int first, int count, LedgerRecord *out, int *total) {
+    char request[BANK_REQUEST_MAX];
+    snprintf(request, sizeof(request), "history,%d,%d,%d", account_number, first, count);
+    *total = 0;
+    if (clientRequest(request) != BANK_OK) return 0;
+    int n = 0;
+    sscanf(clientReply, "OK %d %d", total, &n);
+    const char *p = strchr(clientReply, '\n');
+    int read = 0;
+    while (p && read < n && read < count) {
+        LedgerRecord *rec = &out[read];
+        rec->account_number = account_number;
+        // timestamp,type,amount,balance
+        int used = 0;
+        if (sscanf(p + 1, "%lld,%d,%n", &rec->timestamp, &rec->type, &used) != 2 || used == 0) break;
+        const char *field = p + 1 + used;
+        int n = moneyParse(field, &rec->amount);
+        if (n == 0 || field[n] != ',' || moneyParse(field + n + 1, &rec->balance) == 0) break;
+        read++;
+        p = strchr(p + 1, '\n');
+    }
+    return read;
+}
+
+BankStatus clientSecurityQuestion(int account_number, int *question) {
+    char request[BANK_REQUEST_MAX];
+    snprintf(request, sizeof(request), "question,%d", account_number);
+    BankStatus status = clientRequest(request);
+    *question = status == BANK_OK ? atoi(clientReply + 3) : -1;
+    return status;
+}
+
+#define CLIENT_JOB_QUEUE 16
+
+// Fixed ring of jobs; the worker moves each one from the pending half to the done half
+typedef struct {
+    ClientJob pending[CLIENT_JOB_QUEUE];
+    ClientJob done[CLIENT_JOB_QUEUE];
+    int pendingHead;
+    int pendingCount;
+    int doneHead;
+    int doneCount;
+    int active;      // 1 while the worker runs a job it has taken off pending
+    int stopping;
+    int running;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+} ClientJobQueue;
+
+ClientJobQueue jobQueue;
+
+void runClientJob(ClientJob *job) {
+    job->startedAt = profileNow();
+    switch (job->type) {
+        case JOB_OPEN:
+            job->status = clientOpen(BANK_SERVER_HOST, BANK_SERVER_PORT);
+            break;
+        case JOB_CREATE:
+            job->status = clientCreateAccount(&job->account);
+            break;
+        case JOB_LOGIN:
+            if (clientAccountCount() == 0) {
+                job->status = BANK_ERR_NOT_FOUND;
+            } else {
+                job->status = clientLogin(job->account.mobile_number, job->account.password, &job->account);
+            }
+            break;
+        case JOB_DEPOSIT:
+            job->status = clientDeposit(job->account_number, job->amount, job->answer, &job->account);
+            break;
+        case JOB_WITHDRAW:
+            job->status = clientWithdraw(job->account_number, job->amount, job->answer, &job->account);
+            break;
+        case JOB_UPDATE:
+            job->status = clientUpdateAccount(&job->account);
+            break;
+        case JOB_DELETE:
+            job->status = clientDeleteAccount(job->account_number);
+            break;
+        case JOB_LOGOUT:
+            job->status = clientLogout();
+            break;
+        case JOB_VERIFY:
+            job->status = clientSecurityQuestion(job->account_number, &job->count);
+            break;
+        case JOB_HISTORY:
+            if (job->count > CLIENT_JOB_ROWS) job->count = CLIENT_JOB_ROWS;
+            job->count = clientHistory(job->account_number, job->first, job->count, job->records, &job->total);
+            job->status = BANK_OK;
+            break;
+    }
+    job->finishedAt = profileNow();
+}
+
+void *clientWorkerMain(void *arg) {
+    (void)arg;
+    ClientJob *job = (ClientJob *)malloc(sizeof(ClientJob));
+    pthread_mutex_lock(&jobQueue.lock);
+    for (;;) {
+        while (jobQueue.pendingCount == 0 && !jobQueue.stopping) {
+            pthread_cond_wait(&jobQueue.notEmpty, &jobQueue.lock);
+        }
+        if (jobQueue.pendingCount == 0) break;
+        *job = jobQueue.pending[jobQueue.pendingHead];
+        jobQueue.pendingHead = (jobQueue.pendingHead + 1) % CLIENT_JOB_QUEUE;
+        jobQueue.pendingCount--;
+        jobQueue.active = 1;
+        pthread_mutex_unlock(&jobQueue.lock);
+
+        runClientJob(job);
+
+        pthread_mutex_lock(&jobQueue.lock);
+        // clientSubmit keeps pending + done within the ring, so there is always room here
+        jobQueue.done[(jobQueue.doneHead + jobQueue.doneCount) % CLIENT_JOB_QUEUE] = *job;
+        jobQueue.doneCount++;
+        jobQueue.active = 0;
+    }
+    pthread_mutex_unlock(&jobQueue.lock);
+    free(job);
+    return NULL;
+}
+
+void clientStartWorker(void) {
+    memset(&jobQueue, 0, sizeof(jobQueue));
+    pthread_mutex_init(&jobQueue.lock, NULL);
+    pthread_cond_init(&jobQueue.notEmpty, NULL);
+    jobQueue.running = pthread_create(&jobQueue.thread, NULL, clientWorkerMain, NULL) == 0;
+}
+
+void clientStopWorker(void) {
+    if (jobQueue.running) {
+        pthread_mutex_lock(&jobQueue.lock);
+        jobQueue.stopping = 1;
+        pthread_cond_signal(&jobQueue.notEmpty);
+        pthread_mutex_unlock(&jobQueue.lock);
+        pthread_join(jobQueue.thread, NULL);
+        jobQueue.running = 0;
+    }
+    pthread_cond_destroy(&jobQueue.notEmpty);
+    pthread_mutex_destroy(&jobQueue.lock);
+    if (clientReply) clientClose();
+}
+
+int clientSubmit(const ClientJob *job) {
+    // Without a worker the job runs inline, so the caller still sees it through clientPollJob
+    if (!jobQueue.running) {
+        if (jobQueue.doneCount == CLIENT_JOB_QUEUE) return 0;
+        ClientJob *slot = &jobQueue.done[(jobQueue.doneHead + jobQueue.doneCount) % CLIENT_JOB_QUEUE];
+        *slot = *job;
+        slot->queuedAt = profileNow();
+        runClientJob(slot);
+        jobQueue.doneCount++;
+        return 1;
+    }
+    pthread_mutex_lock(&jobQueue.lock);
+    // Count the job being run as well, so its completion always fits in done
+    int ok = jobQueue.pendingCount + jobQueue.active + jobQueue.doneCount < CLIENT_JOB_QUEUE;
+    if (ok) {
+        ClientJob *slot = &jobQueue.pending[(jobQueue.pendingHead + jobQueue.pendingCount) % CLIENT_JOB_QUEUE];
+        *slot = *job;
+        slot->queuedAt = profileNow();
+        jobQueue.pendingCount++;
+        pthread_cond_signal(&jobQueue.notEmpty);
+    }
+    pthread_mutex_unlock(&jobQueue.lock);
+    return ok;
+}
+
+int clientPollJob(ClientJob *job) {
+    if (jobQueue.running) pthread_mutex_lock(&jobQueue.lock);
+    int ready = jobQueue.doneCount > 0;
+    if (ready) {
+        *job = jobQueue.done[jobQueue.doneHead];
+        jobQueue.doneHead = (jobQueue.doneHead + 1) % CLIENT_JOB_QUEUE;
+        jobQueue.doneCount--;
+    }
+    if (jobQueue.running) pthread_mutex_unlock(&jobQueue.lock);
+    return ready;
+}
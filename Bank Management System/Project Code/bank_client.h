@@ -0,0 +1,73 @@
+#ifndef BANK_CLIENT_H
+#define BANK_CLIENT_H
+
+#include "bank_core.h"
+
+// Thin client used by the raylib UI. Every operation is a line-protocol request: it goes
+// to bank_server when one is running, and is executed in-process (bankExecute) otherwise.
+
+// Connect to the server at host:port, or open the data files locally if none answers.
+// Returns BANK_ERR_BUSY when the server is at its connection limit, BANK_ERR_IO when the
+// local data files cannot be opened.
+BankStatus clientOpen(const char *host, int port);
+void clientClose(void);
+
+BankStatus clientCreateAccount(Account *acc);
+// The connection's session acts on the account logged in last, until clientLogout()
+BankStatus clientLogin(const char *mobile, const char *password, Account *out);
+BankStatus clientLogout(void);
+// answer (NULL for none) resends a posting refused with BANK_ERR_VERIFY with the customer's answer
+// to clientSecurityQuestion(); the server checks it, and a wrong one fails with BANK_ERR_AUTH
+BankStatus clientDeposit(int account_number, Money amount, const char *answer, Account *out);
+BankStatus clientWithdraw(int account_number, Money amount, const char *answer, Account *out);
+BankStatus clientUpdateAccount(const Account *user);
+BankStatus clientDeleteAccount(int account_number);
+int clientAccountCount(void);
+// Fetch up to count history entries starting at first; returns how many were read and sets *total
+int clientHistory(int account_number, int first, int count, LedgerRecord *out, int *total);
+// The security question the server wants answered for account_number (bankSecurityQuestion() has its text)
+BankStatus clientSecurityQuestion(int account_number, int *question);
+
+// Background I/O - the UI queues requests to one worker thread so the window keeps rendering
+// while storage or the server is busy, then picks up finished jobs once per frame.
+// Jobs run in the order they were submitted.
+typedef enum {
+    JOB_OPEN,       // clientOpen(BANK_SERVER_HOST, BANK_SERVER_PORT); status is its result
+    JOB_CREATE,     // account in, account_number set on success
+    JOB_LOGIN,      // mobile_number/password in account; BANK_ERR_NOT_FOUND when there are no accounts at all
+    JOB_DEPOSIT,    // account_number, amount and answer in; BANK_ERR_VERIFY asks for the security question
+    JOB_WITHDRAW,
+    JOB_UPDATE,
+    JOB_DELETE,
+    JOB_HISTORY,    // count entries from first into records; sets count and total
+    JOB_VERIFY,     // account_number in; count set to the security question to ask
+    JOB_LOGOUT
+} ClientJobType;
+
+#define CLIENT_JOB_ROWS 64
+
+typedef struct {
+    ClientJobType type;
+    Account account;
+    int account_number;
+    Money amount;
+    char answer[100];    // answer to the security question when resending a held posting, "" otherwise
+    int first;
+    int count;
+    int total;
+    LedgerRecord records[CLIENT_JOB_ROWS];
+    BankStatus status;
+    double queuedAt;     // profileNow() when submitted, picked up by the worker and finished
+    double startedAt;
+    double finishedAt;
+} ClientJob;
+
+void clientStartWorker(void);
+// Runs the jobs still queued, stops the worker and closes the client
+void clientStopWorker(void);
+// Queue a copy of job; returns 0 when the queue is full
+int clientSubmit(const ClientJob *job);
+// Take the oldest finished job; returns 0 when none is ready
+int clientPollJob(ClientJob *job);
+
+#endif
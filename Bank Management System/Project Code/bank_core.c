@@ -0,0 +1,3246 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stddef.h>
+#include <pthread.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <io.h>
+#include <direct.h>
+#include <windows.h>
+#endif
+#include "bank_core.h"
+#include "bank_metrics.h"
+#include "bank_archive.h"
+#include "bank_velocity.h"
+#include "bank_interest.h"
+#include "bank_money.h"
+
+// File name
+const char *ACCOUNT_FILE = "accounts.txt";  // legacy CSV, converted once into accounts.dat
+
+// Mobile index slot - the 11-digit number packed into a uint64, so probes never touch the records
+typedef struct {
+    unsigned long long key;   // packMobile() of the number
+    int index;                // account index + 1 (0 = empty)
+} MobileSlot;
+
+// In-memory account table, loaded once from the account file at startup.
+// The file stays the persistence layer; lookups go through the hash indexes.
+// Hot and cold fields are kept apart: account numbers and balances live in dense columns that
+// lookups, postings and scans read, while the profile records (names, address, password, mobile
+// number) stay in the accounts.dat mapping and are paged in only when a profile is read.
+// The balance in a record is not kept current in memory - store.balances is the balance.
+typedef struct {
+    Account *accounts;        // cold profile records
+    int *numbers;             // per account: account_number
+    Money *balances;          // per account: balance
+    unsigned char *classes;   // per account: interest class (bank_interest.h)
+    int count;
+    int capacity;
+    int *numberIndex;         // open-addressing table on account_number, holds index + 1 (0 = empty)
+    MobileSlot *mobileIndex;  // open-addressing table on the packed mobile number
+    int indexSize;            // power of two, kept at least twice the account count
+    unsigned long long *mobileBloom;  // blocked Bloom filter over the packed mobile numbers, indexSize / 4 words
+    long long *deletedAt;     // per account: tombstone time (epoch seconds), 0 = live
+    int deletedCount;
+    int nextAccountNumber;
+    void *mapping;            // accounts.dat mapped copy-on-write, accounts points into it (NULL = heap)
+    size_t mappingSize;
+} AccountStore;
+
+AccountStore store = {NULL, NULL, NULL, NULL, 0, 0, NULL, NULL, 0, NULL, NULL, 0, 2500, NULL, 0};
+
+// Locking - storeLock guards the layout of the account table and is taken for writing only
+// when accounts are added or removed. A striped per-account lock serialises changes to one
+// account, so postings to different accounts run in parallel; each file has its own lock.
+// Lock order: checkpointLock -> storeLock -> account lock -> journalLock -> datLock -> ledgerLock
+#define ACCOUNT_LOCK_STRIPES 256
+
+pthread_rwlock_t storeLock = PTHREAD_RWLOCK_INITIALIZER;
+pthread_mutex_t accountLocks[ACCOUNT_LOCK_STRIPES];
+pthread_mutex_t journalLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t datLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t ledgerLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t accountLocksOnce = PTHREAD_ONCE_INIT;
+
+unsigned int hashAccountNumber(int account_number) {
+    unsigned int h = (unsigned int)account_number;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// Mobile numbers are exactly 11 digits, which fit in 37 bits. Anything else (only possible in
+// legacy data) gets a 64-bit FNV-1a hash with the top bit set, and is confirmed with strcmp.
+#define MOBILE_HASHED_KEY 0x8000000000000000ULL
+
+unsigned long long packMobile(const char *mobile) {
+    unsigned long long key = 0;
+    int digits = 0;
+    while (mobile[digits] >= '0' && mobile[digits] <= '9') {
+        key = key * 10 + (unsigned long long)(mobile[digits] - '0');
+        digits++;
+    }
+    if (digits == 11 && mobile[digits] == '\0') return key;
+
+    unsigned long long h = 14695981039346656037ULL;
+    while (*mobile) {
+        h ^= (unsigned char)*mobile++;
+        h *= 1099511628211ULL;
+    }
+    return h | MOBILE_HASHED_KEY;
+}
+
+// splitmix64 finaliser - spreads the packed digits over all 64 bits
+unsigned long long hashMobileKey(unsigned long long key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+// Bloom filter bits of a key - four bits inside one 64-bit word, so a check costs one memory read
+unsigned long long mobileBloomBits(unsigned long long h) {
+    return (1ULL << ((h >> 32) & 63)) | (1ULL << ((h >> 38) & 63)) | (1ULL << ((h >> 44) & 63)) | (1ULL << ((h >> 50) & 63));
+}
+
+void initAccountLocks() {
+    for (int i = 0; i < ACCOUNT_LOCK_STRIPES; i++) {
+        pthread_mutex_init(&accountLocks[i], NULL);
+    }
+}
+
+pthread_mutex_t *accountLock(int account_number) {
+    return &accountLocks[hashAccountNumber(account_number) & (ACCOUNT_LOCK_STRIPES - 1)];
+}
+
+void indexAccount(int i) {
+    unsigned int mask = (unsigned int)store.indexSize - 1;
+    unsigned int slot = hashAccountNumber(store.numbers[i]) & mask;
+    while (store.numberIndex[slot] != 0) slot = (slot + 1) & mask;
+    store.numberIndex[slot] = i + 1;
+    unsigned long long key = packMobile(store.accounts[i].mobile_number);
+    unsigned long long h = hashMobileKey(key);
+    slot = (unsigned int)h & mask;
+    while (store.mobileIndex[slot].index != 0) slot = (slot + 1) & mask;
+    store.mobileIndex[slot].key = key;
+    store.mobileIndex[slot].index = i + 1;
+    store.mobileBloom[(unsigned int)h & (mask >> 2)] |= mobileBloomBits(h);
+    if (store.numbers[i] >= store.nextAccountNumber) {
+        store.nextAccountNumber = store.numbers[i] + 1;
+    }
+}
+
+// Rebuild both hash indexes and the Bloom filter, growing them if the table got too full.
+// The rebuild also clears Bloom bits left behind by deleted accounts.
+void rebuildIndexes() {
+    int size = store.indexSize > 0 ? store.indexSize : 64;
+    while (size < store.count * 2) size *= 2;
+    if (size != store.indexSize) {
+        free(store.numberIndex);
+        free(store.mobileIndex);
+        free(store.mobileBloom);
+        store.numberIndex = (int *)malloc(size * sizeof(int));
+        store.mobileIndex = (MobileSlot *)malloc(size * sizeof(MobileSlot));
+        store.mobileBloom = (unsigned long long *)malloc((size / 4) * sizeof(unsigned long long));
+        store.indexSize = size;
+    }
+    memset(store.numberIndex, 0, size * sizeof(int));
+    memset(store.mobileIndex, 0, size * sizeof(MobileSlot));
+    memset(store.mobileBloom, 0, (size / 4) * sizeof(unsigned long long));
+    for (int i = 0; i < store.count; i++) {
+        indexAccount(i);
+    }
+}
+
+// Index of an account in the table, deleted (tombstoned) ones included, or -1
+int findAccountSlot(int account_number) {
+    if (store.indexSize == 0) return -1;
+    unsigned int mask = (unsigned int)store.indexSize - 1;
+    unsigned int slot = hashAccountNumber(account_number) & mask;
+    while (store.numberIndex[slot] != 0) {
+        int i = store.numberIndex[slot] - 1;
+        if (store.numbers[i] == account_number) return i;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Index of a live (not deleted) account, or -1
+int findLiveAccountSlot(int account_number) {
+    int i = findAccountSlot(account_number);
+    return i >= 0 && store.deletedAt[i] == 0 ? i : -1;
+}
+
+Account *findAccountByNumber(int account_number) {
+    int i = findLiveAccountSlot(account_number);
+    return i >= 0 ? &store.accounts[i] : NULL;
+}
+
+// Copy out a whole account: the profile record with the balance from its column
+void copyAccount(int slot, Account *out) {
+    *out = store.accounts[slot];
+    out->balance = store.balances[slot];
+}
+
+// Grow the per-account columns to store.capacity
+void growAccountColumns() {
+    store.numbers = (int *)realloc(store.numbers, store.capacity * sizeof(int));
+    store.balances = (Money *)realloc(store.balances, store.capacity * sizeof(Money));
+    store.classes = (unsigned char *)realloc(store.classes, store.capacity);
+    store.deletedAt = (long long *)realloc(store.deletedAt, store.capacity * sizeof(long long));
+}
+
+// Most new numbers at account creation are unique, so the Bloom filter answers them without a probe
+Account *findAccountByMobile(const char *mobile) {
+    if (store.indexSize == 0) return NULL;
+    unsigned int mask = (unsigned int)store.indexSize - 1;
+    unsigned long long key = packMobile(mobile);
+    unsigned long long h = hashMobileKey(key);
+    unsigned long long bits = mobileBloomBits(h);
+    if ((store.mobileBloom[(unsigned int)h & (mask >> 2)] & bits) != bits) return NULL;
+
+    unsigned int slot = (unsigned int)h & mask;
+    while (store.mobileIndex[slot].index != 0) {
+        int i = store.mobileIndex[slot].index - 1;
+        // A deleted account's number may already belong to a new account, so keep probing past it
+        if (store.mobileIndex[slot].key == key && store.deletedAt[i] == 0) {
+            Account *acc = &store.accounts[i];
+            if (!(key & MOBILE_HASHED_KEY) || strcmp(acc->mobile_number, mobile) == 0) return acc;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+// Free the account table, or unmap it while it still lives in the accounts.dat mapping
+void releaseAccountTable() {
+#ifndef _WIN32
+    if (store.mapping) {
+        munmap(store.mapping, store.mappingSize);
+        store.mapping = NULL;
+        store.accounts = NULL;
+        return;
+    }
+#endif
+    free(store.accounts);
+    store.accounts = NULL;
+}
+
+// Add an account to the in-memory table (does not touch the file)
+void addAccountToStore(const Account *acc) {
+    if (store.count == store.capacity) {
+        store.capacity = store.capacity > 0 ? store.capacity * 2 : 64;
+        if (store.mapping) {
+            // Outgrew the range reserved around the mapped file: move the table to the heap
+            Account *accounts = (Account *)malloc(store.capacity * sizeof(Account));
+            memcpy(accounts, store.accounts, store.count * sizeof(Account));
+            releaseAccountTable();
+            store.accounts = accounts;
+        } else {
+            store.accounts = (Account *)realloc(store.accounts, store.capacity * sizeof(Account));
+        }
+        growAccountColumns();
+    }
+    store.numbers[store.count] = acc->account_number;
+    store.balances[store.count] = acc->balance;
+    store.classes[store.count] = 0;
+    store.deletedAt[store.count] = 0;
+    store.accounts[store.count++] = *acc;
+    if (store.count * 2 > store.indexSize) {
+        rebuildIndexes();
+    } else {
+        indexAccount(store.count - 1);
+    }
+}
+
+// Remove the account at index i from the in-memory table by moving the last one into its place.
+// Does not touch the file or the indexes - the caller rebuilds them after a batch of removals.
+void removeAccountSlot(int i) {
+    if (store.deletedAt[i]) store.deletedCount--;
+    store.count--;
+    store.accounts[i] = store.accounts[store.count];
+    store.numbers[i] = store.numbers[store.count];
+    store.balances[i] = store.balances[store.count];
+    store.classes[i] = store.classes[store.count];
+    store.deletedAt[i] = store.deletedAt[store.count];
+}
+
+// Binary account file - a small header followed by fixed-width Account records.
+// Record i on disk is store.accounts[i] with the balance of store.balances[i], so a balance
+// change rewrites only that slot.
+const char *ACCOUNT_DAT_FILE = "accounts.dat";
+#define ACCOUNT_DAT_MAGIC 0x414B4E42u  // "BNKA"
+#define ACCOUNT_DAT_VERSION 2   // 2: deletes are tombstones, kept as LEDGER_CLOSE records until compaction
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int recordSize;
+    unsigned int count;
+} AccountFileHeader;
+
+// The on-disk record is the Account struct itself: 232 bytes of text fields, account_number, 4
+// bytes of padding, balance. Files with 240-byte records hold float balances and are converted
+// by upgradeMoneyFormat().
+typedef char AccountRecordSizeCheck[sizeof(Account) == 248 ? 1 : -1];
+
+FILE *datFile = NULL;
+int datVersionLoaded = ACCOUNT_DAT_VERSION;
+
+// Column file - the hot columns of accounts.dat (account number and balance of each slot) kept
+// side by side, so startup reads 8 bytes per account instead of paging in every record. It is
+// written under datLock together with accounts.dat, which stays complete on its own: a missing
+// or out-of-step column file is rebuilt from the records.
+const char *ACCOUNT_COLUMN_FILE = "accounts.col";
+#define ACCOUNT_COLUMN_MAGIC 0x4D4B4E42u  // "BNKM" - a "BNKC" file has float balances and is rebuilt
+
+typedef struct {
+    unsigned int magic;
+    unsigned int count;
+} ColumnFileHeader;
+
+typedef struct {
+    int account_number;
+    int reserved;
+    Money balance;
+} ColumnEntry;
+
+FILE *columnFile = NULL;
+
+long accountSlotOffset(int slot) {
+    return (long)sizeof(AccountFileHeader) + (long)slot * (long)sizeof(Account);
+}
+
+long columnSlotOffset(int slot) {
+    return (long)sizeof(ColumnFileHeader) + (long)slot * (long)sizeof(ColumnEntry);
+}
+
+// Rewrite one slot of the column file (caller holds datLock)
+void writeColumnSlot(int slot) {
+    if (!columnFile) return;
+    ColumnEntry entry = {store.numbers[slot], 0, store.balances[slot]};
+    fseek(columnFile, columnSlotOffset(slot), SEEK_SET);
+    fwrite(&entry, sizeof(entry), 1, columnFile);
+}
+
+void writeAccountCount() {
+    AccountFileHeader header = {ACCOUNT_DAT_MAGIC, ACCOUNT_DAT_VERSION, (unsigned int)sizeof(Account), (unsigned int)store.count};
+    ColumnFileHeader columns = {ACCOUNT_COLUMN_MAGIC, (unsigned int)store.count};
+    pthread_mutex_lock(&datLock);
+    fseek(datFile, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, datFile);
+    if (columnFile) {
+        fseek(columnFile, 0, SEEK_SET);
+        fwrite(&columns, sizeof(columns), 1, columnFile);
+    }
+    pthread_mutex_unlock(&datLock);
+}
+
+// Rewrite one whole record in place
+void writeAccountSlot(int slot) {
+    long long start = metricNow();
+    Account record;
+    copyAccount(slot, &record);
+    pthread_mutex_lock(&datLock);
+    fseek(datFile, accountSlotOffset(slot), SEEK_SET);
+    fwrite(&record, sizeof(Account), 1, datFile);
+    writeColumnSlot(slot);
+    pthread_mutex_unlock(&datLock);
+    metricLatency(LATENCY_ACCOUNT_FILE, start);
+}
+
+// Rewrite the balance of the records at slots[0..n) in place, and the whole column file in one
+// sequential pass - for runs that change many balances and leave every profile as it was
+void writeAccountBalances(const int *slots, int n) {
+    ColumnEntry entries[128];
+    long long start = metricNow();
+    pthread_mutex_lock(&datLock);
+#ifdef _WIN32
+    for (int i = 0; i < n; i++) {
+        fseek(datFile, accountSlotOffset(slots[i]) + (long)offsetof(Account, balance), SEEK_SET);
+        fwrite(&store.balances[slots[i]], sizeof(Money), 1, datFile);
+    }
+#else
+    // One write per record, without the flush and seek stdio does for every fseek
+    fflush(datFile);
+    int fd = fileno(datFile);
+    for (int i = 0; i < n; i++) {
+        pwrite(fd, &store.balances[slots[i]], sizeof(Money), accountSlotOffset(slots[i]) + (long)offsetof(Account, balance));
+    }
+#endif
+    if (columnFile) {
+        fseek(columnFile, columnSlotOffset(0), SEEK_SET);
+        for (int i = 0; i < store.count; i += 128) {
+            int chunk = store.count - i < 128 ? store.count - i : 128;
+            for (int k = 0; k < chunk; k++) {
+                entries[k].account_number = store.numbers[i + k];
+                entries[k].reserved = 0;
+                entries[k].balance = store.balances[i + k];
+            }
+            fwrite(entries, sizeof(ColumnEntry), chunk, columnFile);
+        }
+    }
+    pthread_mutex_unlock(&datLock);
+    metricLatency(LATENCY_ACCOUNT_FILE, start);
+}
+
+// Rewrite only the balance of one account in place
+void writeAccountBalance(int slot) {
+    long long start = metricNow();
+    pthread_mutex_lock(&datLock);
+    fseek(datFile, accountSlotOffset(slot) + (long)offsetof(Account, balance), SEEK_SET);
+    fwrite(&store.balances[slot], sizeof(Money), 1, datFile);
+    writeColumnSlot(slot);
+    pthread_mutex_unlock(&datLock);
+    metricLatency(LATENCY_ACCOUNT_FILE, start);
+}
+
+// Force a file's buffered writes through to the disk, returns 1 on success
+int syncFile(FILE *file) {
+    long long start = metricNow();
+    if (fflush(file) != 0) return 0;
+#ifdef _WIN32
+    int ok = _commit(_fileno(file)) == 0;
+#else
+    int ok = fsync(fileno(file)) == 0;
+#endif
+    metricLatency(LATENCY_FSYNC, start);
+    return ok;
+}
+
+// Push buffered slot writes to the files, returns 1 on success
+int syncAccountFile() {
+    pthread_mutex_lock(&datLock);
+    int ok = fflush(datFile) == 0 && (!columnFile || fflush(columnFile) == 0);
+    pthread_mutex_unlock(&datLock);
+    return ok;
+}
+
+// One-time converter from the old CSV accounts.txt to accounts.dat (accounts.txt is left as a backup)
+int convertTextAccounts() {
+    FILE *file = fopen(ACCOUNT_FILE, "r");
+    if (!file) return 0;
+    FILE *out = fopen(ACCOUNT_DAT_FILE, "wb");
+    if (!out) {
+        fclose(file);
+        return 0;
+    }
+    AccountFileHeader header = {ACCOUNT_DAT_MAGIC, ACCOUNT_DAT_VERSION, (unsigned int)sizeof(Account), 0};
+    fwrite(&header, sizeof(header), 1, out);
+    char line[300];
+    Account acc;
+    while (fgets(line, sizeof(line), file)) {
+        memset(&acc, 0, sizeof(acc));
+        if (accountParseRecord(line, &acc) > 0) {
+            fwrite(&acc, sizeof(acc), 1, out);
+            header.count++;
+        }
+    }
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    fclose(out);
+    fclose(file);
+    return 1;
+}
+
+int accountHeaderValid(const AccountFileHeader *header, size_t size) {
+    return header->magic == ACCOUNT_DAT_MAGIC && header->version >= 1 && header->version <= ACCOUNT_DAT_VERSION &&
+           header->recordSize == sizeof(Account) && size >= (size_t)accountSlotOffset(header->count);
+}
+
+// Copy the records of a read accounts.dat image into the store
+void loadAccountImage(const unsigned char *data, size_t size) {
+    AccountFileHeader header;
+    if (size < sizeof(header)) return;
+    memcpy(&header, data, sizeof(header));
+    if (!accountHeaderValid(&header, size)) return;
+    datVersionLoaded = (int)header.version;
+    store.capacity = header.count > 64 ? (int)header.count : 64;
+    store.accounts = (Account *)realloc(store.accounts, store.capacity * sizeof(Account));
+    growAccountColumns();
+    memset(store.classes, 0, store.capacity);
+    memset(store.deletedAt, 0, store.capacity * sizeof(long long));
+    memcpy(store.accounts, data + sizeof(header), header.count * sizeof(Account));
+    store.count = (int)header.count;
+}
+
+#ifndef _WIN32
+// Use the records of accounts.dat in place: the file is mapped copy-on-write, so startup copies
+// nothing and pages are read in as accounts are first touched (changes still go to the file
+// through datFile). The mapping starts a reserved range with room for as many accounts again,
+// which the table grows into before it has to move to the heap. Returns 1 on success.
+int mapAccountImage(int fd, size_t size) {
+    AccountFileHeader header;
+    if (size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) || !accountHeaderValid(&header, size)) return 0;
+    size_t reserve = (size_t)accountSlotOffset((int)header.count * 2 + 64);
+    if (reserve < size) reserve = size;
+    void *range = mmap(NULL, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (range == MAP_FAILED) return 0;
+    if (mmap(range, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(range, reserve);
+        return 0;
+    }
+    datVersionLoaded = (int)header.version;
+    store.mapping = range;
+    store.mappingSize = reserve;
+    store.accounts = (Account *)((unsigned char *)range + sizeof(header));
+    store.capacity = (int)((reserve - sizeof(header)) / sizeof(Account));
+    store.count = (int)header.count;
+    growAccountColumns();
+    memset(store.classes, 0, store.capacity);
+    memset(store.deletedAt, 0, store.capacity * sizeof(long long));
+    return 1;
+}
+#endif
+
+// Fill the hot columns from the column file. A file that is missing or out of step with
+// accounts.dat (written by an older version, or cut short by a crash) is rebuilt from the
+// records, which reads every record once.
+void loadAccountColumns() {
+    int loaded = 0;
+    FILE *file = fopen(ACCOUNT_COLUMN_FILE, "rb");
+    if (file) {
+        ColumnFileHeader header;
+        if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == ACCOUNT_COLUMN_MAGIC && (int)header.count == store.count) {
+            ColumnEntry chunk[4096];
+            int i = 0;
+            while (i < store.count) {
+                int n = store.count - i < 4096 ? store.count - i : 4096;
+                if (fread(chunk, sizeof(ColumnEntry), n, file) != (size_t)n) break;
+                for (int k = 0; k < n; k++, i++) {
+                    store.numbers[i] = chunk[k].account_number;
+                    store.balances[i] = chunk[k].balance;
+                }
+            }
+            // Spot-check a few slots against the records - each check pages in one record
+            loaded = i == store.count;
+            for (int k = 1; loaded && k <= 16 && k <= store.count; k++) {
+                int slot = (int)((long long)store.count * k / 16) - 1;
+                if (slot < 0) slot = 0;
+                loaded = store.numbers[slot] == store.accounts[slot].account_number;
+            }
+        }
+        fclose(file);
+    }
+    if (!loaded) {
+        for (int i = 0; i < store.count; i++) {
+            store.numbers[i] = store.accounts[i].account_number;
+            store.balances[i] = store.accounts[i].balance;
+        }
+    }
+    columnFile = fopen(ACCOUNT_COLUMN_FILE, loaded ? "r+b" : "w+b");
+    if (columnFile && !loaded) {
+        ColumnFileHeader header = {ACCOUNT_COLUMN_MAGIC, (unsigned int)store.count};
+        fwrite(&header, sizeof(header), 1, columnFile);
+        for (int i = 0; i < store.count; i++) {
+            ColumnEntry entry = {store.numbers[i], 0, store.balances[i]};
+            fwrite(&entry, sizeof(entry), 1, columnFile);
+        }
+        fflush(columnFile);
+    }
+}
+
+// Load every account from ACCOUNT_DAT_FILE into the store - called once at startup, before
+// loadCheckpoint() restores or rebuildIndexes() builds the indexes
+void loadAccounts() {
+    FILE *probe = fopen(ACCOUNT_DAT_FILE, "rb");
+    if (probe) {
+        fclose(probe);
+    } else {
+        convertTextAccounts();
+    }
+
+    int mapped = 0;
+#ifndef _WIN32
+    int fd = open(ACCOUNT_DAT_FILE, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) mapped = mapAccountImage(fd, (size_t)st.st_size);
+        close(fd);
+    }
+#endif
+    FILE *file = mapped ? NULL : fopen(ACCOUNT_DAT_FILE, "rb");
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        unsigned char *data = (unsigned char *)malloc(size > 0 ? size : 1);
+        if (fread(data, 1, size, file) == (size_t)size) loadAccountImage(data, (size_t)size);
+        free(data);
+        fclose(file);
+    }
+
+    datFile = fopen(ACCOUNT_DAT_FILE, "r+b");
+    if (!datFile) datFile = fopen(ACCOUNT_DAT_FILE, "w+b");
+    if (datFile) loadAccountColumns();
+    // A version 1 header is only rewritten once upgradeDeletedNumbers() has run
+    if (datFile && datVersionLoaded == ACCOUNT_DAT_VERSION) writeAccountCount();
+}
+
+// Append a new account to the store and to the next free slot of accounts.dat
+int saveNewAccount(const Account *acc) {
+    if (!datFile) return 0;
+    addAccountToStore(acc);
+    writeAccountSlot(store.count - 1);
+    writeAccountCount();
+    return syncAccountFile();
+}
+
+// Balance journal - each deposit/withdraw appends one "B,<account>,<balance>" line
+// before the balance is rewritten in its accounts.dat slot. Records hold absolute
+// balances, so replaying a journal that was already applied is harmless.
+const char *JOURNAL_FILE = "accounts.journal";
+#define JOURNAL_COMPACT_THRESHOLD 1000
+
+FILE *journalFile = NULL;
+int journalRecords = 0;
+
+// Group commit - when enabled, postings skip the per-write flush and wait until one fsync of
+// the journal and the ledger covers them. The first waiter leads a round: it lets postings
+// gather for up to the latency budget (or maxBatch postings), then syncs the whole batch.
+typedef struct {
+    int enabled;
+    int latencyMicros;
+    int maxBatch;
+    long long queuedSeq;    // postings written to the file buffers
+    long long durableSeq;   // postings covered by a completed sync round
+    long long failedFrom;   // postings (failedFrom, failedTo] were in a round whose fsync failed
+    long long failedTo;
+    int syncing;            // a leader is gathering or syncing a batch
+    long long rounds;
+    pthread_mutex_t lock;
+    pthread_cond_t durable;
+    pthread_cond_t batchFull;
+} GroupCommit;
+
+GroupCommit groupCommit = {0, 0, 0, 0, 0, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+// Make the in-place slot writes durable and start a fresh, empty journal (caller holds
+// journalLock); returns 1 on success
+int compactJournal() {
+    // Keep the journal unless the slots it covers are safely on disk
+    pthread_mutex_lock(&datLock);
+    int synced = datFile && syncFile(datFile) && (!columnFile || syncFile(columnFile));
+    pthread_mutex_unlock(&datLock);
+    if (!synced) return 0;
+    if (journalFile) fclose(journalFile);
+    journalFile = fopen(JOURNAL_FILE, "w");
+    journalRecords = 0;
+    return journalFile != NULL;
+}
+
+// Accounts whose balance the startup journal replay set. After a crash the ledger may lack their
+// last posting, so an incremental reconciliation checks them as well.
+int *journalRecovered = NULL;
+int journalRecoveredCount = 0;
+int journalRecoveredCapacity = 0;
+
+// Replay balance changes left in the journal since the last compaction - called once at startup
+void replayJournal() {
+    FILE *file = fopen(JOURNAL_FILE, "r");
+    if (!file) return;
+    char line[64];
+    int account_number;
+    Money balance;
+    while (fgets(line, sizeof(line), file)) {
+        int used = 0;
+        if (sscanf(line, "B,%d,%n", &account_number, &used) == 1 && used > 0 && moneyParse(line + used, &balance) > 0) {
+            int slot = findLiveAccountSlot(account_number);
+            if (slot >= 0) {
+                store.balances[slot] = balance;
+                if (datFile) writeAccountBalance(slot);
+                if (journalRecoveredCount == journalRecoveredCapacity) {
+                    journalRecoveredCapacity = journalRecoveredCapacity > 0 ? journalRecoveredCapacity * 2 : 64;
+                    journalRecovered = (int *)realloc(journalRecovered, journalRecoveredCapacity * sizeof(int));
+                }
+                journalRecovered[journalRecoveredCount++] = account_number;
+            }
+            journalRecords++;
+        }
+    }
+    fclose(file);
+}
+
+// Append one balance change to the journal, compacting once it grows large
+void journalBalance(int account_number, Money balance) {
+    char text[MONEY_TEXT_MAX];
+    moneyFormat(balance, text);
+    pthread_mutex_lock(&journalLock);
+    if (!journalFile) journalFile = fopen(JOURNAL_FILE, "a");
+    if (journalFile) {
+        long long start = metricNow();
+        fprintf(journalFile, "B,%d,%s\n", account_number, text);
+        if (!groupCommit.enabled) fflush(journalFile);
+        metricLatency(LATENCY_JOURNAL, start);
+        journalRecords++;
+    }
+    int slot = findLiveAccountSlot(account_number);
+    if (slot >= 0 && datFile) writeAccountBalance(slot);
+    if (!journalFile || journalRecords >= JOURNAL_COMPACT_THRESHOLD) {
+        compactJournal();
+    }
+    pthread_mutex_unlock(&journalLock);
+}
+
+// Account number sequence - numbers are handed out from blocks reserved in SEQUENCE_FILE, which
+// holds the end of the current reservation. The file is rewritten once per block instead of once
+// per account, and a number is never handed out twice - not even the number of a deleted account.
+// A clean close gives back the unused rest of the block; after a crash it is skipped.
+const char *SEQUENCE_FILE = "accounts.seq";
+#define ACCOUNT_NUMBER_BLOCK 4096
+
+typedef struct {
+    int next;           // next number to hand out
+    int reservedEnd;    // numbers below this are covered by SEQUENCE_FILE
+    FILE *file;
+    pthread_mutex_t lock;
+} AccountSequence;
+
+AccountSequence sequence = {2500, 2500, NULL, PTHREAD_MUTEX_INITIALIZER};
+
+// Pick up the sequence where the last run left it - called once at startup, after loadAccounts()
+void openSequence() {
+    sequence.file = fopen(SEQUENCE_FILE, "r+");
+    if (!sequence.file) sequence.file = fopen(SEQUENCE_FILE, "w+");
+    int saved = 0;
+    if (sequence.file && fscanf(sequence.file, "%d", &saved) != 1) saved = 0;
+    sequence.next = saved > store.nextAccountNumber ? saved : store.nextAccountNumber;
+    sequence.reservedEnd = sequence.next;  // nothing handed out from this run's block yet
+}
+
+// Durably reserve numbers up to end, returns 1 on success (caller holds sequence.lock)
+int reserveAccountNumbers(int end) {
+    if (!sequence.file) return 0;
+    // Fixed-width record rewritten in place, so the file is never seen empty or half written
+    fseek(sequence.file, 0, SEEK_SET);
+    fprintf(sequence.file, "%010d\n", end);
+    if (!syncFile(sequence.file)) return 0;
+    sequence.reservedEnd = end;
+    return 1;
+}
+
+// Next unused account number, or 0 if no block could be reserved
+int generateAccountNumber() {
+    pthread_mutex_lock(&sequence.lock);
+    int number = 0;
+    if (sequence.next < sequence.reservedEnd || reserveAccountNumbers(sequence.next + ACCOUNT_NUMBER_BLOCK)) {
+        number = sequence.next++;
+    }
+    pthread_mutex_unlock(&sequence.lock);
+    return number;
+}
+
+
+// Helper to format an epoch time as a date and time in PKT (Pakistan International Time, UTC+5)
+void formatDateTime(time_t t, char *datetime) {
+    t += 5 * 3600;  // shift to PKT before splitting, so day/month/year roll over correctly
+    struct tm tm = *gmtime(&t);
+    sprintf(datetime, "%02d/%02d/%04d %02d:%02d:%02d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+// Helper to get current date and time in PKT (Pakistan International Time, UTC+5)
+void getCurrentDateTime(char *datetime) {
+    formatDateTime(time(NULL), datetime);
+}
+
+// Days since 1970-01-01 for a civil date (used to turn PKT text dates back into epoch seconds)
+long long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - (int)(era * 400);
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+long long bankParseDate(const char *date) {
+    int d, m, y;
+    char extra;
+    if (sscanf(date, "%d/%d/%d%c", &d, &m, &y, &extra) != 3) return -1;
+    if (y < 1970 || m < 1 || m > 12 || d < 1) return -1;
+    long long day = daysFromCivil(y, m, d);
+    if (day >= daysFromCivil(m == 12 ? y + 1 : y, m == 12 ? 1 : m + 1, 1)) return -1;  // past the end of the month
+    return day * 86400 - 5 * 3600;
+}
+
+
+// Transaction ledger - a single append-only log for every account, split into
+// segment files (ledger_0000.seg, ledger_0001.seg, ...) of fixed-size binary records.
+// A segment holds at most LEDGER_SEGMENT_RECORDS; compaction can leave sealed segments shorter.
+// Sealed segments older than the archive age move to the cold tier: ledger_0000.arc holds the
+// same records compressed (bank_archive.c), so positions do not change.
+#define LEDGER_SEGMENT_RECORDS 65536
+
+// Per-account offset index: ledger positions (segment * LEDGER_SEGMENT_RECORDS + record
+// within the segment) of one account's entries, oldest first
+typedef struct {
+    int account_number;   // 0 = empty slot
+    int count;
+    int capacity;
+    long long *positions;
+    long long closedAt;   // timestamp of the LEDGER_CLOSE that tombstoned the account, 0 = open
+    int purging;          // being reclaimed by bankCompact()
+    int savedCount;       // positions already in the checkpoint files, -1 = reset since, save it whole
+    long long savedClosedAt;
+} LedgerIndexEntry;
+
+// Reader over the segment files, one segment open at a time - plain, or archived and
+// decompressed a block at a time
+typedef struct {
+    FILE *file;
+    ArchiveReader archive;    // used when the segment is archived (file = NULL)
+    int segment;              // -1 = none open
+} LedgerReader;
+
+typedef struct {
+    LedgerIndexEntry *entries;
+    int size;             // power of two
+    int used;
+    FILE *appendFile;     // open segment receiving new records
+    LedgerReader reader;  // cached reader for history lookups
+    long long nextPosition;
+    long long checkpointBase;   // id of the base in bank.ckpt, 0 = none: the next checkpoint writes a base
+    long long checkpointBaseBytes;
+    long long checkpointDeltaBytes;
+    long long checkpointCovered;   // nextPosition when the last checkpoint was taken
+} Ledger;
+
+#define LEDGER_READER_INIT {NULL, {NULL, 0, 0, NULL, -1, NULL, NULL, NULL, 0}, -1}
+
+Ledger ledger = {NULL, 0, 0, NULL, LEDGER_READER_INIT, 0, 0, 0, 0, 0};
+
+void ledgerSegmentName(int segment, char *filename) {
+    sprintf(filename, "ledger_%04d.seg", segment);
+}
+
+void ledgerArchiveName(int segment, char *filename) {
+    sprintf(filename, "ledger_%04d.arc", segment);
+}
+
+LedgerIndexEntry *ledgerFindEntry(int account_number, int create) {
+    if (ledger.size == 0 || (create && ledger.used * 2 >= ledger.size)) {
+        // Grow the index table and rehash every entry
+        int oldSize = ledger.size;
+        LedgerIndexEntry *old = ledger.entries;
+        ledger.size = oldSize > 0 ? oldSize * 2 : 256;
+        ledger.entries = (LedgerIndexEntry *)calloc(ledger.size, sizeof(LedgerIndexEntry));
+        for (int i = 0; i < oldSize; i++) {
+            if (old[i].account_number == 0) continue;
+            unsigned int slot = hashAccountNumber(old[i].account_number) & (unsigned int)(ledger.size - 1);
+            while (ledger.entries[slot].account_number != 0) slot = (slot + 1) & (unsigned int)(ledger.size - 1);
+            ledger.entries[slot] = old[i];
+        }
+        free(old);
+    }
+    unsigned int mask = (unsigned int)ledger.size - 1;
+    unsigned int slot = hashAccountNumber(account_number) & mask;
+    while (ledger.entries[slot].account_number != 0) {
+        if (ledger.entries[slot].account_number == account_number) return &ledger.entries[slot];
+        slot = (slot + 1) & mask;
+    }
+    if (!create) return NULL;
+    ledger.entries[slot].account_number = account_number;
+    ledger.used++;
+    return &ledger.entries[slot];
+}
+
+void ledgerResetEntry(LedgerIndexEntry *entry) {
+    free(entry->positions);
+    entry->positions = NULL;
+    entry->count = entry->capacity = 0;
+    entry->closedAt = 0;
+    entry->savedCount = -1;
+}
+
+// Apply one record to the per-account index. A close tombstones the account but keeps its
+// history for undelete; anything but a reopen after a close means the number was reused
+// (possible only in data written before tombstones), so the old owner's history is dropped.
+void ledgerIndexRecord(const LedgerRecord *rec, long long position) {
+    LedgerIndexEntry *entry = ledgerFindEntry(rec->account_number, 1);
+    if (entry->closedAt != 0 && rec->type != LEDGER_REOPEN) ledgerResetEntry(entry);
+    if (rec->type == LEDGER_CLOSE) entry->closedAt = rec->timestamp;
+    if (rec->type == LEDGER_REOPEN) entry->closedAt = 0;
+    if (entry->count == entry->capacity) {
+        entry->capacity = entry->capacity > 0 ? entry->capacity * 2 : 8;
+        entry->positions = (long long *)realloc(entry->positions, entry->capacity * sizeof(long long));
+    }
+    entry->positions[entry->count++] = position;
+}
+
+// Append records to the current segment, rolling over to a new segment whenever one is full;
+// returns how many were written
+int ledgerAppendRecords(const LedgerRecord *records, int n) {
+    pthread_mutex_lock(&ledgerLock);
+    int written = 0;
+    while (written < n) {
+        int segment = (int)(ledger.nextPosition / LEDGER_SEGMENT_RECORDS);
+        if (!ledger.appendFile || ledger.nextPosition % LEDGER_SEGMENT_RECORDS == 0) {
+            char filename[32];
+            if (ledger.appendFile) {
+                syncFile(ledger.appendFile);  // records awaiting a group commit must not be lost with the old segment
+                fclose(ledger.appendFile);
+            }
+            ledgerSegmentName(segment, filename);
+            ledger.appendFile = fopen(filename, "ab");
+        }
+        if (!ledger.appendFile) break;
+        int room = LEDGER_SEGMENT_RECORDS - (int)(ledger.nextPosition % LEDGER_SEGMENT_RECORDS);
+        int chunk = n - written < room ? n - written : room;
+        long long start = metricNow();
+        fwrite(records + written, sizeof(LedgerRecord), chunk, ledger.appendFile);
+        if (!groupCommit.enabled) fflush(ledger.appendFile);
+        metricLatency(LATENCY_LEDGER, start);
+        for (int i = 0; i < chunk; i++) {
+            ledgerIndexRecord(&records[written + i], ledger.nextPosition);
+            ledger.nextPosition++;
+        }
+        written += chunk;
+    }
+    pthread_mutex_unlock(&ledgerLock);
+    return written;
+}
+
+void ledgerAppend(const LedgerRecord *rec) {
+    ledgerAppendRecords(rec, 1);
+}
+
+void ledgerReaderClose(LedgerReader *reader) {
+    if (reader->file) fclose(reader->file);
+    archiveClose(&reader->archive);
+    reader->file = NULL;
+    reader->segment = -1;
+}
+
+// Read the record at a ledger position, returns 1 on success
+int ledgerReaderRead(LedgerReader *reader, long long position, LedgerRecord *rec) {
+    int segment = (int)(position / LEDGER_SEGMENT_RECORDS);
+    int offset = (int)(position % LEDGER_SEGMENT_RECORDS);
+    if (segment != reader->segment) {
+        char filename[32];
+        ledgerReaderClose(reader);
+        ledgerSegmentName(segment, filename);
+        reader->file = fopen(filename, "rb");
+        if (!reader->file) {
+            ledgerArchiveName(segment, filename);
+            if (!archiveOpen(&reader->archive, filename)) return 0;
+        }
+        reader->segment = segment;
+    }
+    if (!reader->file) return archiveRead(&reader->archive, offset, rec);
+    fseek(reader->file, (long)offset * (long)sizeof(LedgerRecord), SEEK_SET);
+    return fread(rec, sizeof(LedgerRecord), 1, reader->file) == 1;
+}
+
+// Read through the shared history reader (caller holds ledgerLock)
+int ledgerRead(long long position, LedgerRecord *rec) {
+    return ledgerReaderRead(&ledger.reader, position, rec);
+}
+
+// Format a record the way the old transactions_<n>.txt lines looked
+void formatLedgerRecord(const LedgerRecord *rec, char *line) {
+    char datetime[20];
+    formatDateTime((time_t)rec->timestamp, datetime);
+    if (rec->type == LEDGER_CLOSE || rec->type == LEDGER_REOPEN || rec->type == LEDGER_OPEN) {
+        sprintf(line, "%s: Account %s", datetime, rec->type == LEDGER_CLOSE ? "closed" : rec->type == LEDGER_REOPEN ? "restored" : "opened");
+        return;
+    }
+    const char *kind = rec->type == LEDGER_DEPOSIT ? "Deposit" : rec->type == LEDGER_INTEREST ? "Interest" : "Withdraw";
+    char amount[MONEY_TEXT_MAX];
+    char balance[MONEY_TEXT_MAX];
+    moneyFormat(rec->amount, amount);
+    moneyFormat(rec->balance, balance);
+    sprintf(line, "%s: %s %s, Balance: %s", datetime, kind, amount, balance);
+}
+
+// One-time import of the old per-account transactions_<n>.txt files (they are left in place)
+void importLegacyTransactions() {
+    for (int i = 0; i < store.count; i++) {
+        char filename[50];
+        sprintf(filename, "transactions_%d.txt", store.accounts[i].account_number);
+        FILE *file = fopen(filename, "r");
+        if (!file) continue;
+        char line[200];
+        char type[20];
+        int d, mo, y, h, mi, sec;
+        LedgerRecord rec;
+        while (fgets(line, sizeof(line), file)) {
+            // "dd/mm/yyyy hh:mm:ss: Deposit 100.00, Balance: 250.00"
+            int used = 0;
+            if (sscanf(line, "%d/%d/%d %d:%d:%d: %19s %n", &d, &mo, &y, &h, &mi, &sec, type, &used) != 7 || used == 0) continue;
+            const char *p = line + used;
+            int n = moneyParse(p, &rec.amount);
+            if (n > 0 && strncmp(p + n, ", Balance: ", 11) == 0 && moneyParse(p + n + 11, &rec.balance) > 0) {
+                rec.timestamp = daysFromCivil(y, mo, d) * 86400 + h * 3600 + mi * 60 + sec - 5 * 3600;
+                rec.account_number = store.accounts[i].account_number;
+                rec.type = strcmp(type, "Deposit") == 0 ? LEDGER_DEPOSIT : LEDGER_WITHDRAW;
+                ledgerAppend(&rec);
+            }
+        }
+        fclose(file);
+    }
+}
+
+// Checkpoints - the account hash indexes and the per-account ledger index, saved with the
+// ledger position they cover. Startup maps them in and then indexes only what came after:
+// accounts added to accounts.dat since, and ledger records appended since, instead of
+// rehashing every account and scanning every segment.
+// bank.ckpt holds everything (the base); later checkpoints append just the ledger entries that
+// changed to bank.ckpt.delta, until that outgrows half the base and a new base replaces both.
+// accounts.dat and the segments stay the source of truth: a missing, damaged or stale checkpoint
+// only costs a longer startup. Compaction moves account slots and ledger positions, so it
+// discards the checkpoints before it changes anything.
+#define CHECKPOINT_MAGIC 0x434B4E42u        // "BNKC"
+#define CHECKPOINT_DELTA_MAGIC 0x444B4E42u  // "BNKD"
+#define CHECKPOINT_VERSION 1
+
+const char *CHECKPOINT_FILE = "bank.ckpt";
+const char *CHECKPOINT_TMP_FILE = "bank.ckpt.tmp";
+const char *CHECKPOINT_DELTA_FILE = "bank.ckpt.delta";
+
+// A base is one block and the delta file a sequence of them. A block is this header, then in
+// a base the account indexes (numberIndex, mobileIndex, mobileBloom), then per ledger entry a
+// CheckpointEntry followed by its positions, then a checksum of everything after the header.
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    long long baseId;         // deltas apply only to the base with this id
+    long long covered;        // the ledger index reflects every record before this position
+    long long entryCount;
+    long long positionCount;
+    int accountCount;         // base: the indexes cover accounts.dat slots 0 .. accountCount - 1
+    int indexSize;            // base: store.indexSize, 0 in deltas
+    int lastAccountNumber;    // base: account number in slot accountCount - 1, to catch a replaced accounts.dat
+    int nextAccountNumber;    // base: store.nextAccountNumber
+} CheckpointHeader;
+
+typedef struct {
+    int account_number;
+    int count;                // positions that follow
+    long long closedAt;
+    int replace;              // deltas: drop the positions saved so far first
+    int reserved;
+} CheckpointEntry;
+
+// One checkpoint or compaction at a time
+pthread_mutex_t checkpointLock = PTHREAD_MUTEX_INITIALIZER;
+
+unsigned long long checkpointChecksum(unsigned long long h, const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (; size >= 8; size -= 8, p += 8) {
+        unsigned long long word;
+        memcpy(&word, p, 8);
+        h = (h ^ word) * 1099511628211ULL;
+    }
+    for (; size > 0; size--) h = (h ^ *p++) * 1099511628211ULL;
+    return h;
+}
+
+int checkpointWrite(FILE *file, const void *data, size_t size, unsigned long long *sum) {
+    *sum = checkpointChecksum(*sum, data, size);
+    return fwrite(data, 1, size, file) == size;
+}
+
+size_t checkpointIndexBytes(int indexSize) {
+    return (size_t)indexSize * (sizeof(int) + sizeof(MobileSlot)) + (size_t)(indexSize / 4) * sizeof(unsigned long long);
+}
+
+int checkpointEntryChanged(const LedgerIndexEntry *entry) {
+    return entry->account_number != 0 && (entry->savedCount != entry->count || entry->savedClosedAt != entry->closedAt);
+}
+
+// Write one block - a base with the account indexes and every ledger entry, or a delta with the
+// ledger entries changed since the last checkpoint - and mark the entries saved. Returns the
+// bytes written, -1 on error (caller holds ledgerLock, and storeLock for a base).
+long long writeCheckpointBlock(FILE *file, int full, long long baseId) {
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = full ? CHECKPOINT_MAGIC : CHECKPOINT_DELTA_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.baseId = baseId;
+    header.covered = ledger.nextPosition;
+    if (full) {
+        header.accountCount = store.count;
+        header.indexSize = store.indexSize;
+        header.lastAccountNumber = store.count > 0 ? store.numbers[store.count - 1] : 0;
+        header.nextAccountNumber = store.nextAccountNumber;
+    }
+    for (int i = 0; i < ledger.size; i++) {
+        const LedgerIndexEntry *entry = &ledger.entries[i];
+        if (entry->account_number == 0 || (!full && !checkpointEntryChanged(entry))) continue;
+        header.entryCount++;
+        header.positionCount += full || entry->savedCount < 0 ? entry->count : entry->count - entry->savedCount;
+    }
+    if (fwrite(&header, sizeof(header), 1, file) != 1) return -1;
+
+    unsigned long long sum = 14695981039346656037ULL;
+    int ok = !full || (checkpointWrite(file, store.numberIndex, store.indexSize * sizeof(int), &sum) &&
+                       checkpointWrite(file, store.mobileIndex, store.indexSize * sizeof(MobileSlot), &sum) &&
+                       checkpointWrite(file, store.mobileBloom, (store.indexSize / 4) * sizeof(unsigned long long), &sum));
+    for (int i = 0; i < ledger.size && ok; i++) {
+        LedgerIndexEntry *entry = &ledger.entries[i];
+        if (entry->account_number == 0 || (!full && !checkpointEntryChanged(entry))) continue;
+        int from = full || entry->savedCount < 0 ? 0 : entry->savedCount;
+        CheckpointEntry out;
+        memset(&out, 0, sizeof(out));
+        out.account_number = entry->account_number;
+        out.count = entry->count - from;
+        out.closedAt = entry->closedAt;
+        out.replace = !full && entry->savedCount < 0;
+        ok = checkpointWrite(file, &out, sizeof(out), &sum) &&
+             checkpointWrite(file, entry->positions + from, (size_t)out.count * sizeof(long long), &sum);
+        entry->savedCount = entry->count;
+        entry->savedClosedAt = entry->closedAt;
+    }
+    if (!ok || fwrite(&sum, sizeof(sum), 1, file) != 1) return -1;
+    return (long long)(sizeof(header) + checkpointIndexBytes(header.indexSize) + sizeof(sum)) +
+           header.entryCount * (long long)sizeof(CheckpointEntry) + header.positionCount * (long long)sizeof(long long);
+}
+
+// Check one block at data[0..size) and return its length, 0 if it is damaged or cut short
+size_t checkpointBlockLength(const unsigned char *data, size_t size, unsigned int magic) {
+    CheckpointHeader header;
+    if (size < sizeof(header)) return 0;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != magic || header.version != CHECKPOINT_VERSION || header.entryCount < 0 || header.positionCount < 0) return 0;
+    if (header.indexSize < 0 || (header.indexSize & (header.indexSize - 1)) != 0 || header.accountCount < 0 || header.accountCount > header.indexSize / 2) return 0;
+    unsigned long long payload = checkpointIndexBytes(header.indexSize) + (unsigned long long)header.entryCount * sizeof(CheckpointEntry) +
+                                 (unsigned long long)header.positionCount * sizeof(long long);
+    if (payload > size - sizeof(header) || size - sizeof(header) - payload < sizeof(unsigned long long)) return 0;
+    unsigned long long sum;
+    memcpy(&sum, data + sizeof(header) + payload, sizeof(sum));
+    if (checkpointChecksum(14695981039346656037ULL, data + sizeof(header), (size_t)payload) != sum) return 0;
+    return sizeof(header) + (size_t)payload + sizeof(sum);
+}
+
+// Apply the ledger entries of a checked block to the index
+void applyCheckpointEntries(const unsigned char *data) {
+    CheckpointHeader header;
+    memcpy(&header, data, sizeof(header));
+    const unsigned char *p = data + sizeof(header) + checkpointIndexBytes(header.indexSize);
+    for (long long i = 0; i < header.entryCount; i++) {
+        CheckpointEntry in;
+        memcpy(&in, p, sizeof(in));
+        p += sizeof(in);
+        LedgerIndexEntry *entry = ledgerFindEntry(in.account_number, 1);
+        if (in.replace) entry->count = 0;
+        if (entry->count + in.count > entry->capacity) {
+            entry->capacity = entry->count + in.count;
+            entry->positions = (long long *)realloc(entry->positions, entry->capacity * sizeof(long long));
+        }
+        if (in.count > 0) memcpy(entry->positions + entry->count, p, (size_t)in.count * sizeof(long long));
+        p += (size_t)in.count * sizeof(long long);
+        entry->count += in.count;
+        entry->closedAt = in.closedAt;
+        entry->savedCount = entry->count;
+        entry->savedClosedAt = entry->closedAt;
+    }
+}
+
+// Load a base image (mapped or read) into the store indexes and the empty ledger index.
+// Returns its header, or one with magic 0 if it is unusable.
+CheckpointHeader loadCheckpointBase(const unsigned char *data, size_t size) {
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    if (checkpointBlockLength(data, size, CHECKPOINT_MAGIC) == 0) return header;
+    memcpy(&header, data, sizeof(header));
+    if (header.indexSize == 0 || header.accountCount > store.count ||
+        (header.accountCount > 0 && store.numbers[header.accountCount - 1] != header.lastAccountNumber)) {
+        header.magic = 0;
+        return header;
+    }
+
+    const unsigned char *p = data + sizeof(header);
+    free(store.numberIndex);
+    free(store.mobileIndex);
+    free(store.mobileBloom);
+    store.indexSize = header.indexSize;
+    store.numberIndex = (int *)malloc(store.indexSize * sizeof(int));
+    store.mobileIndex = (MobileSlot *)malloc(store.indexSize * sizeof(MobileSlot));
+    store.mobileBloom = (unsigned long long *)malloc((store.indexSize / 4) * sizeof(unsigned long long));
+    memcpy(store.numberIndex, p, store.indexSize * sizeof(int));
+    p += store.indexSize * sizeof(int);
+    memcpy(store.mobileIndex, p, store.indexSize * sizeof(MobileSlot));
+    p += store.indexSize * sizeof(MobileSlot);
+    memcpy(store.mobileBloom, p, (store.indexSize / 4) * sizeof(unsigned long long));
+    if (header.nextAccountNumber > store.nextAccountNumber) store.nextAccountNumber = header.nextAccountNumber;
+    // Accounts created after the checkpoint
+    for (int i = header.accountCount; i < store.count; i++) {
+        if ((i + 1) * 2 > store.indexSize) {
+            rebuildIndexes();
+            break;
+        }
+        indexAccount(i);
+    }
+
+    // Size the ledger table for every entry up front so loading never rehashes
+    int tableSize = 256;
+    while (tableSize <= header.entryCount * 2) tableSize *= 2;
+    ledger.size = tableSize;
+    ledger.entries = (LedgerIndexEntry *)calloc(ledger.size, sizeof(LedgerIndexEntry));
+    applyCheckpointEntries(data);
+    return header;
+}
+
+// Records in a segment, whether it is a plain segment or archived; -1 if it is neither
+int ledgerSegmentRecords(int segment) {
+    char filename[32];
+    ledgerSegmentName(segment, filename);
+    FILE *file = fopen(filename, "rb");
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fclose(file);
+        return (int)(size / (long)sizeof(LedgerRecord));
+    }
+    ArchiveReader reader;
+    ledgerArchiveName(segment, filename);
+    if (!archiveOpen(&reader, filename)) return -1;
+    int count = reader.count;
+    archiveClose(&reader);
+    return count;
+}
+
+// The segments must still hold every record a checkpoint covers
+int ledgerCovers(long long covered) {
+    if (covered == 0) return 1;
+    return ledgerSegmentRecords((int)((covered - 1) / LEDGER_SEGMENT_RECORDS)) >= (int)((covered - 1) % LEDGER_SEGMENT_RECORDS + 1);
+}
+
+void freeLedgerIndex() {
+    for (int i = 0; i < ledger.size; i++) {
+        free(ledger.entries[i].positions);
+    }
+    free(ledger.entries);
+    ledger.entries = NULL;
+    ledger.size = ledger.used = 0;
+}
+
+// Load bank.ckpt and the deltas that extend it, after loadAccounts(). Returns the ledger
+// position they cover, or -1 when there is no usable checkpoint: the caller then rebuilds the
+// account indexes and scans every segment.
+long long loadCheckpoint() {
+    CheckpointHeader base;
+    memset(&base, 0, sizeof(base));
+#ifdef _WIN32
+    FILE *file = fopen(CHECKPOINT_FILE, "rb");
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        unsigned char *data = (unsigned char *)malloc(size > 0 ? size : 1);
+        if (fread(data, 1, size, file) == (size_t)size) base = loadCheckpointBase(data, (size_t)size);
+        free(data);
+        fclose(file);
+    }
+#else
+    int fd = open(CHECKPOINT_FILE, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                base = loadCheckpointBase((const unsigned char *)data, (size_t)st.st_size);
+                munmap(data, (size_t)st.st_size);
+            }
+        }
+        close(fd);
+    }
+#endif
+    if (base.magic == 0) {
+        freeLedgerIndex();
+        return -1;
+    }
+
+    long long covered = base.covered;
+    long long deltaBytes = 0;
+    int deltaClean = 1;
+    FILE *deltas = fopen(CHECKPOINT_DELTA_FILE, "rb");
+    if (deltas) {
+        fseek(deltas, 0, SEEK_END);
+        long size = ftell(deltas);
+        fseek(deltas, 0, SEEK_SET);
+        unsigned char *data = (unsigned char *)malloc(size > 0 ? size : 1);
+        if (fread(data, 1, size, deltas) != (size_t)size) size = 0;
+        fclose(deltas);
+        size_t offset = 0;
+        while (offset < (size_t)size) {
+            // Blocks from an older base or cut short by a crash end the usable part of the file
+            size_t length = checkpointBlockLength(data + offset, (size_t)size - offset, CHECKPOINT_DELTA_MAGIC);
+            CheckpointHeader header;
+            if (length > 0) memcpy(&header, data + offset, sizeof(header));
+            if (length == 0 || header.baseId != base.baseId || header.covered < covered) {
+                deltaClean = 0;
+                break;
+            }
+            applyCheckpointEntries(data + offset);
+            covered = header.covered;
+            offset += length;
+        }
+        deltaBytes = (long long)offset;
+        free(data);
+    }
+
+    if (!ledgerCovers(covered)) {
+        freeLedgerIndex();
+        return -1;
+    }
+    // A delta file with unusable blocks at the end is only cleared by writing a new base
+    ledger.checkpointBase = deltaClean ? base.baseId : 0;
+    ledger.checkpointBaseBytes = (long long)(sizeof(base) + checkpointIndexBytes(base.indexSize)) +
+                                 base.entryCount * (long long)sizeof(CheckpointEntry) + base.positionCount * (long long)sizeof(long long);
+    ledger.checkpointDeltaBytes = deltaBytes;
+    ledger.checkpointCovered = covered;
+    return covered;
+}
+
+// Drop the checkpoint files (caller holds checkpointLock)
+void discardCheckpoints() {
+    pthread_mutex_lock(&ledgerLock);
+    ledger.checkpointBase = 0;
+    pthread_mutex_unlock(&ledgerLock);
+    remove(CHECKPOINT_FILE);
+    remove(CHECKPOINT_DELTA_FILE);
+}
+
+// Scan the segments from position to the end, indexing every record; returns how many segment
+// files were opened
+int ledgerScanFrom(long long position) {
+    LedgerRecord buffer[1024];
+    int segment = (int)(position / LEDGER_SEGMENT_RECORDS);
+    long offset = (long)(position % LEDGER_SEGMENT_RECORDS);
+    int opened = 0;
+    ledger.nextPosition = position;
+    for (; ; segment++, offset = 0) {
+        char filename[32];
+        ledgerSegmentName(segment, filename);
+        FILE *file = fopen(filename, "rb");
+        ArchiveReader reader;
+        if (!file) {
+            ledgerArchiveName(segment, filename);
+            if (!archiveOpen(&reader, filename)) break;
+        }
+        opened++;
+        // New records go after the last segment's records, so that one may be a compacted, shorter segment
+        ledger.nextPosition = (long long)segment * LEDGER_SEGMENT_RECORDS + offset;
+        if (!file) {
+            // A damaged block loses its own records only; the rest keep their positions
+            for (int i = (int)offset; i < reader.count; i++) {
+                LedgerRecord rec;
+                if (archiveRead(&reader, i, &rec)) ledgerIndexRecord(&rec, ledger.nextPosition);
+                ledger.nextPosition++;
+            }
+            archiveClose(&reader);
+            continue;
+        }
+        if (offset > 0) fseek(file, offset * (long)sizeof(LedgerRecord), SEEK_SET);
+        size_t n;
+        while ((n = fread(buffer, sizeof(LedgerRecord), 1024, file)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                ledgerIndexRecord(&buffer[i], ledger.nextPosition++);
+            }
+        }
+        fclose(file);
+    }
+    return opened;
+}
+
+// Bring the per-account index up to date - from covered, the position loadCheckpoint() returned,
+// or by scanning every segment when that is -1. Called once at startup.
+void openLedger(long long covered) {
+    if (covered >= 0) {
+        ledgerScanFrom(covered);
+    } else if (ledgerScanFrom(0) == 0) {
+        importLegacyTransactions();
+    }
+}
+
+// Number of ledger entries recorded for an account
+int ledgerHistoryCount(int account_number) {
+    pthread_mutex_lock(&ledgerLock);
+    LedgerIndexEntry *entry = ledgerFindEntry(account_number, 0);
+    int count = entry ? entry->count : 0;
+    pthread_mutex_unlock(&ledgerLock);
+    return count;
+}
+
+// Read the n-th (oldest first) ledger entry of an account
+int ledgerHistoryEntry(int account_number, int n, LedgerRecord *rec) {
+    pthread_mutex_lock(&ledgerLock);
+    LedgerIndexEntry *entry = ledgerFindEntry(account_number, 0);
+    int ok = entry && n >= 0 && n < entry->count && ledgerRead(entry->positions[n], rec);
+    pthread_mutex_unlock(&ledgerLock);
+    return ok;
+}
+
+// Move one index position of an account to where its record now sits
+void ledgerMovePosition(int account_number, long long from, long long to) {
+    LedgerIndexEntry *entry = ledgerFindEntry(account_number, 0);
+    if (!entry) return;
+    int lo = 0, hi = entry->count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (entry->positions[mid] < from) lo = mid + 1;
+        else if (entry->positions[mid] > from) hi = mid - 1;
+        else {
+            entry->positions[mid] = to;
+            return;
+        }
+    }
+}
+
+// Read a whole sealed segment, plain or archived, into records (room for LEDGER_SEGMENT_RECORDS);
+// returns the record count, -1 if it is missing or damaged. *archived tells which it was.
+int ledgerLoadSegment(int segment, LedgerRecord *records, int *archived) {
+    char filename[32];
+    ledgerSegmentName(segment, filename);
+    FILE *in = fopen(filename, "rb");
+    *archived = in == NULL;
+    if (in) {
+        int n = (int)fread(records, sizeof(LedgerRecord), LEDGER_SEGMENT_RECORDS, in);
+        fclose(in);
+        return n;
+    }
+    ArchiveReader reader;
+    ledgerArchiveName(segment, filename);
+    if (!archiveOpen(&reader, filename)) return -1;
+    int n = reader.count <= LEDGER_SEGMENT_RECORDS ? archiveReadAll(&reader, records) : -1;
+    archiveClose(&reader);
+    return n;
+}
+
+// Write the new content of a segment to tmpname and sync it - as a plain segment, or as an
+// archive that is read back and compared before anything is replaced by it. Returns 1 on success.
+int ledgerWriteSegment(const char *tmpname, const LedgerRecord *records, int n, int archived) {
+    FILE *out = fopen(tmpname, "wb");
+    int ok = out != NULL;
+    if (ok && archived) ok = archiveWrite(out, records, n) >= 0;
+    else if (ok) ok = fwrite(records, sizeof(LedgerRecord), n, out) == (size_t)n;
+    ok = ok && syncFile(out);
+    if (out && fclose(out) != 0) ok = 0;
+    if (ok && archived) {
+        ArchiveReader reader;
+        LedgerRecord *check = (LedgerRecord *)malloc((n > 0 ? n : 1) * sizeof(LedgerRecord));
+        ok = archiveOpen(&reader, tmpname) && reader.count == n && archiveReadAll(&reader, check) == n &&
+             memcmp(check, records, n * sizeof(LedgerRecord)) == 0;
+        archiveClose(&reader);
+        free(check);
+    }
+    if (!ok) remove(tmpname);
+    return ok;
+}
+
+// Put a written temp file in place of the segment; once it is archived the plain segment goes
+// (caller holds ledgerLock)
+int ledgerReplaceSegment(int segment, const char *tmpname, int archived) {
+    char filename[32];
+    char plain[32];
+    ledgerSegmentName(segment, plain);
+    if (archived) ledgerArchiveName(segment, filename);
+    else strcpy(filename, plain);
+    if (ledger.reader.segment == segment) ledgerReaderClose(&ledger.reader);
+#ifdef _WIN32
+    remove(filename);  // rename does not replace an existing file on Windows
+#endif
+    if (rename(tmpname, filename) != 0) {
+        remove(tmpname);
+        return 0;
+    }
+    if (archived) remove(plain);
+    return 1;
+}
+
+// Rewrite one sealed segment without the records of purging accounts, then move the positions
+// of the records that stay. Returns 1 on success (caller holds ledgerLock).
+int ledgerCompactSegment(int segment) {
+    LedgerRecord *records = (LedgerRecord *)malloc(LEDGER_SEGMENT_RECORDS * sizeof(LedgerRecord));
+    int *from = (int *)malloc(LEDGER_SEGMENT_RECORDS * sizeof(int));
+    int archived;
+    int n = ledgerLoadSegment(segment, records, &archived);
+
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        LedgerIndexEntry *entry = ledgerFindEntry(records[i].account_number, 0);
+        if (entry && entry->purging) continue;
+        from[kept] = i;
+        records[kept++] = records[i];
+    }
+    int ok = n >= 0;
+    if (kept < n) {
+        char tmpname[40];
+        sprintf(tmpname, "ledger_%04d.tmp", segment);
+        ok = ledgerWriteSegment(tmpname, records, kept, archived) && ledgerReplaceSegment(segment, tmpname, archived);
+        if (ok) {
+            long long base = (long long)segment * LEDGER_SEGMENT_RECORDS;
+            for (int i = 0; i < kept; i++) {
+                if (from[i] != i) ledgerMovePosition(records[i].account_number, base + from[i], base + i);
+            }
+        }
+    }
+    free(records);
+    free(from);
+    return ok;
+}
+
+// Drop the ledger entries of accounts deleted before cutoff: sealed segments holding any are
+// rewritten one at a time, so postings wait at most one segment rewrite. Records still in the
+// open segment stay on disk and are reclaimed by a later pass once that segment is sealed.
+// Returns the number of accounts whose entries were dropped.
+int ledgerPurgeClosed(long long cutoff) {
+    pthread_mutex_lock(&ledgerLock);
+    int sealed = (int)(ledger.nextPosition / LEDGER_SEGMENT_RECORDS);
+    unsigned char *touched = (unsigned char *)calloc(sealed + 1, 1);
+    int purged = 0;
+    for (int i = 0; i < ledger.size; i++) {
+        LedgerIndexEntry *entry = &ledger.entries[i];
+        if (entry->account_number == 0 || entry->closedAt == 0 || entry->closedAt > cutoff) continue;
+        entry->purging = 1;
+        purged++;
+        for (int k = 0; k < entry->count; k++) {
+            int segment = (int)(entry->positions[k] / LEDGER_SEGMENT_RECORDS);
+            if (segment < sealed) touched[segment] = 1;
+        }
+    }
+    pthread_mutex_unlock(&ledgerLock);
+
+    for (int segment = 0; segment < sealed; segment++) {
+        if (!touched[segment]) continue;
+        pthread_mutex_lock(&ledgerLock);
+        ledgerCompactSegment(segment);
+        pthread_mutex_unlock(&ledgerLock);
+    }
+    free(touched);
+
+    pthread_mutex_lock(&ledgerLock);
+    for (int i = 0; i < ledger.size; i++) {
+        LedgerIndexEntry *entry = &ledger.entries[i];
+        if (!entry->purging) continue;
+        // Records in the then-open segment are still on disk: they stay indexed (and closed)
+        // for the pass after that segment is sealed, and so do they in a checkpoint
+        int kept = 0;
+        for (int k = 0; k < entry->count; k++) {
+            if (entry->positions[k] >= (long long)sealed * LEDGER_SEGMENT_RECORDS) entry->positions[kept++] = entry->positions[k];
+        }
+        if (kept == 0) {
+            ledgerResetEntry(entry);  // the slot stays, keeping probe chains intact
+        } else if (kept < entry->count) {
+            entry->count = kept;
+            entry->savedCount = -1;
+        }
+        entry->purging = 0;
+    }
+    pthread_mutex_unlock(&ledgerLock);
+    return purged;
+}
+
+// Move the sealed segments whose records are all older than cutoff to the archive tier. Records
+// keep their positions, so the index and the checkpoints stay valid; postings wait only for the
+// rename. Returns the number of segments archived (caller holds checkpointLock, which keeps
+// compaction from rewriting a segment meanwhile).
+int ledgerArchiveSegments(long long cutoff) {
+    pthread_mutex_lock(&ledgerLock);
+    // The append handle may still be on the last full segment until the next record rolls it over
+    int sealed = ledger.nextPosition > 0 ? (int)((ledger.nextPosition - 1) / LEDGER_SEGMENT_RECORDS) : 0;
+    pthread_mutex_unlock(&ledgerLock);
+    LedgerRecord *records = (LedgerRecord *)malloc(LEDGER_SEGMENT_RECORDS * sizeof(LedgerRecord));
+    int archived = 0;
+    for (int segment = 0; segment < sealed; segment++) {
+        char filename[32];
+        ledgerSegmentName(segment, filename);
+        FILE *in = fopen(filename, "rb");
+        if (!in) continue;  // archived already
+        int n = (int)fread(records, sizeof(LedgerRecord), LEDGER_SEGMENT_RECORDS, in);
+        fclose(in);
+        int old = n > 0;
+        for (int i = 0; i < n && old; i++) old = records[i].timestamp <= cutoff;
+        if (!old) continue;
+        char tmpname[40];
+        sprintf(tmpname, "ledger_%04d.tmp", segment);
+        if (!ledgerWriteSegment(tmpname, records, n, 1)) continue;
+        pthread_mutex_lock(&ledgerLock);
+        if (ledgerReplaceSegment(segment, tmpname, 1)) archived++;
+        pthread_mutex_unlock(&ledgerLock);
+    }
+    free(records);
+    return archived;
+}
+
+// fsync the journal and the open ledger segment, returns 1 on success
+int syncPostings() {
+    pthread_mutex_lock(&journalLock);
+    int ok = !journalFile || syncFile(journalFile);
+    pthread_mutex_unlock(&journalLock);
+    pthread_mutex_lock(&ledgerLock);
+    if (ledger.appendFile && !syncFile(ledger.appendFile)) ok = 0;
+    pthread_mutex_unlock(&ledgerLock);
+    return ok;
+}
+
+// Count a posting whose journal line and ledger record are written; returns its sequence number
+long long queuePosting() {
+    pthread_mutex_lock(&groupCommit.lock);
+    long long seq = ++groupCommit.queuedSeq;
+    if (groupCommit.queuedSeq - groupCommit.durableSeq >= groupCommit.maxBatch) {
+        pthread_cond_signal(&groupCommit.batchFull);
+    }
+    pthread_mutex_unlock(&groupCommit.lock);
+    return seq;
+}
+
+// Block until posting seq is on disk, leading a sync round when none is running.
+// Returns 0 if the round covering it failed to sync.
+int waitForCommit(long long seq) {
+    pthread_mutex_lock(&groupCommit.lock);
+    while (groupCommit.durableSeq < seq) {
+        if (groupCommit.syncing) {
+            pthread_cond_wait(&groupCommit.durable, &groupCommit.lock);
+            continue;
+        }
+        groupCommit.syncing = 1;
+        if (groupCommit.latencyMicros > 0) {
+            // Let more postings join until the budget runs out or the batch is full
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            long long nanos = deadline.tv_nsec + (long long)groupCommit.latencyMicros * 1000;
+            deadline.tv_sec += (time_t)(nanos / 1000000000);
+            deadline.tv_nsec = (long)(nanos % 1000000000);
+            while (groupCommit.queuedSeq - groupCommit.durableSeq < groupCommit.maxBatch) {
+                if (pthread_cond_timedwait(&groupCommit.batchFull, &groupCommit.lock, &deadline) != 0) break;
+            }
+        }
+        long long target = groupCommit.queuedSeq;
+        pthread_mutex_unlock(&groupCommit.lock);
+        int ok = syncPostings();
+        pthread_mutex_lock(&groupCommit.lock);
+        if (!ok) {
+            groupCommit.failedFrom = groupCommit.durableSeq;
+            groupCommit.failedTo = target;
+        }
+        groupCommit.durableSeq = target;
+        groupCommit.syncing = 0;
+        groupCommit.rounds++;
+        pthread_cond_broadcast(&groupCommit.durable);
+    }
+    int ok = !(seq > groupCommit.failedFrom && seq <= groupCommit.failedTo);
+    pthread_mutex_unlock(&groupCommit.lock);
+    return ok;
+}
+
+// Helper to log transaction
+void logTransactionAt(long long timestamp, int account_number, LedgerType type, Money amount, Money new_balance) {
+    LedgerRecord rec;
+    rec.timestamp = timestamp;
+    rec.account_number = account_number;
+    rec.type = type;
+    rec.amount = amount;
+    rec.balance = new_balance;
+    ledgerAppend(&rec);
+}
+
+void logTransaction(int account_number, LedgerType type, Money amount, Money new_balance) {
+    logTransactionAt((long long)time(NULL), account_number, type, amount, new_balance);
+}
+
+// Update information - allows updating user details
+void updateInformation(Account *user) {
+    int slot = findLiveAccountSlot(user->account_number);
+    if (slot < 0) return;
+    store.accounts[slot] = *user;
+    store.balances[slot] = user->balance;
+    if (datFile) {
+        writeAccountSlot(slot);
+        syncAccountFile();
+    }
+}
+
+// Delete account - tombstones the account. The record, balance and history stay until
+// bankCompact() reclaims them after the retention period; the close record in the ledger
+// is what makes the tombstone durable.
+void deleteAccount(Account *user) {
+    Account *acc = findAccountByNumber(user->account_number);
+    if (!acc) return;
+    long long now = (long long)time(NULL);
+    store.deletedAt[acc - store.accounts] = now;
+    store.deletedCount++;
+    logTransactionAt(now, user->account_number, LEDGER_CLOSE, 0, 0);
+}
+
+// Deleted accounts stay restorable for this long before compaction removes them
+long long deleteRetention = 30LL * 24 * 3600;
+// Compaction archives sealed ledger segments once their newest record is this old (< 0 = never)
+long long archiveAge = 90LL * 24 * 3600;
+
+// Mark the accounts whose ledger ends in a close record as deleted - called once at startup
+void applyTombstones() {
+    for (int i = 0; i < ledger.size; i++) {
+        LedgerIndexEntry *entry = &ledger.entries[i];
+        if (entry->account_number == 0 || entry->closedAt == 0) continue;
+        int slot = findAccountSlot(entry->account_number);
+        if (slot >= 0 && store.deletedAt[slot] == 0) {
+            store.deletedAt[slot] = entry->closedAt;
+            store.deletedCount++;
+        }
+    }
+}
+
+// One-time upgrade of version 1 data, where deleting removed the record at once and the number
+// could be handed out again. A live account whose number's ledger ends in a close is such a
+// reuse: an open record separates it from the old owner's history before tombstones apply.
+void upgradeDeletedNumbers() {
+    for (int i = 0; i < store.count; i++) {
+        LedgerIndexEntry *entry = ledgerFindEntry(store.numbers[i], 0);
+        if (entry && entry->closedAt != 0) {
+            logTransaction(store.numbers[i], LEDGER_OPEN, 0, store.balances[i]);
+        }
+    }
+    if (ledger.appendFile) syncFile(ledger.appendFile);
+    writeAccountCount();  // the version 2 header marks the upgrade as done
+    syncAccountFile();
+}
+
+// Physically remove tombstoned accounts deleted before cutoff, returns how many
+int purgeDeletedAccounts(long long cutoff) {
+    int purged = 0;
+    // Walk backwards so the record moved into a freed slot has already been looked at
+    for (int i = store.count - 1; i >= 0; i--) {
+        if (store.deletedAt[i] == 0 || store.deletedAt[i] > cutoff) continue;
+        removeAccountSlot(i);
+        if (i < store.count) writeAccountSlot(i);
+        purged++;
+    }
+    if (purged > 0) {
+        rebuildIndexes();
+        writeAccountCount();
+        syncAccountFile();
+    }
+    return purged;
+}
+
+// Background compaction thread
+pthread_t compactorThread;
+int compactorRunning = 0;
+int compactorInterval = 0;
+pthread_mutex_t compactorLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t compactorStop = PTHREAD_COND_INITIALIZER;
+
+void *compactorMain(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&compactorLock);
+    while (compactorRunning) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += compactorInterval;
+        pthread_cond_timedwait(&compactorStop, &compactorLock, &deadline);
+        if (!compactorRunning) break;
+        pthread_mutex_unlock(&compactorLock);
+        bankCompact();
+        pthread_mutex_lock(&compactorLock);
+    }
+    pthread_mutex_unlock(&compactorLock);
+    return NULL;
+}
+
+void stopCompactor() {
+    pthread_mutex_lock(&compactorLock);
+    int running = compactorRunning;
+    compactorRunning = 0;
+    pthread_cond_signal(&compactorStop);
+    pthread_mutex_unlock(&compactorLock);
+    if (running) pthread_join(compactorThread, NULL);
+}
+
+// Background checkpoint thread
+pthread_t checkpointThread;
+int checkpointRunning = 0;
+int checkpointInterval = 0;
+pthread_mutex_t checkpointThreadLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t checkpointStop = PTHREAD_COND_INITIALIZER;
+
+void *checkpointMain(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&checkpointThreadLock);
+    while (checkpointRunning) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += checkpointInterval;
+        pthread_cond_timedwait(&checkpointStop, &checkpointThreadLock, &deadline);
+        if (!checkpointRunning) break;
+        pthread_mutex_unlock(&checkpointThreadLock);
+        bankCheckpoint();
+        pthread_mutex_lock(&checkpointThreadLock);
+    }
+    pthread_mutex_unlock(&checkpointThreadLock);
+    return NULL;
+}
+
+void stopCheckpoints() {
+    pthread_mutex_lock(&checkpointThreadLock);
+    int running = checkpointRunning;
+    checkpointRunning = 0;
+    pthread_cond_signal(&checkpointStop);
+    pthread_mutex_unlock(&checkpointThreadLock);
+    if (running) pthread_join(checkpointThread, NULL);
+}
+
+// Deposit money - adds money to balance
+void depositMoney(Account *user) {
+    int slot = findLiveAccountSlot(user->account_number);
+    if (slot < 0) return;
+    store.balances[slot] = user->balance;
+    journalBalance(user->account_number, user->balance);
+}
+
+// Withdraw money - subtracts money from balance
+void withdrawMoney(Account *user) {
+    int slot = findLiveAccountSlot(user->account_number);
+    if (slot < 0) return;
+    store.balances[slot] = user->balance;
+    journalBalance(user->account_number, user->balance);
+}
+
+// Velocity state - one table per account lock stripe, each touched only under its stripe's lock,
+// so checking the rules adds no locking to a posting
+typedef struct {
+    int account_number;   // 0 = empty slot
+    VelocityState *state;
+} VelocitySlot;
+
+typedef struct {
+    VelocitySlot *slots;
+    int size;             // power of two
+    int used;
+} VelocityTable;
+
+VelocityTable velocityTables[ACCOUNT_LOCK_STRIPES];
+VelocityRule velocityRules[VELOCITY_MAX_RULES];
+int velocityRuleCount = -1;   // -1 = the defaults are not parsed yet
+
+// Fill a new state from the account's ledger entries of the last week
+void velocityLoadHistory(VelocityState *state, int account_number, long long now) {
+    pthread_mutex_lock(&ledgerLock);
+    LedgerIndexEntry *entry = ledgerFindEntry(account_number, 0);
+    int first = entry ? entry->count : 0;
+    LedgerRecord rec;
+    while (first > 0 && ledgerRead(entry->positions[first - 1], &rec) && rec.timestamp > now - 7 * 24 * 3600) first--;
+    for (int k = first; entry && k < entry->count; k++) {
+        if (!ledgerRead(entry->positions[k], &rec)) continue;
+        if (rec.type == LEDGER_DEPOSIT || rec.type == LEDGER_WITHDRAW) velocityRecord(state, rec.type, rec.timestamp, rec.amount);
+    }
+    pthread_mutex_unlock(&ledgerLock);
+}
+
+// The account's velocity state, created from its ledger history on first use (caller holds the
+// account lock). Slots hash on the bits above the stripe number, which all keys here share.
+VelocityState *velocityStateFor(int account_number, long long now) {
+    unsigned int hash = hashAccountNumber(account_number);
+    VelocityTable *table = &velocityTables[hash & (ACCOUNT_LOCK_STRIPES - 1)];
+    if (table->size == 0 || table->used * 2 >= table->size) {
+        int oldSize = table->size;
+        VelocitySlot *old = table->slots;
+        table->size = oldSize > 0 ? oldSize * 2 : 16;
+        table->slots = (VelocitySlot *)calloc(table->size, sizeof(VelocitySlot));
+        for (int i = 0; i < oldSize; i++) {
+            if (old[i].account_number == 0) continue;
+            unsigned int slot = (hashAccountNumber(old[i].account_number) >> 8) & (unsigned int)(table->size - 1);
+            while (table->slots[slot].account_number != 0) slot = (slot + 1) & (unsigned int)(table->size - 1);
+            table->slots[slot] = old[i];
+        }
+        free(old);
+    }
+    unsigned int mask = (unsigned int)table->size - 1;
+    unsigned int slot = (hash >> 8) & mask;
+    while (table->slots[slot].account_number != 0) {
+        if (table->slots[slot].account_number == account_number) return table->slots[slot].state;
+        slot = (slot + 1) & mask;
+    }
+    VelocityState *state = (VelocityState *)malloc(sizeof(VelocityState));
+    velocityReset(state);
+    velocityLoadHistory(state, account_number, now);
+    table->slots[slot].account_number = account_number;
+    table->slots[slot].state = state;
+    table->used++;
+    return state;
+}
+
+void releaseVelocityTables(void) {
+    for (int t = 0; t < ACCOUNT_LOCK_STRIPES; t++) {
+        for (int i = 0; i < velocityTables[t].size; i++) free(velocityTables[t].slots[i].state);
+        free(velocityTables[t].slots);
+    }
+    memset(velocityTables, 0, sizeof(velocityTables));
+}
+
+int bankSetVelocityRules(const char *text) {
+    VelocityRule rules[VELOCITY_MAX_RULES];
+    int count = velocityParseRules(text, rules, VELOCITY_MAX_RULES);
+    if (count < 0) return count;
+    memcpy(velocityRules, rules, count * sizeof(VelocityRule));
+    velocityRuleCount = count;
+    return count;
+}
+
+// Interest - the class of each account is kept in ACCOUNT_CLASS_FILE as "C,<account>,<class>"
+// lines, the last one for an account winning. It is keyed by account number, so moving slots
+// and rebuilding accounts.col leave it alone; lines of purged accounts are skipped.
+const char *ACCOUNT_CLASS_FILE = "accounts.cls";
+// A run is committed by INTEREST_RUN_FILE: the new balances are written and fsynced there
+// before the ledger and the account files change, and the file is removed once they are synced.
+// Left behind by a crash, it is finished at the next startup.
+const char *INTEREST_RUN_FILE = "interest.run";
+#define INTEREST_RUN_MAGIC 0x494B4E42u  // "BNKI"
+#define INTEREST_CHUNK 4096
+
+typedef struct {
+    unsigned int magic;
+    int count;
+    long long startPosition;      // ledger position of the run's first entry
+    long long timestamp;
+    unsigned long long checksum;  // of the entries
+} InterestRunHeader;
+
+typedef struct {
+    int account_number;
+    int slot;
+    Money amount;
+    Money balance;
+} InterestEntry;
+
+FILE *classFile = NULL;
+InterestRates interestRates;
+int interestRatesLoaded = 0;
+
+// Read the class file - called once at startup, after the indexes are built
+void loadAccountClasses() {
+    FILE *file = fopen(ACCOUNT_CLASS_FILE, "r");
+    if (file) {
+        char line[64];
+        int account_number, accountClass;
+        while (fgets(line, sizeof(line), file)) {
+            if (sscanf(line, "C,%d,%d", &account_number, &accountClass) != 2) continue;
+            int slot = findAccountSlot(account_number);
+            if (slot >= 0 && accountClass >= 0 && accountClass < INTEREST_MAX_CLASSES) store.classes[slot] = (unsigned char)accountClass;
+        }
+        fclose(file);
+    }
+    classFile = fopen(ACCOUNT_CLASS_FILE, "a");
+}
+
+// Ledger entries, balances and account files of a run from its entries. Entries before
+// header->startPosition + the ledger records already there are not appended again, so this
+// also finishes a run that was cut short. Returns 1 once everything is synced.
+int commitInterestRun(const InterestRunHeader *header, const InterestEntry *entries) {
+    long long present = ledger.nextPosition - header->startPosition;
+    int done = present < 0 ? 0 : present > header->count ? header->count : (int)present;
+    LedgerRecord *records = (LedgerRecord *)malloc(INTEREST_CHUNK * sizeof(LedgerRecord));
+    int ok = 1;
+    for (int i = done; i < header->count && ok; i += INTEREST_CHUNK) {
+        int chunk = header->count - i < INTEREST_CHUNK ? header->count - i : INTEREST_CHUNK;
+        for (int k = 0; k < chunk; k++) {
+            records[k].timestamp = header->timestamp;
+            records[k].account_number = entries[i + k].account_number;
+            records[k].type = LEDGER_INTEREST;
+            records[k].amount = entries[i + k].amount;
+            records[k].balance = entries[i + k].balance;
+        }
+        ok = ledgerAppendRecords(records, chunk) == chunk;
+    }
+    free(records);
+    pthread_mutex_lock(&ledgerLock);
+    if (ledger.appendFile && !syncFile(ledger.appendFile)) ok = 0;
+    pthread_mutex_unlock(&ledgerLock);
+    if (!ok) return 0;
+
+    int *slots = (int *)malloc((header->count > 0 ? header->count : 1) * sizeof(int));
+    int n = 0;
+    for (int i = 0; i < header->count; i++) {
+        int slot = entries[i].slot;
+        if (slot < 0 || slot >= store.count || store.numbers[slot] != entries[i].account_number) slot = findAccountSlot(entries[i].account_number);
+        if (slot >= 0) {
+            store.balances[slot] = entries[i].balance;
+            slots[n++] = slot;
+        }
+    }
+    // Only balances change: the column file is rewritten front to back, the records keep their profiles
+    writeAccountBalances(slots, n);
+    free(slots);
+    pthread_mutex_lock(&datLock);
+    ok = syncFile(datFile) && (!columnFile || syncFile(columnFile));
+    pthread_mutex_unlock(&datLock);
+    if (ok) remove(INTEREST_RUN_FILE);
+    return ok;
+}
+
+// Finish a run left behind by a crash - called once at startup, after the ledger is indexed.
+// A run file that is incomplete was never committed, and nothing else had changed yet.
+void recoverInterestRun() {
+    FILE *file = fopen(INTEREST_RUN_FILE, "rb");
+    if (!file) return;
+    InterestRunHeader header;
+    InterestEntry *entries = NULL;
+    int valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == INTEREST_RUN_MAGIC && header.count >= 0;
+    if (valid) {
+        entries = (InterestEntry *)malloc((header.count > 0 ? header.count : 1) * sizeof(InterestEntry));
+        valid = fread(entries, sizeof(InterestEntry), header.count, file) == (size_t)header.count &&
+                checkpointChecksum(14695981039346656037ULL, entries, header.count * sizeof(InterestEntry)) == header.checksum;
+    }
+    fclose(file);
+    if (valid) commitInterestRun(&header, entries);
+    else remove(INTEREST_RUN_FILE);
+    free(entries);
+}
+
+// Data written while balances and amounts were floats (in rupees): 240-byte account records,
+// 24-byte ledger records and interest run entries. upgradeMoneyFormat() converts it once.
+typedef struct {
+    char name[50];
+    char father_name[50];
+    char mobile_number[12];
+    char address[100];
+    char password[20];
+    int account_number;
+    float balance;
+} FloatAccount;
+
+typedef struct {
+    long long timestamp;
+    int account_number;
+    int type;
+    float amount;
+    float balance;
+} FloatLedgerRecord;
+
+typedef struct {
+    int account_number;
+    int slot;
+    float amount;
+    float balance;
+} FloatInterestEntry;
+
+// Next segment to convert while an upgrade is in progress
+const char *MONEY_UPGRADE_FILE = "money.upgrade";
+
+// Rewrite a float interest run file with Money entries; a file already converted is left alone
+int upgradeInterestRun() {
+    FILE *file = fopen(INTEREST_RUN_FILE, "rb");
+    if (!file) return 1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    InterestRunHeader header;
+    int legacy = fread(&header, sizeof(header), 1, file) == 1 && header.magic == INTEREST_RUN_MAGIC && header.count > 0 &&
+                 size == (long)(sizeof(header) + header.count * sizeof(FloatInterestEntry));
+    if (!legacy) {
+        fclose(file);
+        return 1;
+    }
+    FloatInterestEntry *old = (FloatInterestEntry *)malloc(header.count * sizeof(FloatInterestEntry));
+    InterestEntry *entries = (InterestEntry *)malloc(header.count * sizeof(InterestEntry));
+    int ok = fread(old, sizeof(FloatInterestEntry), header.count, file) == (size_t)header.count;
+    fclose(file);
+    for (int i = 0; ok && i < header.count; i++) {
+        entries[i].account_number = old[i].account_number;
+        entries[i].slot = old[i].slot;
+        entries[i].amount = moneyFromDouble(old[i].amount);
+        entries[i].balance = moneyFromDouble(old[i].balance);
+    }
+    header.checksum = checkpointChecksum(14695981039346656037ULL, entries, header.count * sizeof(InterestEntry));
+    FILE *out = ok ? fopen("interest.run.tmp", "wb") : NULL;
+    ok = out && fwrite(&header, sizeof(header), 1, out) == 1 &&
+         fwrite(entries, sizeof(InterestEntry), header.count, out) == (size_t)header.count && syncFile(out);
+    if (out && fclose(out) != 0) ok = 0;
+#ifdef _WIN32
+    if (ok) remove(INTEREST_RUN_FILE);
+#endif
+    ok = ok && rename("interest.run.tmp", INTEREST_RUN_FILE) == 0;
+    free(old);
+    free(entries);
+    return ok;
+}
+
+// One-time upgrade of data with float balances (recordSize 240 in the accounts.dat header) -
+// called by bankOpen() before anything is loaded. Float amounts round to the nearest paisa.
+// Plain ledger segments are converted one at a time: the old segment is first renamed to
+// ledger_NNNN.f32, which marks it as being converted, and removed once MONEY_UPGRADE_FILE has
+// moved past it. Archived segments already hold cents. accounts.dat is replaced last, so an
+// upgrade cut short is picked up again by the next bankOpen(). Returns 1 on success.
+int upgradeMoneyFormat() {
+    AccountFileHeader header;
+    FILE *file = fopen(ACCOUNT_DAT_FILE, "rb");
+    int legacy = file && fread(&header, sizeof(header), 1, file) == 1 && header.magic == ACCOUNT_DAT_MAGIC &&
+                 header.recordSize == sizeof(FloatAccount);
+    if (!legacy) {
+        if (file) fclose(file);
+        remove(MONEY_UPGRADE_FILE);  // left behind if the last upgrade stopped right after replacing accounts.dat
+        return 1;
+    }
+
+    int segment = 0;
+    FILE *progress = fopen(MONEY_UPGRADE_FILE, "r");
+    if (progress) {
+        if (fscanf(progress, "%d", &segment) != 1) segment = 0;
+        fclose(progress);
+    }
+    if (segment > 0) {
+        char original[32];
+        sprintf(original, "ledger_%04d.f32", segment - 1);
+        remove(original);  // converted, but the upgrade stopped before removing it
+    }
+    FloatLedgerRecord *old = (FloatLedgerRecord *)malloc(LEDGER_SEGMENT_RECORDS * sizeof(FloatLedgerRecord));
+    LedgerRecord *records = (LedgerRecord *)malloc(LEDGER_SEGMENT_RECORDS * sizeof(LedgerRecord));
+    int ok = 1;
+    for (; ok; segment++) {
+        char filename[32];
+        char original[32];
+        char tmpname[40];
+        ledgerSegmentName(segment, filename);
+        sprintf(original, "ledger_%04d.f32", segment);
+        FILE *in = fopen(original, "rb");
+        if (!in && rename(filename, original) == 0) in = fopen(original, "rb");
+        if (!in) {
+            ledgerArchiveName(segment, filename);
+            FILE *archive = fopen(filename, "rb");
+            if (!archive) break;
+            fclose(archive);
+            continue;
+        }
+        int n = (int)fread(old, sizeof(FloatLedgerRecord), LEDGER_SEGMENT_RECORDS, in);
+        fclose(in);
+        for (int i = 0; i < n; i++) {
+            records[i].timestamp = old[i].timestamp;
+            records[i].account_number = old[i].account_number;
+            records[i].type = old[i].type;
+            records[i].amount = moneyFromDouble(old[i].amount);
+            records[i].balance = moneyFromDouble(old[i].balance);
+        }
+        sprintf(tmpname, "ledger_%04d.tmp", segment);
+        ok = ledgerWriteSegment(tmpname, records, n, 0) && ledgerReplaceSegment(segment, tmpname, 0);
+        progress = ok ? fopen(MONEY_UPGRADE_FILE, "w") : NULL;
+        ok = progress && fprintf(progress, "%d\n", segment + 1) > 0 && syncFile(progress);
+        if (progress && fclose(progress) != 0) ok = 0;
+        if (ok) remove(original);
+    }
+    free(old);
+    free(records);
+
+    FloatAccount *accounts = (FloatAccount *)malloc((header.count > 0 ? header.count : 1) * sizeof(FloatAccount));
+    ok = ok && fread(accounts, sizeof(FloatAccount), header.count, file) == (size_t)header.count;
+    fclose(file);
+    ok = ok && upgradeInterestRun();
+    FILE *out = ok ? fopen("accounts.dat.tmp", "wb") : NULL;
+    if (out) {
+        // The version stays: an upgrade of version 1 data still has upgradeDeletedNumbers() to run
+        header.recordSize = sizeof(Account);
+        ok = fwrite(&header, sizeof(header), 1, out) == 1;
+        for (unsigned int i = 0; ok && i < header.count; i++) {
+            Account acc;
+            memset(&acc, 0, sizeof(acc));
+            memcpy(&acc, &accounts[i], offsetof(FloatAccount, balance));
+            acc.balance = moneyFromDouble(accounts[i].balance);
+            ok = fwrite(&acc, sizeof(acc), 1, out) == 1;
+        }
+        ok = ok && syncFile(out);
+        if (fclose(out) != 0) ok = 0;
+    }
+    free(accounts);
+#ifdef _WIN32
+    if (ok) remove(ACCOUNT_DAT_FILE);
+#endif
+    ok = ok && rename("accounts.dat.tmp", ACCOUNT_DAT_FILE) == 0;
+    if (ok) remove(MONEY_UPGRADE_FILE);
+    return ok;
+}
+
+// Public API - the operations the raylib client and the headless tools call
+
+int bankOpen(void) {
+    pthread_once(&accountLocksOnce, initAccountLocks);
+    if (velocityRuleCount < 0) bankSetVelocityRules(velocityDefaultRules);
+    if (!interestRatesLoaded) bankSetInterestRates(interestDefaultRates);
+    if (!upgradeMoneyFormat()) return 0;
+    loadAccounts();
+    long long covered = loadCheckpoint();
+    if (covered < 0) rebuildIndexes();
+    loadAccountClasses();
+    openSequence();
+    replayJournal();
+    openLedger(covered);
+    recoverInterestRun();
+    if (datVersionLoaded < ACCOUNT_DAT_VERSION && datFile) upgradeDeletedNumbers();
+    applyTombstones();
+    return datFile != NULL;
+}
+
+// Not thread-safe - stop every caller before closing
+void bankClose(void) {
+    stopCompactor();
+    stopCheckpoints();
+    stopMetricsFile();
+    compactJournal();
+    if (datFile) bankCheckpoint();  // the next bankOpen() then has no ledger records to scan
+    if (journalFile) fclose(journalFile);
+    if (datFile) fclose(datFile);
+    if (columnFile) fclose(columnFile);
+    if (classFile) fclose(classFile);
+    if (ledger.appendFile) fclose(ledger.appendFile);
+    ledgerReaderClose(&ledger.reader);
+    if (sequence.file) {
+        reserveAccountNumbers(sequence.next);  // hand the unused rest of the block back
+        fclose(sequence.file);
+    }
+    journalFile = NULL;
+    sequence.file = NULL;
+    free(journalRecovered);
+    journalRecovered = NULL;
+    journalRecoveredCount = journalRecoveredCapacity = 0;
+    datFile = NULL;
+    columnFile = NULL;
+    classFile = NULL;
+    journalRecords = 0;
+    datVersionLoaded = ACCOUNT_DAT_VERSION;
+    groupCommit.queuedSeq = groupCommit.durableSeq = 0;
+    groupCommit.failedFrom = groupCommit.failedTo = 0;
+    groupCommit.rounds = 0;
+
+    // Drop the in-memory state so bankOpen() can be called again (e.g. on another data directory)
+    releaseAccountTable();
+    free(store.numbers);
+    free(store.balances);
+    free(store.classes);
+    free(store.deletedAt);
+    free(store.numberIndex);
+    free(store.mobileIndex);
+    free(store.mobileBloom);
+    memset(&store, 0, sizeof(store));
+    store.nextAccountNumber = 2500;
+    for (int i = 0; i < ledger.size; i++) {
+        free(ledger.entries[i].positions);
+    }
+    free(ledger.entries);
+    memset(&ledger, 0, sizeof(ledger));
+    ledger.reader.segment = -1;
+    releaseVelocityTables();
+}
+
+BankStatus bankCreateAccount(Account *acc) {
+    if (strlen(acc->name) == 0 || strlen(acc->father_name) == 0 || strlen(acc->mobile_number) != 11 || strlen(acc->address) == 0 || strlen(acc->password) == 0) {
+        return BANK_ERR_INVALID;
+    }
+    long long start = metricNow();
+    BankStatus status = BANK_OK;
+    pthread_rwlock_wrlock(&storeLock);
+    if (findAccountByMobile(acc->mobile_number)) {
+        status = BANK_ERR_DUPLICATE_MOBILE;
+    } else {
+        acc->account_number = generateAccountNumber();
+        acc->balance = 0;
+        if (acc->account_number == 0 || !saveNewAccount(acc)) status = BANK_ERR_IO;
+        else logTransaction(acc->account_number, LEDGER_OPEN, 0, 0);  // dates the account for statements
+    }
+    pthread_rwlock_unlock(&storeLock);
+    if (status == BANK_OK) metricCount(METRIC_ACCOUNTS_CREATED);
+    metricLatency(LATENCY_CREATE, start);
+    return status;
+}
+
+BankStatus bankLogin(const char *mobile, const char *password, Account *out) {
+    long long start = metricNow();
+    BankStatus status = BANK_ERR_AUTH;
+    pthread_rwlock_rdlock(&storeLock);
+    Account *acc = findAccountByMobile(mobile);
+    if (acc) {
+        pthread_mutex_t *lock = accountLock(acc->account_number);
+        pthread_mutex_lock(lock);
+        if (strcmp(acc->password, password) == 0) {
+            copyAccount((int)(acc - store.accounts), out);
+            status = BANK_OK;
+        }
+        pthread_mutex_unlock(lock);
+    }
+    pthread_rwlock_unlock(&storeLock);
+    metricCount(status == BANK_OK ? METRIC_LOGIN_OK : METRIC_LOGIN_FAILED);
+    metricLatency(LATENCY_LOGIN, start);
+    return status;
+}
+
+BankStatus bankGetAccount(int account_number, Account *out) {
+    BankStatus status = BANK_ERR_NOT_FOUND;
+    pthread_rwlock_rdlock(&storeLock);
+    int slot = findLiveAccountSlot(account_number);
+    if (slot >= 0) {
+        pthread_mutex_t *lock = accountLock(account_number);
+        pthread_mutex_lock(lock);
+        copyAccount(slot, out);
+        pthread_mutex_unlock(lock);
+        status = BANK_OK;
+    }
+    pthread_rwlock_unlock(&storeLock);
+    return status;
+}
+
+int bankAccountCount(void) {
+    pthread_rwlock_rdlock(&storeLock);
+    int count = store.count - store.deletedCount;
+    pthread_rwlock_unlock(&storeLock);
+    return count;
+}
+
+Money bankTotalBalance(void) {
+    pthread_rwlock_rdlock(&storeLock);
+    Money total = 0;
+    for (int i = 0; i < store.count; i++) total += store.balances[i];
+    // Deleted accounts are few, so they are taken out afterwards instead of tested in the loop
+    if (store.deletedCount > 0) {
+        for (int i = 0; i < store.count; i++) {
+            if (store.deletedAt[i] != 0) total -= store.balances[i];
+        }
+    }
+    pthread_rwlock_unlock(&storeLock);
+    return total;
+}
+
+const char *securityQuestions[BANK_SECURITY_QUESTIONS] = {
+    "What is your father's name?",
+    "What is your registered mobile number?",
+    "What is your address?"
+};
+
+const char *bankSecurityQuestion(int question) {
+    return question >= 0 && question < BANK_SECURITY_QUESTIONS ? securityQuestions[question] : "Security question:";
+}
+
+// Does answer match the profile field question asks about? Called with the account lock held.
+int securityAnswerMatches(int slot, int question, const char *answer) {
+    const Account *acc = &store.accounts[slot];
+    const char *expected = question == 0 ? acc->father_name : question == 1 ? acc->mobile_number : question == 2 ? acc->address : NULL;
+    return expected && expected[0] != '\0' && strcmp(expected, answer) == 0;
+}
+
+// Shared body of deposit and withdraw - sign is +1 or -1. verified is set when the bank has
+// verified the customer itself; answer (or NULL) is the customer's answer to the security
+// question, checked against the profile. Either lets through a posting the rules sent to
+// verification; a wrong answer fails the posting with BANK_ERR_AUTH.
+BankStatus postTransaction(int account_number, Money amount, int sign, int verified, int question, const char *answer, Account *out) {
+    if (amount <= 0) return BANK_ERR_AMOUNT;
+    long long start = metricNow();
+    BankStatus status = BANK_OK;
+    long long seq = 0;
+    pthread_rwlock_rdlock(&storeLock);
+    int slot = findLiveAccountSlot(account_number);
+    if (slot < 0) {
+        pthread_rwlock_unlock(&storeLock);
+        return BANK_ERR_NOT_FOUND;
+    }
+    pthread_mutex_t *lock = accountLock(account_number);
+    pthread_mutex_lock(lock);
+    long long now = (long long)time(NULL);
+    int type = sign > 0 ? LEDGER_DEPOSIT : LEDGER_WITHDRAW;
+    VelocityState *velocity = NULL;
+    if (answer && !securityAnswerMatches(slot, question, answer)) {
+        status = BANK_ERR_AUTH;
+    } else if (sign < 0 ? amount > store.balances[slot] : amount > MONEY_MAX - store.balances[slot]) {
+        status = BANK_ERR_AMOUNT;
+    } else {
+        velocity = velocityStateFor(account_number, now);
+        VelocityAction action = velocityCheck(velocity, velocityRules, velocityRuleCount, type, now, amount);
+        if (action == VELOCITY_BLOCK) status = BANK_ERR_BLOCKED;
+        if (action == VELOCITY_VERIFY && !verified && !answer) status = BANK_ERR_VERIFY;
+    }
+    if (status == BANK_OK) {
+        // Only the balance column is touched - the profile record is read just to fill out
+        Account user;
+        user.account_number = account_number;
+        user.balance = store.balances[slot];
+        if (sign > 0) {
+            user.balance += amount;
+            depositMoney(&user);
+            logTransaction(account_number, LEDGER_DEPOSIT, amount, user.balance);
+        } else {
+            user.balance -= amount;
+            withdrawMoney(&user);
+            logTransaction(account_number, LEDGER_WITHDRAW, amount, user.balance);
+        }
+        velocityRecord(velocity, type, now, amount);
+        if (groupCommit.enabled) seq = queuePosting();
+        if (out) copyAccount(slot, out);
+    }
+    pthread_mutex_unlock(lock);
+    pthread_rwlock_unlock(&storeLock);
+    // Wait for durability outside the locks, so other postings can join the same sync round
+    if (seq > 0 && !waitForCommit(seq)) status = BANK_ERR_IO;
+    if (status == BANK_OK) metricCount(sign > 0 ? METRIC_DEPOSITS : METRIC_WITHDRAWALS);
+    if (status == BANK_ERR_BLOCKED) metricCount(METRIC_VELOCITY_BLOCKED);
+    if (status == BANK_ERR_AUTH) bankRecordWithdrawVerify(1);
+    metricLatency(sign > 0 ? LATENCY_DEPOSIT : LATENCY_WITHDRAW, start);
+    return status;
+}
+
+BankStatus bankDeposit(int account_number, Money amount, Account *out) {
+    return postTransaction(account_number, amount, 1, 0, -1, NULL, out);
+}
+
+BankStatus bankWithdraw(int account_number, Money amount, Account *out) {
+    return postTransaction(account_number, amount, -1, 0, -1, NULL, out);
+}
+
+BankStatus bankDepositAnswered(int account_number, Money amount, int question, const char *answer, Account *out) {
+    return postTransaction(account_number, amount, 1, 0, question, answer, out);
+}
+
+BankStatus bankWithdrawAnswered(int account_number, Money amount, int question, const char *answer, Account *out) {
+    return postTransaction(account_number, amount, -1, 0, question, answer, out);
+}
+
+BankStatus bankDepositVerified(int account_number, Money amount, Account *out) {
+    return postTransaction(account_number, amount, 1, 1, -1, NULL, out);
+}
+
+BankStatus bankWithdrawVerified(int account_number, Money amount, Account *out) {
+    return postTransaction(account_number, amount, -1, 1, -1, NULL, out);
+}
+
+BankStatus bankUpdateAccount(const Account *user) {
+    if (strlen(user->name) == 0 || strlen(user->father_name) == 0 || strlen(user->address) == 0 || strlen(user->password) == 0) {
+        return BANK_ERR_INVALID;
+    }
+    pthread_rwlock_rdlock(&storeLock);
+    Account *acc = findAccountByNumber(user->account_number);
+    if (!acc) {
+        pthread_rwlock_unlock(&storeLock);
+        return BANK_ERR_NOT_FOUND;
+    }
+    long long start = metricNow();
+    pthread_mutex_t *lock = accountLock(user->account_number);
+    pthread_mutex_lock(lock);
+    // Mobile number, account number and balance are not changed by an update
+    Account updated;
+    copyAccount((int)(acc - store.accounts), &updated);
+    strcpy(updated.name, user->name);
+    strcpy(updated.father_name, user->father_name);
+    strcpy(updated.address, user->address);
+    strcpy(updated.password, user->password);
+    updateInformation(&updated);
+    pthread_mutex_unlock(lock);
+    pthread_rwlock_unlock(&storeLock);
+    metricLatency(LATENCY_UPDATE, start);
+    return BANK_OK;
+}
+
+BankStatus bankUndeleteAccount(int account_number, Account *out) {
+    BankStatus status = BANK_ERR_NOT_FOUND;
+    pthread_rwlock_wrlock(&storeLock);
+    int slot = findAccountSlot(account_number);
+    long long now = (long long)time(NULL);
+    if (slot >= 0 && store.deletedAt[slot] != 0 && now < store.deletedAt[slot] + deleteRetention) {
+        if (findAccountByMobile(store.accounts[slot].mobile_number)) {
+            status = BANK_ERR_DUPLICATE_MOBILE;  // the number was registered again meanwhile
+        } else {
+            store.deletedAt[slot] = 0;
+            store.deletedCount--;
+            logTransactionAt(now, account_number, LEDGER_REOPEN, 0, store.balances[slot]);
+            if (out) copyAccount(slot, out);
+            status = BANK_OK;
+        }
+    }
+    pthread_rwlock_unlock(&storeLock);
+    return status;
+}
+
+void bankSetDeleteRetention(long long seconds) {
+    pthread_rwlock_wrlock(&storeLock);
+    deleteRetention = seconds;
+    pthread_rwlock_unlock(&storeLock);
+}
+
+void bankSetArchiveAge(long long seconds) {
+    pthread_mutex_lock(&checkpointLock);
+    archiveAge = seconds;
+    pthread_mutex_unlock(&checkpointLock);
+}
+
+// Whether compaction would move account slots or rewrite a sealed ledger segment, which the
+// checkpoint does not survive (caller holds storeLock)
+int compactionMovesData(long long cutoff) {
+    for (int i = 0; i < store.count; i++) {
+        if (store.deletedAt[i] != 0 && store.deletedAt[i] <= cutoff) return 1;
+    }
+    int moves = 0;
+    pthread_mutex_lock(&ledgerLock);
+    long long sealedEnd = ledger.nextPosition / LEDGER_SEGMENT_RECORDS * LEDGER_SEGMENT_RECORDS;
+    for (int i = 0; i < ledger.size && !moves; i++) {
+        const LedgerIndexEntry *entry = &ledger.entries[i];
+        moves = entry->account_number != 0 && entry->closedAt != 0 && entry->closedAt <= cutoff &&
+                entry->count > 0 && entry->positions[0] < sealedEnd;
+    }
+    pthread_mutex_unlock(&ledgerLock);
+    return moves;
+}
+
+int bankCompact(void) {
+    pthread_mutex_lock(&checkpointLock);
+    pthread_rwlock_wrlock(&storeLock);
+    long long cutoff = (long long)time(NULL) - deleteRetention;
+    if (compactionMovesData(cutoff)) discardCheckpoints();
+    int purged = purgeDeletedAccounts(cutoff);
+    pthread_rwlock_unlock(&storeLock);
+    // Past the cutoff nothing can be undeleted, so the ledger is rewritten without the store lock
+    ledgerPurgeClosed(cutoff);
+    if (archiveAge >= 0) ledgerArchiveSegments((long long)time(NULL) - archiveAge);
+    pthread_mutex_unlock(&checkpointLock);
+    return purged;
+}
+
+void bankStartCompactor(int intervalSeconds) {
+    pthread_mutex_lock(&compactorLock);
+    if (!compactorRunning) {
+        compactorRunning = 1;
+        compactorInterval = intervalSeconds > 0 ? intervalSeconds : 1;
+        pthread_create(&compactorThread, NULL, compactorMain, NULL);
+    }
+    pthread_mutex_unlock(&compactorLock);
+}
+
+int bankCheckpoint(void) {
+    pthread_mutex_lock(&checkpointLock);
+    pthread_mutex_lock(&ledgerLock);
+    if (ledger.checkpointBase != 0 && ledger.nextPosition == ledger.checkpointCovered) {
+        // Nothing was posted since the last checkpoint (compaction discards them when it changes the index)
+        pthread_mutex_unlock(&ledgerLock);
+        pthread_mutex_unlock(&checkpointLock);
+        return 1;
+    }
+    int full = ledger.checkpointBase == 0 || ledger.checkpointDeltaBytes * 2 > ledger.checkpointBaseBytes;
+    if (full) {
+        // A base copies the account indexes too, so account creation waits for it
+        pthread_mutex_unlock(&ledgerLock);
+        pthread_rwlock_rdlock(&storeLock);
+        pthread_mutex_lock(&ledgerLock);
+    }
+    long long covered = ledger.nextPosition;
+    // Records named by a checkpoint must be on disk before it is
+    int ok = !ledger.appendFile || syncFile(ledger.appendFile);
+    long long baseId = full ? ((long long)time(NULL) << 24) ^ ledger.nextPosition ^ 1 : ledger.checkpointBase;
+    FILE *file = ok ? fopen(full ? CHECKPOINT_TMP_FILE : CHECKPOINT_DELTA_FILE, full ? "wb" : "ab") : NULL;
+    // Entries are marked saved as they are written, so until this block is known to be on disk
+    // the next checkpoint has to be a base
+    ledger.checkpointBase = 0;
+    long long bytes = file ? writeCheckpointBlock(file, full, baseId) : -1;
+    pthread_mutex_unlock(&ledgerLock);
+    if (full) pthread_rwlock_unlock(&storeLock);
+
+    ok = bytes >= 0 && syncFile(file);
+    if (file && fclose(file) != 0) ok = 0;
+    if (full) {
+#ifdef _WIN32
+        if (ok) remove(CHECKPOINT_FILE);  // rename does not replace an existing file on Windows
+#endif
+        ok = ok && rename(CHECKPOINT_TMP_FILE, CHECKPOINT_FILE) == 0;
+        if (ok) remove(CHECKPOINT_DELTA_FILE);
+        else remove(CHECKPOINT_TMP_FILE);
+    }
+    pthread_mutex_lock(&ledgerLock);
+    if (ok) {
+        ledger.checkpointBase = baseId;
+        ledger.checkpointCovered = covered;
+        if (full) {
+            ledger.checkpointBaseBytes = bytes;
+            ledger.checkpointDeltaBytes = 0;
+        } else {
+            ledger.checkpointDeltaBytes += bytes;
+        }
+    }
+    pthread_mutex_unlock(&ledgerLock);
+    pthread_mutex_unlock(&checkpointLock);
+    return ok;
+}
+
+void bankStartCheckpoints(int intervalSeconds) {
+    pthread_mutex_lock(&checkpointThreadLock);
+    if (!checkpointRunning) {
+        checkpointRunning = 1;
+        checkpointInterval = intervalSeconds > 0 ? intervalSeconds : 1;
+        pthread_create(&checkpointThread, NULL, checkpointMain, NULL);
+    }
+    pthread_mutex_unlock(&checkpointThreadLock);
+}
+
+BankStatus bankDeleteAccount(int account_number) {
+    long long start = metricNow();
+    BankStatus status = BANK_ERR_NOT_FOUND;
+    pthread_rwlock_wrlock(&storeLock);
+    Account *acc = findAccountByNumber(account_number);
+    if (acc) {
+        Account user = *acc;
+        deleteAccount(&user);
+        status = BANK_OK;
+    }
+    pthread_rwlock_unlock(&storeLock);
+    if (status == BANK_OK) metricCount(METRIC_ACCOUNTS_DELETED);
+    metricLatency(LATENCY_DELETE, start);
+    return status;
+}
+
+void bankSetGroupCommit(int latencyMicros, int maxBatch) {
+    pthread_mutex_lock(&groupCommit.lock);
+    groupCommit.enabled = latencyMicros >= 0;
+    groupCommit.latencyMicros = latencyMicros;
+    groupCommit.maxBatch = maxBatch > 0 ? maxBatch : 1 << 30;
+    pthread_mutex_unlock(&groupCommit.lock);
+    if (!groupCommit.enabled) syncPostings();  // leave nothing sitting in the stdio buffers
+}
+
+long long bankCommitRounds(void) {
+    pthread_mutex_lock(&groupCommit.lock);
+    long long rounds = groupCommit.rounds;
+    pthread_mutex_unlock(&groupCommit.lock);
+    return rounds;
+}
+
+// Month-end statements - accounts are handed out in chunks to worker threads, each reading the
+// segments through its own LedgerReader, so workers share ledgerLock only while copying an
+// account's positions
+#define STATEMENT_CHUNK 256
+#define STATEMENT_MAX_WORKERS 64
+#define STATEMENT_CHECKPOINT "statements.ckpt"
+
+typedef struct {
+    long long from;
+    long long to;
+    long long end;            // every record before this ledger position is in the segment files
+    char dir[256];
+    int *accounts;            // account numbers still to do, ascending
+    int count;
+    int next;                 // first account not handed out yet
+    int written;
+    int failed;
+    FILE *checkpoint;         // account numbers whose statement is complete, one per line
+    pthread_mutex_t lock;
+} StatementRun;
+
+int compareAccountNumbers(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+int processorCount() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+// A close record carries no balance (the account keeps the one it had)
+int ledgerCarriesBalance(const LedgerRecord *rec) {
+    return rec->type != LEDGER_CLOSE;
+}
+
+// Write one account's statement file; returns 1 on success, 2 when the account was opened
+// after the period and gets no file, 0 on failure
+int writeStatement(StatementRun *run, LedgerReader *reader, int account_number, long long **positions, int *capacity) {
+    // Copy the account's positions, leaving out records appended since the run started
+    pthread_mutex_lock(&ledgerLock);
+    LedgerIndexEntry *entry = ledgerFindEntry(account_number, 0);
+    int count = entry ? entry->count : 0;
+    while (count > 0 && entry->positions[count - 1] >= run->end) count--;
+    if (count > *capacity) {
+        *capacity = count;
+        *positions = (long long *)realloc(*positions, count * sizeof(long long));
+    }
+    if (count > 0) memcpy(*positions, entry->positions, count * sizeof(long long));
+    pthread_mutex_unlock(&ledgerLock);
+
+    Account acc;
+    memset(&acc, 0, sizeof(acc));
+    pthread_rwlock_rdlock(&storeLock);
+    int slot = findAccountSlot(account_number);
+    if (slot >= 0) {
+        pthread_mutex_t *lock = accountLock(account_number);
+        pthread_mutex_lock(lock);
+        copyAccount(slot, &acc);
+        pthread_mutex_unlock(lock);
+    }
+    pthread_rwlock_unlock(&storeLock);
+
+    // Ledger order is time order, so the period's first entry is found by bisection and the
+    // opening balance is the one the entry before it left
+    LedgerRecord rec;
+    if (count > 0) {
+        if (!ledgerReaderRead(reader, (*positions)[0], &rec)) return 0;
+        if (rec.timestamp > run->to) return 2;
+    }
+    int first = 0, hi = count;
+    while (first < hi) {
+        int mid = (first + hi) / 2;
+        if (!ledgerReaderRead(reader, (*positions)[mid], &rec)) return 0;
+        if (rec.timestamp < run->from) first = mid + 1;
+        else hi = mid;
+    }
+    Money opening = 0;
+    for (int k = first - 1; k >= 0; k--) {
+        if (!ledgerReaderRead(reader, (*positions)[k], &rec)) return 0;
+        if (ledgerCarriesBalance(&rec)) {
+            opening = rec.balance;
+            break;
+        }
+    }
+
+    char path[300];
+    char fromDate[20];
+    char toDate[20];
+    char line[128];
+    snprintf(path, sizeof(path), "%s/statement_%d.txt", run->dir, account_number);
+    FILE *out = fopen(path, "w");
+    if (!out) return 0;
+    formatDateTime((time_t)run->from, fromDate);
+    formatDateTime((time_t)run->to, toDate);
+    fromDate[10] = toDate[10] = '\0';  // dates only
+    char amount[MONEY_TEXT_MAX];
+    moneyFormat(opening, amount);
+    fprintf(out, "Statement of account %d\n%s\nPeriod: %s - %s\n\nOpening balance: %s\n", account_number, acc.name, fromDate, toDate, amount);
+    Money closing = opening;
+    int ok = 1;
+    for (int k = first; k < count; k++) {
+        if (!ledgerReaderRead(reader, (*positions)[k], &rec)) {
+            ok = 0;
+            break;
+        }
+        if (rec.timestamp > run->to) break;
+        formatLedgerRecord(&rec, line);
+        fprintf(out, "%s\n", line);
+        if (ledgerCarriesBalance(&rec)) closing = rec.balance;
+    }
+    moneyFormat(closing, amount);
+    fprintf(out, "Closing balance: %s\n", amount);
+    if (fclose(out) != 0) ok = 0;
+    return ok;
+}
+
+void *statementWorker(void *arg) {
+    StatementRun *run = (StatementRun *)arg;
+    LedgerReader reader = LEDGER_READER_INIT;
+    long long *positions = NULL;
+    int capacity = 0;
+    int finished[STATEMENT_CHUNK];
+    for (;;) {
+        pthread_mutex_lock(&run->lock);
+        int first = run->next;
+        int last = first + STATEMENT_CHUNK < run->count ? first + STATEMENT_CHUNK : run->count;
+        run->next = last;
+        pthread_mutex_unlock(&run->lock);
+        if (first >= last) break;
+
+        int n = 0, written = 0;
+        for (int i = first; i < last; i++) {
+            int result = writeStatement(run, &reader, run->accounts[i], &positions, &capacity);
+            if (result) finished[n++] = run->accounts[i];
+            if (result == 1) written++;
+        }
+        // Only finished statement files go into the checkpoint; a failed one is retried on resume
+        pthread_mutex_lock(&run->lock);
+        for (int i = 0; i < n; i++) fprintf(run->checkpoint, "%d\n", finished[i]);
+        fflush(run->checkpoint);
+        run->written += written;
+        run->failed += last - first - n;
+        pthread_mutex_unlock(&run->lock);
+    }
+    ledgerReaderClose(&reader);
+    free(positions);
+    return NULL;
+}
+
+// Account numbers an earlier run over the same period finished, ascending, or NULL when the
+// checkpoint is missing or for another period. Lines cut short by a crash are ignored.
+int *loadStatementCheckpoint(const char *path, long long from, long long to, int *count) {
+    *count = 0;
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    char line[64];
+    long long savedFrom, savedTo;
+    if (!fgets(line, sizeof(line), file) || sscanf(line, "statements %lld %lld", &savedFrom, &savedTo) != 2 ||
+        savedFrom != from || savedTo != to) {
+        fclose(file);
+        return NULL;
+    }
+    int capacity = 1024;
+    int *done = (int *)malloc(capacity * sizeof(int));
+    while (fgets(line, sizeof(line), file)) {
+        if (!strchr(line, '\n')) break;
+        if (*count == capacity) {
+            capacity *= 2;
+            done = (int *)realloc(done, capacity * sizeof(int));
+        }
+        done[(*count)++] = atoi(line);
+    }
+    fclose(file);
+    qsort(done, *count, sizeof(int), compareAccountNumbers);
+    return done;
+}
+
+int bankStatements(long long from, long long to, const char *dir, int workers) {
+    if (workers <= 0) workers = processorCount();
+    if (workers > STATEMENT_MAX_WORKERS) workers = STATEMENT_MAX_WORKERS;
+#ifdef _WIN32
+    _mkdir(dir);
+#else
+    mkdir(dir, 0755);
+#endif
+    StatementRun run;
+    memset(&run, 0, sizeof(run));
+    run.from = from;
+    run.to = to;
+    snprintf(run.dir, sizeof(run.dir), "%s", dir);
+    char path[300];
+    snprintf(path, sizeof(path), "%s/%s", dir, STATEMENT_CHECKPOINT);
+    int doneCount;
+    int *done = loadStatementCheckpoint(path, from, to, &doneCount);
+    run.checkpoint = fopen(path, done ? "a" : "w");
+    if (!run.checkpoint) {
+        free(done);
+        return -1;
+    }
+    if (!done) fprintf(run.checkpoint, "statements %lld %lld\n", from, to);
+    pthread_mutex_init(&run.lock, NULL);
+
+    // Compaction and archiving wait for the run, so no record moves under the workers
+    pthread_mutex_lock(&checkpointLock);
+    pthread_rwlock_rdlock(&storeLock);
+    run.accounts = (int *)malloc((store.count > 0 ? store.count : 1) * sizeof(int));
+    for (int i = 0; i < store.count; i++) {
+        // Accounts deleted during the period still get their last statement
+        if (store.deletedAt[i] == 0 || store.deletedAt[i] >= from) run.accounts[run.count++] = store.numbers[i];
+    }
+    pthread_rwlock_unlock(&storeLock);
+    qsort(run.accounts, run.count, sizeof(int), compareAccountNumbers);
+    // Both lists are ascending: drop what the earlier run finished
+    int kept = 0;
+    for (int i = 0, k = 0; i < run.count; i++) {
+        while (k < doneCount && done[k] < run.accounts[i]) k++;
+        if (k < doneCount && done[k] == run.accounts[i]) continue;
+        run.accounts[kept++] = run.accounts[i];
+    }
+    run.count = kept;
+    free(done);
+
+    pthread_mutex_lock(&ledgerLock);
+    if (ledger.appendFile) fflush(ledger.appendFile);  // workers read the segment files directly
+    run.end = ledger.nextPosition;
+    pthread_mutex_unlock(&ledgerLock);
+
+    if (workers > run.count) workers = run.count > 0 ? run.count : 1;
+    pthread_t threads[STATEMENT_MAX_WORKERS];
+    for (int k = 0; k < workers; k++) {
+        pthread_create(&threads[k], NULL, statementWorker, &run);
+    }
+    for (int k = 0; k < workers; k++) {
+        pthread_join(threads[k], NULL);
+    }
+    pthread_mutex_unlock(&checkpointLock);
+
+    if (fclose(run.checkpoint) != 0) run.failed++;
+    pthread_mutex_destroy(&run.lock);
+    free(run.accounts);
+    return run.failed > 0 ? -1 : run.written;
+}
+
+// Reconciliation - replays each account's ledger entries and compares every running balance
+// with the previous one plus or minus the amount, and the last one with the stored balance.
+// Accounts are handed out in chunks to worker threads as for statements. reconcile.ckpt holds
+// the ledger position the last run covered, so an incremental run checks only the accounts
+// posted to since, plus those the startup journal replay touched.
+#define RECONCILE_CHUNK 256
+#define RECONCILE_CHECKPOINT "reconcile.ckpt"
+#define RECONCILE_CHECKPOINT_TMP "reconcile.ckpt.tmp"
+
+typedef enum {
+    RECONCILE_ENTRY,          // a running balance does not follow from the entry before it
+    RECONCILE_STORED,         // the stored balance is not the ledger's last balance
+    RECONCILE_UNREADABLE      // the entry could not be read (damaged archive block)
+} ReconcileCheck;
+
+typedef struct {
+    int account_number;
+    int check;                // ReconcileCheck
+    long long position;       // ledger position of the entry, -1 for RECONCILE_STORED
+    Money expected;
+    Money found;
+} Discrepancy;
+
+typedef struct {
+    long long end;            // ledger position the run covers
+    int *accounts;
+    int count;
+    int next;
+    Discrepancy *found;
+    int foundCount;
+    int foundCapacity;
+    pthread_mutex_t lock;
+} ReconcileRun;
+
+void addDiscrepancy(ReconcileRun *run, int account_number, int check, long long position, Money expected, Money found) {
+    pthread_mutex_lock(&run->lock);
+    if (run->foundCount == run->foundCapacity) {
+        run->foundCapacity = run->foundCapacity > 0 ? run->foundCapacity * 2 : 64;
+        run->found = (Discrepancy *)realloc(run->found, run->foundCapacity * sizeof(Discrepancy));
+    }
+    Discrepancy *d = &run->found[run->foundCount++];
+    d->account_number = account_number;
+    d->check = check;
+    d->position = position;
+    d->expected = expected;
+    d->found = found;
+    pthread_mutex_unlock(&run->lock);
+}
+
+void reconcileAccount(ReconcileRun *run, LedgerReader *reader, int account_number, long long **positions, int *capacity) {
+    // The positions and the stored balance are copied together under the account lock, so no
+    // posting to this account falls between them
+    pthread_rwlock_rdlock(&storeLock);
+    int slot = findAccountSlot(account_number);
+    if (slot < 0) {
+        pthread_rwlock_unlock(&storeLock);
+        return;
+    }
+    pthread_mutex_t *lock = accountLock(account_number);
+    pthread_mutex_lock(lock);
+    Money stored = store.balances[slot];
+    pthread_mutex_lock(&ledgerLock);
+    LedgerIndexEntry *entry = ledgerFindEntry(account_number, 0);
+    int count = entry ? entry->count : 0;
+    if (count > *capacity) {
+        *capacity = count;
+        *positions = (long long *)realloc(*positions, count * sizeof(long long));
+    }
+    if (count > 0) memcpy(*positions, entry->positions, count * sizeof(long long));
+    // Postings since the run started may still sit in the stdio buffer (group commit)
+    if (count > 0 && (*positions)[count - 1] >= run->end && ledger.appendFile) fflush(ledger.appendFile);
+    pthread_mutex_unlock(&ledgerLock);
+    pthread_mutex_unlock(lock);
+    pthread_rwlock_unlock(&storeLock);
+
+    Money balance = 0;
+    LedgerRecord rec;
+    for (int k = 0; k < count; k++) {
+        if (!ledgerReaderRead(reader, (*positions)[k], &rec)) {
+            addDiscrepancy(run, account_number, RECONCILE_UNREADABLE, (*positions)[k], balance, 0);
+            return;  // the rest of the chain cannot be checked
+        }
+        Money expected = balance;
+        if (rec.type == LEDGER_DEPOSIT || rec.type == LEDGER_INTEREST) expected = balance + rec.amount;
+        if (rec.type == LEDGER_WITHDRAW) expected = balance - rec.amount;
+        if (!ledgerCarriesBalance(&rec)) continue;
+        // An upgrade's open record starts the chain; anything else has to follow from it
+        if (rec.type != LEDGER_OPEN && expected != rec.balance) {
+            addDiscrepancy(run, account_number, RECONCILE_ENTRY, (*positions)[k], expected, rec.balance);
+        }
+        balance = rec.balance;
+    }
+    if (balance != stored) addDiscrepancy(run, account_number, RECONCILE_STORED, -1, balance, stored);
+}
+
+void *reconcileWorker(void *arg) {
+    ReconcileRun *run = (ReconcileRun *)arg;
+    LedgerReader reader = LEDGER_READER_INIT;
+    long long *positions = NULL;
+    int capacity = 0;
+    for (;;) {
+        pthread_mutex_lock(&run->lock);
+        int first = run->next;
+        int last = first + RECONCILE_CHUNK < run->count ? first + RECONCILE_CHUNK : run->count;
+        run->next = last;
+        pthread_mutex_unlock(&run->lock);
+        if (first >= last) break;
+        for (int i = first; i < last; i++) reconcileAccount(run, &reader, run->accounts[i], &positions, &capacity);
+    }
+    ledgerReaderClose(&reader);
+    free(positions);
+    return NULL;
+}
+
+// Ledger position the last run covered, -1 if there is no usable checkpoint
+long long loadReconcileCheckpoint() {
+    FILE *file = fopen(RECONCILE_CHECKPOINT, "r");
+    if (!file) return -1;
+    char line[64];
+    long long covered = -1;
+    if (!fgets(line, sizeof(line), file) || sscanf(line, "reconcile %lld", &covered) != 1) covered = -1;
+    fclose(file);
+    return covered;
+}
+
+int saveReconcileCheckpoint(long long covered) {
+    FILE *file = fopen(RECONCILE_CHECKPOINT_TMP, "w");
+    if (!file) return 0;
+    fprintf(file, "reconcile %lld\n", covered);
+    int ok = syncFile(file);
+    if (fclose(file) != 0) ok = 0;
+#ifdef _WIN32
+    if (ok) remove(RECONCILE_CHECKPOINT);
+#endif
+    ok = ok && rename(RECONCILE_CHECKPOINT_TMP, RECONCILE_CHECKPOINT) == 0;
+    if (!ok) remove(RECONCILE_CHECKPOINT_TMP);
+    return ok;
+}
+
+// Accounts an incremental run checks: those with entries in [from, end) and those the journal
+// replay touched, ascending and without repeats (caller holds checkpointLock)
+int *touchedAccounts(long long from, long long end, int *count) {
+    int capacity = journalRecoveredCount + 1024;
+    int *accounts = (int *)malloc(capacity * sizeof(int));
+    memcpy(accounts, journalRecovered, journalRecoveredCount * sizeof(int));
+    int n = journalRecoveredCount;
+    LedgerReader reader = LEDGER_READER_INIT;
+    LedgerRecord rec;
+    for (long long position = from; position < end; position++) {
+        if (!ledgerReaderRead(&reader, position, &rec)) continue;
+        if (n == capacity) {
+            capacity *= 2;
+            accounts = (int *)realloc(accounts, capacity * sizeof(int));
+        }
+        accounts[n++] = rec.account_number;
+    }
+    ledgerReaderClose(&reader);
+    qsort(accounts, n, sizeof(int), compareAccountNumbers);
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        if (kept == 0 || accounts[kept - 1] != accounts[i]) accounts[kept++] = accounts[i];
+    }
+    *count = kept;
+    return accounts;
+}
+
+int compareDiscrepancies(const void *a, const void *b) {
+    const Discrepancy *x = (const Discrepancy *)a;
+    const Discrepancy *y = (const Discrepancy *)b;
+    if (x->account_number != y->account_number) return (x->account_number > y->account_number) - (x->account_number < y->account_number);
+    return (x->position > y->position) - (x->position < y->position);
+}
+
+int writeReconcileReport(const char *path, ReconcileRun *run, int incremental) {
+    const char *checks[] = {"entry", "stored", "unreadable"};
+    FILE *out = fopen(path, "w");
+    if (!out) return 0;
+    qsort(run->found, run->foundCount, sizeof(Discrepancy), compareDiscrepancies);
+    fprintf(out, "# reconcile %s up to ledger position %lld: %d accounts checked, %d discrepancies\n",
+            incremental ? "incremental" : "full", run->end, run->count, run->foundCount);
+    fprintf(out, "account,check,ledger_position,expected,found\n");
+    for (int i = 0; i < run->foundCount; i++) {
+        Discrepancy *d = &run->found[i];
+        fprintf(out, "%d,%s,", d->account_number, checks[d->check]);
+        if (d->position >= 0) fprintf(out, "%lld,", d->position);
+        else fprintf(out, "-,");
+        char expected[MONEY_TEXT_MAX];
+        char found[MONEY_TEXT_MAX];
+        moneyFormat(d->expected, expected);
+        moneyFormat(d->found, found);
+        if (d->check == RECONCILE_UNREADABLE) fprintf(out, "%s,-\n", expected);
+        else fprintf(out, "%s,%s\n", expected, found);
+    }
+    return fclose(out) == 0;
+}
+
+int bankReconcile(const char *reportPath, int incremental, int workers, int *checked) {
+    if (workers <= 0) workers = processorCount();
+    if (workers > STATEMENT_MAX_WORKERS) workers = STATEMENT_MAX_WORKERS;
+    ReconcileRun run;
+    memset(&run, 0, sizeof(run));
+    pthread_mutex_init(&run.lock, NULL);
+
+    // Compaction and archiving wait for the run, so no record moves under the workers
+    pthread_mutex_lock(&checkpointLock);
+    pthread_mutex_lock(&ledgerLock);
+    if (ledger.appendFile) fflush(ledger.appendFile);  // workers read the segment files directly
+    run.end = ledger.nextPosition;
+    pthread_mutex_unlock(&ledgerLock);
+
+    long long covered = incremental ? loadReconcileCheckpoint() : -1;
+    if (covered >= 0 && covered <= run.end) {
+        // Compaction moves records within sealed segments, so once the covered position's segment
+        // is sealed the scan starts from its first record
+        long long from = covered;
+        if (covered / LEDGER_SEGMENT_RECORDS < run.end / LEDGER_SEGMENT_RECORDS) from -= covered % LEDGER_SEGMENT_RECORDS;
+        run.accounts = touchedAccounts(from, run.end, &run.count);
+    } else {
+        incremental = 0;
+        pthread_rwlock_rdlock(&storeLock);
+        run.accounts = (int *)malloc((store.count > 0 ? store.count : 1) * sizeof(int));
+        for (int i = 0; i < store.count; i++) run.accounts[run.count++] = store.numbers[i];
+        pthread_rwlock_unlock(&storeLock);
+    }
+
+    if (workers > run.count) workers = run.count > 0 ? run.count : 1;
+    pthread_t threads[STATEMENT_MAX_WORKERS];
+    for (int k = 0; k < workers; k++) {
+        pthread_create(&threads[k], NULL, reconcileWorker, &run);
+    }
+    for (int k = 0; k < workers; k++) {
+        pthread_join(threads[k], NULL);
+    }
+
+    int ok = writeReconcileReport(reportPath, &run, incremental);
+    // The next incremental run starts where this one ended
+    if (ok) ok = saveReconcileCheckpoint(run.end);
+    if (ok) journalRecoveredCount = 0;
+    pthread_mutex_unlock(&checkpointLock);
+
+    if (checked) *checked = run.count;
+    int found = run.foundCount;
+    pthread_mutex_destroy(&run.lock);
+    free(run.accounts);
+    free(run.found);
+    return ok ? found : -1;
+}
+
+int bankSetInterestRates(const char *text) {
+    InterestRates rates;
+    int count = interestParseRates(text, &rates);
+    if (count < 0) return count;
+    interestRates = rates;
+    interestRatesLoaded = 1;
+    return count;
+}
+
+BankStatus bankSetAccountClass(int account_number, int accountClass) {
+    if (accountClass < 0 || accountClass >= INTEREST_MAX_CLASSES) return BANK_ERR_INVALID;
+    BankStatus status = BANK_ERR_NOT_FOUND;
+    pthread_rwlock_rdlock(&storeLock);
+    int slot = findLiveAccountSlot(account_number);
+    if (slot >= 0) {
+        pthread_mutex_t *lock = accountLock(account_number);
+        pthread_mutex_lock(lock);
+        pthread_mutex_lock(&datLock);
+        int ok = classFile && fprintf(classFile, "C,%d,%d\n", account_number, accountClass) > 0 && syncFile(classFile);
+        pthread_mutex_unlock(&datLock);
+        if (ok) store.classes[slot] = (unsigned char)accountClass;
+        status = ok ? BANK_OK : BANK_ERR_IO;
+        pthread_mutex_unlock(lock);
+    }
+    pthread_rwlock_unlock(&storeLock);
+    return status;
+}
+
+// The run holds storeLock for writing throughout, so it sees every balance at one instant and
+// no posting lands between its ledger entries and its balances
+int bankAccrueInterest(int days, Money *totalInterest) {
+    if (days < 1 || days > 365) return -1;
+    pthread_rwlock_wrlock(&storeLock);
+    // Balances in the journal predate the run and must not be replayed over it
+    pthread_mutex_lock(&journalLock);
+    int ok = datFile && compactJournal();
+    pthread_mutex_unlock(&journalLock);
+    if (!ok) {
+        pthread_rwlock_unlock(&storeLock);
+        return -1;
+    }
+
+    InterestTable table;
+    interestPrepare(&interestRates, days, &table);
+    long long *cents = (long long *)malloc(INTEREST_CHUNK * sizeof(long long));
+    long long *interest = (long long *)malloc(INTEREST_CHUNK * sizeof(long long));
+    InterestEntry *entries = (InterestEntry *)malloc((store.count > 0 ? store.count : 1) * sizeof(InterestEntry));
+    int count = 0;
+    long long total = 0;
+    for (int first = 0; first < store.count; first += INTEREST_CHUNK) {
+        int n = store.count - first < INTEREST_CHUNK ? store.count - first : INTEREST_CHUNK;
+        for (int i = 0; i < n; i++) {
+            // Deleted accounts earn nothing
+            cents[i] = store.deletedAt[first + i] == 0 ? store.balances[first + i] : 0;
+        }
+        interestAccrue(&table, cents, store.classes + first, interest, n);
+        for (int i = 0; i < n; i++) {
+            // A credit that would take the balance past MONEY_MAX is not paid
+            if (interest[i] <= 0 || interest[i] > MONEY_MAX - cents[i]) continue;
+            entries[count].account_number = store.numbers[first + i];
+            entries[count].slot = first + i;
+            entries[count].amount = interest[i];
+            entries[count].balance = cents[i] + interest[i];
+            total += interest[i];
+            count++;
+        }
+    }
+    free(cents);
+    free(interest);
+
+    if (count > 0) {
+        InterestRunHeader header;
+        header.magic = INTEREST_RUN_MAGIC;
+        header.count = count;
+        pthread_mutex_lock(&ledgerLock);
+        header.startPosition = ledger.nextPosition;
+        pthread_mutex_unlock(&ledgerLock);
+        header.timestamp = (long long)time(NULL);
+        header.checksum = checkpointChecksum(14695981039346656037ULL, entries, count * sizeof(InterestEntry));
+        FILE *file = fopen(INTEREST_RUN_FILE, "wb");
+        ok = file && fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(entries, sizeof(InterestEntry), count, file) == (size_t)count && syncFile(file);
+        if (file && fclose(file) != 0) ok = 0;
+        if (ok) ok = commitInterestRun(&header, entries);
+        else remove(INTEREST_RUN_FILE);
+    }
+    free(entries);
+    pthread_rwlock_unlock(&storeLock);
+    if (totalInterest) *totalInterest = ok ? total : 0;
+    return ok ? count : -1;
+}
+
+int bankHistoryCount(int account_number) {
+    return ledgerHistoryCount(account_number);
+}
+
+int bankHistoryEntry(int account_number, int n, LedgerRecord *rec) {
+    long long start = metricNow();
+    int found = ledgerHistoryEntry(account_number, n, rec);
+    metricLatency(LATENCY_HISTORY, start);
+    return found;
+}
+
+char *bankReadTextFile(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return NULL;
+    }
+    char *text = (char *)malloc(size + 1);
+    size_t length = fread(text, 1, size, file);   // fewer than size in text mode on Windows
+    int failed = ferror(file);
+    fclose(file);
+    if (failed) {
+        free(text);
+        return NULL;
+    }
+    text[length] = '\0';
+    return text;
+}
+
+const char *bankStatusMessage(BankStatus status) {
+    switch (status) {
+        case BANK_OK: return "OK";
+        case BANK_ERR_INVALID: return "All fields must be filled correctly!";
+        case BANK_ERR_DUPLICATE_MOBILE: return "Mobile number already exists!";
+        case BANK_ERR_NOT_FOUND: return "Account not found!";
+        case BANK_ERR_AUTH: return "Invalid credentials!";
+        case BANK_ERR_AMOUNT: return "Insufficient amount! please enter a valid amount.";
+        case BANK_ERR_IO: return "Unable to save account!";
+        case BANK_ERR_VERIFY: return "Please answer the security question.";
+        case BANK_ERR_BLOCKED: return "Transaction limit reached! please contact the bank.";
+        case BANK_ERR_DENIED: return "Not allowed for this session!";
+        case BANK_ERR_BUSY: return "Server busy! please try again later.";
+    }
+    return "Unknown error";
+}
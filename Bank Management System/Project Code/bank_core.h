@@ -0,0 +1,203 @@
+#ifndef BANK_CORE_H
+#define BANK_CORE_H
+
+// Banking core - accounts, balances and the transaction ledger, with no UI dependency.
+// Used by bank_server, the headless tools (bank_cli.c, bank_bench.c) and, through
+// bank_client.c, the raylib client (bank_management.c).
+// All data files live in the current working directory.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Money in minor units (paisa, 100 to the rupee) - balances and amounts are exact integers;
+// bank_money.h reads and writes them as "<rupees>.<paisa>" text
+typedef long long Money;
+
+// Struct for account
+typedef struct {
+    char name[50];
+    char father_name[50];
+    char mobile_number[12];
+    char address[100];
+    char password[20];
+    int account_number;
+    Money balance;
+} Account;
+
+typedef enum {
+    LEDGER_DEPOSIT = 1,
+    LEDGER_WITHDRAW = 2,
+    LEDGER_CLOSE = 3,    // account deleted (tombstoned)
+    LEDGER_REOPEN = 4,   // deleted account restored within the retention period
+    LEDGER_OPEN = 5,     // account created (or, when upgrading old data, a reused number taken)
+    LEDGER_INTEREST = 6  // interest credited by bankAccrueInterest()
+} LedgerType;
+
+// One ledger entry as stored on disk
+typedef struct {
+    long long timestamp;  // epoch seconds
+    int account_number;
+    int type;             // LedgerType
+    Money amount;
+    Money balance;
+} LedgerRecord;
+
+// Result of every banking operation
+typedef enum {
+    BANK_OK = 0,
+    BANK_ERR_INVALID,          // required field missing or malformed
+    BANK_ERR_DUPLICATE_MOBILE,
+    BANK_ERR_NOT_FOUND,
+    BANK_ERR_AUTH,             // wrong mobile/password
+    BANK_ERR_AMOUNT,           // amount not positive, more than the balance, or the balance would pass MONEY_MAX
+    BANK_ERR_IO,
+    BANK_ERR_VERIFY,           // the velocity rules want the security question answered first
+    BANK_ERR_BLOCKED,          // the velocity rules refuse the posting
+    BANK_ERR_DENIED,           // the session is not logged in to the account, or is not an admin
+    BANK_ERR_BUSY              // bank_server already serves as many sessions as it has workers
+} BankStatus;
+
+// Load accounts, replay the journal and index the ledger - call once before anything else
+int bankOpen(void);
+// Flush everything to disk and release the files
+void bankClose(void);
+
+// Create an account from the text fields of acc; fills in account_number and a zero balance
+BankStatus bankCreateAccount(Account *acc);
+BankStatus bankLogin(const char *mobile, const char *password, Account *out);
+BankStatus bankGetAccount(int account_number, Account *out);
+int bankAccountCount(void);
+// Sum of the live balances, read from the balance column without taking the account locks -
+// postings made during the scan may or may not be counted
+Money bankTotalBalance(void);
+// Post a deposit/withdrawal and its ledger entry; out (optional) receives the updated account
+BankStatus bankDeposit(int account_number, Money amount, Account *out);
+BankStatus bankWithdraw(int account_number, Money amount, Account *out);
+// Security questions for a posting the velocity rules hold with BANK_ERR_VERIFY: 0 father's
+// name, 1 registered mobile number, 2 address
+#define BANK_SECURITY_QUESTIONS 3
+const char *bankSecurityQuestion(int question);
+// The same with the customer's answer to question, checked against the account's profile: a
+// match lets a BANK_ERR_VERIFY posting through, a wrong answer fails with BANK_ERR_AUTH
+BankStatus bankDepositAnswered(int account_number, Money amount, int question, const char *answer, Account *out);
+BankStatus bankWithdrawAnswered(int account_number, Money amount, int question, const char *answer, Account *out);
+// The same once bank staff have verified the customer in person - trusted callers only
+BankStatus bankDepositVerified(int account_number, Money amount, Account *out);
+BankStatus bankWithdrawVerified(int account_number, Money amount, Account *out);
+// Replace the velocity rules checked on every deposit and withdrawal (bank_velocity.h), one per
+// line: "<deposit|withdraw> <amount|count/<window>|sum/<window>> <limit> <verify|block>" with
+// windows 1h, 24h and 7d, e.g. "withdraw sum/24h 50000 verify". Returns the number of rules, or
+// -(line number) of the first malformed line, keeping the old rules. Call it while no postings
+// are in flight.
+int bankSetVelocityRules(const char *text);
+// Replace the interest rates (bank_interest.h), one account class per line: "<class> <annual
+// rate %> [above <balance> <rate %> ...]", e.g. "0 2.5 above 100000 3" pays 2.5% on the first
+// 100000 and 3% on the rest. Rates (below 100) and balances take at most two decimals. Classes
+// 0-15; a class with no line earns nothing. Returns the number of classes, or -(line number) of
+// the first malformed line, keeping the old rates.
+int bankSetInterestRates(const char *text);
+// Move an account to another interest class (every account starts in class 0)
+BankStatus bankSetAccountClass(int account_number, int accountClass);
+// Credit interest for days (1 to 365) to every live account: a LEDGER_INTEREST entry for each
+// account that earns at least a cent, and the new balances, committed as one batch - a crash
+// part way through is finished by the next bankOpen(). Postings wait while it runs. Sets
+// *totalInterest (optional) to the interest paid; returns the number of accounts credited, -1 on error.
+int bankAccrueInterest(int days, Money *totalInterest);
+// Replace name, father's name, address and password of an existing account
+BankStatus bankUpdateAccount(const Account *user);
+// Deleting only tombstones an account: it can no longer be used, but it keeps its balance and
+// history and bankUndeleteAccount() restores it within the retention period (30 days by default).
+BankStatus bankDeleteAccount(int account_number);
+BankStatus bankUndeleteAccount(int account_number, Account *out);
+void bankSetDeleteRetention(long long seconds);
+// Reclaim accounts deleted longer ago than the retention period, with their ledger entries, and
+// move ledger segments older than the archive age to the compressed archive tier (history
+// still reads them); returns how many accounts were removed
+int bankCompact(void);
+// Age of the ledger segments bankCompact() archives (90 days by default, < 0 = never)
+void bankSetArchiveAge(long long seconds);
+// Run bankCompact() every intervalSeconds on a background thread until bankClose()
+void bankStartCompactor(int intervalSeconds);
+// Save the ledger index with the ledger position it covers, so the next bankOpen() scans only
+// the records appended after it; returns 1 on success. bankClose() takes one as well.
+int bankCheckpoint(void);
+// Run bankCheckpoint() every intervalSeconds on a background thread until bankClose()
+void bankStartCheckpoints(int intervalSeconds);
+
+// Group commit for high-volume posting: a deposit or withdrawal returns only once an fsync of
+// the journal and the ledger covers it, and one fsync covers every posting that arrives within
+// latencyMicros of the first (at most maxBatch, <= 0 for no limit). latencyMicros < 0 turns it
+// off - the default, where each write is flushed to the OS but not fsynced. Call it while no
+// postings are in flight.
+void bankSetGroupCommit(int latencyMicros, int maxBatch);
+// Sync rounds completed since bankOpen (each one made a whole batch of postings durable)
+long long bankCommitRounds(void);
+
+// Operational metrics (bank_metrics.c) - counters and latency histograms since the process started.
+// Security questions: failed = 0 when one is asked, 1 when the answer was wrong (the protocol
+// and the answered postings record these).
+void bankRecordWithdrawVerify(int failed);
+// Render all metrics in the Prometheus text format; returns the length written
+int bankMetricsText(char *out, int size);
+// Rewrite path with bankMetricsText() every intervalSeconds on a background thread until bankClose()
+void bankStartMetricsFile(const char *path, int intervalSeconds);
+
+// Transaction history, oldest entry first
+int bankHistoryCount(int account_number);
+int bankHistoryEntry(int account_number, int n, LedgerRecord *rec);
+// Format an entry as "dd/mm/yyyy hh:mm:ss: Deposit 100.00, Balance: 250.00" (line needs 128 bytes)
+void formatLedgerRecord(const LedgerRecord *rec, char *line);
+
+// Month-end statements: dir/statement_<account>.txt for every account open during the period,
+// with the opening balance, each ledger entry from from to to (epoch seconds, inclusive) and the
+// closing balance. Accounts are shared out to workers threads (<= 0: one per core). Finished
+// accounts are listed in dir/statements.ckpt, so an interrupted run started again over the same
+// period resumes where it stopped. Returns the number of statements written, -1 if any failed.
+int bankStatements(long long from, long long to, const char *dir, int workers);
+// Reconciliation audit: replays every account's ledger entries, checking each running balance
+// against the one before it and the last against the stored balance, on worker threads (<= 0:
+// one per core). reportPath receives one CSV line per discrepancy. incremental = 1 checks only
+// accounts posted to since the last run (reconcile.ckpt) or touched by the startup journal replay;
+// without a checkpoint it checks them all. Sets *checked (optional) to the number of accounts
+// checked; returns the number of discrepancies, -1 if the report could not be written.
+int bankReconcile(const char *reportPath, int incremental, int workers, int *checked);
+// Epoch seconds of 00:00 PKT on a dd/mm/yyyy date, -1 if it is not a valid date
+long long bankParseDate(const char *date);
+
+// The whole of a text file such as a rules or rates file, NUL-terminated, for the caller to
+// free(); NULL if it cannot be read
+char *bankReadTextFile(const char *path);
+
+const char *bankStatusMessage(BankStatus status);
+
+// Line protocol shared by bank_cli, bank_server and the client (see bank_protocol.c).
+#define BANK_REQUEST_MAX 512
+#define BANK_REPLY_MAX 65536
+// bank_server listens on loopback only
+#define BANK_SERVER_HOST "127.0.0.1"
+#define BANK_SERVER_PORT 5125
+// Statements and reconciliation reports requested over the protocol are written here
+#define BANK_REPORT_DIR "reports"
+
+// One protocol connection. Requests about an account need that account logged in on the
+// session; undelete, compact, class, interest, statements and reconcile need an admin session.
+typedef struct {
+    int account_number;   // logged in with "login", 0 = none
+    int admin;            // any account and the admin operations - bank_cli, or "admin,<key>"
+    int question;         // security question asked with "question", -1 = none
+    int questionAccount;  // the account it was asked for
+} BankSession;
+
+void bankInitSession(BankSession *session, int admin);
+// Key that turns a session into an admin one with "admin,<key>"; NULL or "" (the default)
+// leaves admin sessions to bank_cli
+void bankSetAdminKey(const char *key);
+// Run one comma-separated request for session and write its reply lines into reply
+BankStatus bankExecute(BankSession *session, char *request, char *reply, int replySize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
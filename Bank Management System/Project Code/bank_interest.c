@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include "bank_interest.h"
+#include "bank_money.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define INTEREST_AVX2 1
+#endif
+
+const char *interestDefaultRates =
+    "# <class> <annual rate %> [above <balance> <rate %> ...] - each rate applies to the part of\n"
+    "# the balance above its amount. 0: savings (every new account), 1: current, 2: premium savings\n"
+    "0 2.5 above 100000 3 above 1000000 3.5\n"
+    "1 0\n"
+    "2 4 above 500000 5\n";
+
+// A rate in percent with at most two decimals ("2.5") as basis points, or -1 unless the whole
+// text is one below 100
+int interestParseRate(const char *text) {
+    Money value;
+    int used = moneyParse(text, &value);
+    return used > 0 && text[used] == '\0' && value >= 0 && value < 10000 ? (int)value : -1;
+}
+
+// Parse one class line; returns 1 for a class, 0 for a blank or comment line, -1 if malformed.
+// Rates and tier balances are read exactly, as every other amount is.
+int interestParseLine(const char *line, InterestRates *rates) {
+    int accountClass, used;
+    char first[16];
+    char word[32];
+    char amount[32];
+    if (sscanf(line, " %15s", first) != 1 || first[0] == '#') return 0;
+    if (sscanf(line, " %d %31s%n", &accountClass, word, &used) != 2) return -1;
+    if (accountClass < 0 || accountClass >= INTEREST_MAX_CLASSES) return -1;
+    InterestClass parsed;
+    memset(&parsed, 0, sizeof(parsed));
+    Money from = 0;
+    int basisPoints = interestParseRate(word);
+    for (;;) {
+        if (basisPoints < 0 || parsed.tiers == INTEREST_MAX_TIERS) return -1;
+        parsed.from[parsed.tiers] = from;
+        parsed.basisPoints[parsed.tiers] = basisPoints;
+        if (parsed.tiers > 0 && parsed.from[parsed.tiers] <= parsed.from[parsed.tiers - 1]) return -1;
+        parsed.tiers++;
+        line += used;
+        if (sscanf(line, " %31s%n", word, &used) != 1) break;
+        line += used;
+        if (strcmp(word, "above") != 0 || sscanf(line, " %31s %31s%n", amount, word, &used) != 2) return -1;
+        int n = moneyParse(amount, &from);
+        if (n == 0 || amount[n] != '\0' || from < 0 || from >= INTEREST_MAX_CENTS) return -1;
+        basisPoints = interestParseRate(word);
+    }
+    rates->classes[accountClass] = parsed;
+    return 1;
+}
+
+int interestParseRates(const char *text, InterestRates *rates) {
+    int count = 0;
+    int lineNumber = 0;
+    memset(rates, 0, sizeof(*rates));
+    while (*text) {
+        const char *end = strchr(text, '\n');
+        int length = end ? (int)(end - text) : (int)strlen(text);
+        char line[256];
+        lineNumber++;
+        if (length >= (int)sizeof(line)) return -lineNumber;
+        memcpy(line, text, length);
+        line[length] = '\0';
+        int parsed = interestParseLine(line, rates);
+        if (parsed < 0) return -lineNumber;
+        count += parsed;
+        text += end ? length + 1 : length;
+    }
+    return count;
+}
+
+// Interest for days on a 365-day year: basis points * days / (10000 * 365) of the balance,
+// kept as a fraction of 2^32 - below 2^32 for any rate under 100% and up to 365 days
+void interestPrepare(const InterestRates *rates, int days, InterestTable *table) {
+    memset(table, 0, sizeof(*table));
+    for (int c = 0; c < INTEREST_MAX_CLASSES; c++) {
+        const InterestClass *cls = &rates->classes[c];
+        int pays = 0;
+        for (int k = 0; k < cls->tiers; k++) {
+            table->from[c][k] = cls->from[k];
+            table->width[c][k] = (k + 1 < cls->tiers ? cls->from[k + 1] : INTEREST_MAX_CENTS) - cls->from[k];
+            table->rate[c][k] = ((long long)cls->basisPoints[k] * days * 4294967296LL + 1825000) / 3650000;
+            if (table->rate[c][k] > 0) pays = 1;
+        }
+        if (!pays) continue;
+        table->tiers[c] = cls->tiers;
+        table->active[table->activeCount++] = c;
+    }
+}
+
+// Each tier adds part * rate / 2^32 cents. part is split at bit 32 so every product fits in 64
+// bits: the high half's product is whole cents, the low half's keeps 24 bits of fraction, and
+// the sum is rounded once at the end.
+void interestAccrueScalar(const InterestTable *table, const long long *cents, const unsigned char *classes, long long *interest, int n) {
+    for (int i = 0; i < n; i++) {
+        long long balance = cents[i] < INTEREST_MAX_CENTS ? cents[i] : INTEREST_MAX_CENTS;
+        int c = classes[i] & (INTEREST_MAX_CLASSES - 1);
+        unsigned long long high = 0, low = 0;
+        for (int k = 0; k < table->tiers[c]; k++) {
+            long long part = balance - table->from[c][k];
+            if (part < 0) part = 0;
+            if (part > table->width[c][k]) part = table->width[c][k];
+            unsigned long long rate = (unsigned long long)table->rate[c][k];
+            high += ((unsigned long long)part >> 32) * rate;
+            low += (((unsigned long long)part & 0xFFFFFFFFULL) * rate) >> 8;
+        }
+        interest[i] = (long long)(high + ((low + (1ULL << 23)) >> 24));
+    }
+}
+
+#ifdef INTEREST_AVX2
+// Four accounts per step. Each class that pays interest is worked out for the lanes holding
+// it, with its tiers broadcast; most accounts share a few classes, so this beats gathering
+// every lane's rates.
+__attribute__((target("avx2")))
+void interestAccrueAvx2(const InterestTable *table, const long long *cents, const unsigned char *classes, long long *interest, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i maxCents = _mm256_set1_epi64x(INTEREST_MAX_CENTS);
+    const __m256i half = _mm256_set1_epi64x(1LL << 23);
+    const __m256i classMask = _mm256_set1_epi64x(INTEREST_MAX_CLASSES - 1);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i balance = _mm256_loadu_si256((const __m256i *)(cents + i));
+        balance = _mm256_blendv_epi8(balance, maxCents, _mm256_cmpgt_epi64(balance, maxCents));
+        int packed;
+        memcpy(&packed, classes + i, sizeof(packed));
+        __m256i lanes = _mm256_and_si256(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed)), classMask);
+        __m256i result = zero;
+        for (int a = 0; a < table->activeCount; a++) {
+            int c = table->active[a];
+            __m256i mask = _mm256_cmpeq_epi64(lanes, _mm256_set1_epi64x(c));
+            if (_mm256_testz_si256(mask, mask)) continue;
+            __m256i high = zero, low = zero;
+            for (int k = 0; k < table->tiers[c]; k++) {
+                __m256i part = _mm256_sub_epi64(balance, _mm256_set1_epi64x(table->from[c][k]));
+                __m256i width = _mm256_set1_epi64x(table->width[c][k]);
+                __m256i rate = _mm256_set1_epi64x(table->rate[c][k]);
+                part = _mm256_and_si256(part, _mm256_cmpgt_epi64(part, zero));
+                part = _mm256_blendv_epi8(part, width, _mm256_cmpgt_epi64(part, width));
+                // _mm256_mul_epu32 multiplies the low 32 bits of each lane
+                high = _mm256_add_epi64(high, _mm256_mul_epu32(_mm256_srli_epi64(part, 32), rate));
+                low = _mm256_add_epi64(low, _mm256_srli_epi64(_mm256_mul_epu32(part, rate), 8));
+            }
+            __m256i sum = _mm256_add_epi64(high, _mm256_srli_epi64(_mm256_add_epi64(low, half), 24));
+            result = _mm256_or_si256(result, _mm256_and_si256(sum, mask));
+        }
+        _mm256_storeu_si256((__m256i *)(interest + i), result);
+    }
+    interestAccrueScalar(table, cents + i, classes + i, interest + i, n - i);
+}
+#endif
+
+int interestHasAvx2() {
+#ifdef INTEREST_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return 0;
+#endif
+}
+
+void interestAccrue(const InterestTable *table, const long long *cents, const unsigned char *classes, long long *interest, int n) {
+#ifdef INTEREST_AVX2
+    if (interestHasAvx2()) {
+        interestAccrueAvx2(table, cents, classes, interest, n);
+        return;
+    }
+#endif
+    interestAccrueScalar(table, cents, classes, interest, n);
+}
+
+const char *interestKernelName(void) {
+    return interestHasAvx2() ? "avx2" : "scalar";
+}
@@ -0,0 +1,57 @@
+#ifndef BANK_INTEREST_H
+#define BANK_INTEREST_H
+
+// Interest accrual - every account belongs to a class (0 for new accounts), and each class has
+// tiered annual rates: a tier's rate applies to the part of the balance above the tier's start,
+// up to the next tier's start. A run computes the interest for a number of days over the whole
+// balance column at once, in integer cents, four accounts per step where the CPU has AVX2.
+
+#define INTEREST_MAX_CLASSES 16
+#define INTEREST_MAX_TIERS 4
+#define INTEREST_MAX_CENTS (1LL << 46)   // balances above this earn interest on this much
+
+typedef struct {
+    int tiers;                            // 0 = the class earns nothing
+    long long from[INTEREST_MAX_TIERS];   // cents; from[0] = 0, increasing
+    int basisPoints[INTEREST_MAX_TIERS];  // annual rate in 1/100 of a percent, below 10000
+} InterestClass;
+
+typedef struct {
+    InterestClass classes[INTEREST_MAX_CLASSES];
+} InterestRates;
+
+// The rates of one run as the kernels read them
+typedef struct {
+    long long from[INTEREST_MAX_CLASSES][INTEREST_MAX_TIERS];   // cents
+    long long width[INTEREST_MAX_CLASSES][INTEREST_MAX_TIERS];  // cents the tier spans
+    long long rate[INTEREST_MAX_CLASSES][INTEREST_MAX_TIERS];   // share paid for the run, in 2^-32 units
+    int tiers[INTEREST_MAX_CLASSES];      // 0 when no tier of the class pays anything
+    int active[INTEREST_MAX_CLASSES];     // the classes with tiers, so the kernels skip the others
+    int activeCount;
+} InterestTable;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rates used until bankSetInterestRates() replaces them
+extern const char *interestDefaultRates;
+
+// Parse one class per line ("0 2.5 above 100000 3", '#' starts a comment) into rates; returns
+// how many classes, or -(line number) of the first malformed line
+int interestParseRates(const char *text, InterestRates *rates);
+// Lay out rates for a run covering days (1 to 365)
+void interestPrepare(const InterestRates *rates, int days, InterestTable *table);
+// interest[i] = the interest in cents on cents[i] for an account of class classes[i], rounded
+// to the nearest cent; negative balances earn nothing
+void interestAccrue(const InterestTable *table, const long long *cents, const unsigned char *classes, long long *interest, int n);
+// The same without SIMD, for comparison
+void interestAccrueScalar(const InterestTable *table, const long long *cents, const unsigned char *classes, long long *interest, int n);
+// "avx2" or "scalar" - the kernel interestAccrue() uses on this CPU
+const char *interestKernelName(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#include <string.h>
+#include "bank_lz.h"
+
+#define LZ_HASH_BITS 14
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_LAST_LITERALS 5   // the final bytes are always literals
+#define LZ_MATCH_LIMIT 12    // no match starts this close to the end
+
+unsigned int lzRead32(const unsigned char *p) {
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+unsigned int lzHash(unsigned int v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Write a length continuation (the part above 15) as 255-valued bytes and a final remainder
+int lzPutLength(unsigned char *out, int op, int capacity, int length) {
+    for (; length >= 255; length -= 255) {
+        if (op >= capacity) return -1;
+        out[op++] = 255;
+    }
+    if (op >= capacity) return -1;
+    out[op++] = (unsigned char)length;
+    return op;
+}
+
+// Emit one sequence; offset 0 marks the last one (literals only). Returns the new output size or -1.
+int lzPutSequence(unsigned char *out, int op, int capacity, const unsigned char *literals, int literalCount, int offset, int matchLength) {
+    if (op >= capacity) return -1;
+    int token = op++;
+    int matchCode = offset > 0 ? matchLength - LZ_MIN_MATCH : 0;
+    out[token] = (unsigned char)((literalCount < 15 ? literalCount : 15) << 4 | (matchCode < 15 ? matchCode : 15));
+    if (literalCount >= 15 && (op = lzPutLength(out, op, capacity, literalCount - 15)) < 0) return -1;
+    if (op + literalCount > capacity) return -1;
+    memcpy(out + op, literals, literalCount);
+    op += literalCount;
+    if (offset == 0) return op;
+    if (op + 2 > capacity) return -1;
+    out[op++] = (unsigned char)(offset & 0xff);
+    out[op++] = (unsigned char)(offset >> 8);
+    if (matchCode >= 15 && (op = lzPutLength(out, op, capacity, matchCode - 15)) < 0) return -1;
+    return op;
+}
+
+int lzCompress(const unsigned char *in, int n, unsigned char *out, int capacity) {
+    int table[1 << LZ_HASH_BITS];
+    memset(table, -1, sizeof(table));
+    int op = 0;
+    int anchor = 0;
+    int i = 0;
+    while (i < n - LZ_MATCH_LIMIT) {
+        unsigned int sequence = lzRead32(in + i);
+        unsigned int h = lzHash(sequence);
+        int candidate = table[h];
+        table[h] = i;
+        if (candidate < 0 || i - candidate > LZ_MAX_OFFSET || lzRead32(in + candidate) != sequence) {
+            i++;
+            continue;
+        }
+        int length = LZ_MIN_MATCH;
+        while (i + length < n - LZ_LAST_LITERALS && in[candidate + length] == in[i + length]) length++;
+        op = lzPutSequence(out, op, capacity, in + anchor, i - anchor, i - candidate, length);
+        if (op < 0) return -1;
+        i += length;
+        anchor = i;
+    }
+    return lzPutSequence(out, op, capacity, in + anchor, n - anchor, 0, 0);
+}
+
+int lzDecompress(const unsigned char *in, int n, unsigned char *out, int capacity) {
+    int ip = 0;
+    int op = 0;
+    while (ip < n) {
+        int token = in[ip++];
+        int literalCount = token >> 4;
+        if (literalCount == 15) {
+            int more;
+            do {
+                if (ip >= n) return -1;
+                more = in[ip++];
+                literalCount += more;
+            } while (more == 255);
+        }
+        if (literalCount > n - ip || literalCount > capacity - op) return -1;
+        memcpy(out + op, in + ip, literalCount);
+        ip += literalCount;
+        op += literalCount;
+        if (ip == n) break;  // the last sequence has no match
+
+        if (n - ip < 2) return -1;
+        int offset = in[ip] | in[ip + 1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op) return -1;
+        int length = (token & 15) + LZ_MIN_MATCH;
+        if ((token & 15) == 15) {
+            int more;
+            do {
+                if (ip >= n) return -1;
+                more = in[ip++];
+                length += more;
+            } while (more == 255);
+        }
+        if (length > capacity - op) return -1;
+        // Byte by byte: the match may overlap the bytes it produces
+        const unsigned char *from = out + op - offset;
+        for (int k = 0; k < length; k++) out[op + k] = from[k];
+        op += length;
+    }
+    return op;
+}
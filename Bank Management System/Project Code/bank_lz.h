@@ -0,0 +1,26 @@
+#ifndef BANK_LZ_H
+#define BANK_LZ_H
+
+// Small LZ77 block compressor for the ledger archive (bank_archive.c). The format follows LZ4
+// blocks: each sequence is a token byte (literal count in the high nibble, match length - 4 in
+// the low one, 15 meaning more length bytes follow), the literals, and a 2-byte little-endian
+// match offset; the last sequence has literals only. Fast to decode, modest ratio - the archive
+// encoder does the data-specific work before this runs.
+
+// Worst-case compressed size of n bytes
+#define LZ_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compress in[0..n) into out; returns the compressed size, -1 if it does not fit in capacity
+int lzCompress(const unsigned char *in, int n, unsigned char *out, int capacity);
+// Decompress a block; returns the decompressed size, -1 if the data is malformed or does not fit
+int lzDecompress(const unsigned char *in, int n, unsigned char *out, int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,990 +1,1170 @@
-#include <stdio.h>
-#include <string.h>
-#include <stdlib.h>
-#include <time.h>
-#include "raylib.h"
-
-// Struct for account
-typedef struct {
-    char name[50];
-    char father_name[50];
-    char mobile_number[12];
-    char address[100];
-    char password[20];
-    int account_number;
-    float balance;
-} Account;
-
-// Struct for TextBox
-typedef struct {
-    Rectangle rect;
-    char text[100];
-    int active;
-    int maxLength;
-    int numericType; // 0 = any, 1 = digits only, 2 = number with decimal point
-} TextBox;
-
-// Struct for Button
-typedef struct {
-    Rectangle rect;
-    const char *text;
-    Color color;
-} Button;
-
-// Enum for states
-typedef enum {
-    MAIN_MENU,
-    CREATE_ACCOUNT,
-    LOGIN,
-    USER_MENU,
-    CHECK_BALANCE,
-    UPDATE_INFO,
-    DEPOSIT,
-    DEPOSIT_SUCCESS,
-    WITHDRAW,
-    WITHDRAW_VERIFY,
-    WITHDRAW_SUCCESS,
-    WITHDRAW_FAILED,
-    VIEW_HISTORY,
-    VIEW_INFO,
-    LOGOUT,
-    CONFIRM_DELETE
-} State;
-
-// File name
-const char *ACCOUNT_FILE = "accounts.txt";  
-
-int generateAccountNumber() {
-    static int counter =2500;
-    
-    // Try to find the highest account number in file
-    FILE *file = fopen(ACCOUNT_FILE, "r");
-    if (file) {
-        char line[300];
-        int maxNum =2500;
-        Account acc;
-        while (fgets(line, sizeof(line), file)) {
-            if (sscanf(line, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, &acc.account_number, &acc.balance) == 7) {
-                if (acc.account_number >= maxNum) {
-                    maxNum = acc.account_number + 1;
-                }
-            }
-        }
-        fclose(file);
-        counter = maxNum;
-    }
-    
-    return counter++;
-}
-
-// Helper to get current date and time in PKT (Pakistan International Time, UTC+5)
-void getCurrentDateTime(char *datetime) {
-    time_t t = time(NULL);
-    struct tm tm = *gmtime(&t);  // Get UTC time
-    // Add 5 hours for PKT
-    tm.tm_hour += 5;
-    if (tm.tm_hour >= 24) {
-        tm.tm_hour -= 24;
-        tm.tm_mday += 1;
-        // Note: This simple adjustment doesn't handle month/year rollover, but for basic use it's fine
-    }
-    sprintf(datetime, "%02d/%02d/%04d %02d:%02d:%02d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
-}
-
-// Helper to log transaction
-void logTransaction(int account_number, const char *type, float amount, float new_balance) {
-    char filename[50];
-    sprintf(filename, "transactions_%d.txt", account_number);
-    FILE *file = fopen(filename, "a");
-    if (file) {
-        char datetime[20];
-        getCurrentDateTime(datetime);
-        fprintf(file, "%s: %s %.2f, Balance: %.2f\n", datetime, type, amount, new_balance);
-        fclose(file);
-    }
-}
-
-// Global variables - declared early for use in functions
-int buttonPressed = 0;  // Debounce flag for buttons
-// Global layout helpers (set in main)
-int gSidebarRightX = 0;
-int gContentInnerX = 0;
-int gWinH = 0;
-
-// Helper function to draw rounded rectangle
-void DrawRoundedRectangle(Rectangle rec, float roundness, int segments, Color color) {
-    DrawRectangleRounded(rec, roundness, segments, color);
-}
-
-// Helper function to draw rounded button without border
-void DrawRoundedButton(Button *btn, float roundness, int segments) {
-    DrawRoundedRectangle(btn->rect, roundness, segments, btn->color);
-    // No border - clean modern look
-    int textWidth = MeasureText(btn->text, 20);
-    DrawText(btn->text, btn->rect.x + (btn->rect.width - textWidth) / 2, btn->rect.y + (btn->rect.height - 20) / 2, 20, WHITE);
-}
-
-// Draw TextBox
-void DrawTextBox(TextBox *tb) {
-    // Background changes when active for better affordance
-    Color bg = tb->active ? (Color){235, 245, 255, 255} : (Color){245, 245, 250, 255};
-    DrawRectangleRounded(tb->rect, 0.08f, 8, bg);
-    // Highlight border when active
-    Color border = tb->active ? (Color){25, 100, 200, 255} : (Color){25, 55, 109, 255};
-    DrawRectangleRoundedLines(tb->rect, 0.08f, 8, border);
-    // Vertically center the text inside the input
-    int textY = (int)(tb->rect.y + (tb->rect.height - 20) / 2);
-    DrawText(tb->text, tb->rect.x + 8, textY, 20, (Color){25, 55, 109, 255});
-    // Draw blinking caret when active
-    if (tb->active) {
-        double t = GetTime();
-        if (((int)(t * 2) % 2) == 0) { // blink ~2 times per second
-            int textW = MeasureText(tb->text, 20);
-            int cx = (int)(tb->rect.x + 8 + textW + 1);
-            int cy1 = (int)(tb->rect.y + 8);
-            int cy2 = (int)(tb->rect.y + tb->rect.height - 8);
-            DrawLine(cx, cy1, cx, cy2, border);
-        }
-    }
-}
-
-// Draw a label to the left of a TextBox, vertically centered
-void DrawLabelLeft(TextBox *tb, const char *label) {
-    int labelWidth = MeasureText(label, 20);
-    int x = (int)tb->rect.x - labelWidth - 12; // 12px padding
-    int y = (int)(tb->rect.y + (tb->rect.height - 20) / 2);
-    // If label would overlap the sidebar, draw the label above the textbox instead
-    if (gSidebarRightX > 0 && x < gSidebarRightX + 8) {
-        DrawText(label, (int)tb->rect.x, (int)tb->rect.y - 22, 18, BLACK);
-    } else {
-        DrawText(label, x, y, 20, BLACK);
-    }
-}
-
-// Draw an interactive sidebar button: hover & active states
-void DrawInteractiveButton(Button *btn, int isActive) {
-    Vector2 m = GetMousePosition();
-    int hover = CheckCollisionPointRec(m, btn->rect);
-    Color base = btn->color;
-    Color drawColor;
-    if (isActive) drawColor = (Color){15, 80, 150, 255};
-    else if (hover) drawColor = (Color){45, 110, 200, 255};
-    else drawColor = base;
-    Button tmp = *btn;
-    tmp.color = drawColor;
-    DrawRoundedButton(&tmp, 0.15f, 12);
-}
-
-// Handle TextBox input
-void HandleTextBox(TextBox *tb) {
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), tb->rect)) {
-        tb->active = 1;
-    } else if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-        tb->active = 0;
-    }
-
-    if (tb->active) {
-        int key = GetCharPressed();
-        while (key > 0) {
-            int len = strlen(tb->text);
-            if (strlen(tb->text) < (size_t)tb->maxLength) {
-                if (tb->numericType == 0) {
-                    if ((key >= 32) && (key <= 125)) {
-                        tb->text[len] = (char)key;
-                        tb->text[len + 1] = '\0';
-                    }
-                } else if (tb->numericType == 1) { // digits only
-                    if (key >= '0' && key <= '9') {
-                        tb->text[len] = (char)key;
-                        tb->text[len + 1] = '\0';
-                    }
-                } else if (tb->numericType == 2) { // number with optional single decimal point
-                    if ((key >= '0' && key <= '9')) {
-                        // allow only one decimal point
-                      
-                            tb->text[len] = (char)key;
-                            tb->text[len + 1] = '\0';
-                        
-                    }
-                }
-            }
-            key = GetCharPressed();
-        }
-
-        if (IsKeyPressed(KEY_BACKSPACE) && strlen(tb->text) > 0) {
-            tb->text[strlen(tb->text) - 1] = '\0';
-        }
-    }
-}
-
-// Draw Button
-void DrawButton(Button *btn) {
-    DrawRoundedButton(btn, 0.15f, 12);
-}
-
-// Check if button is clicked (with debounce)
-int IsButtonClicked(Button *btn) {
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), btn->rect) && !buttonPressed) {
-        buttonPressed = 1;
-        return 1;
-    }
-    if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        buttonPressed = 0;
-    }
-    return 0;
-}
-
-// Update information - allows updating user details
-void updateInformation(Account *user) {
-    FILE *file = fopen(ACCOUNT_FILE, "r");
-    FILE *tempFile = fopen("temp.txt", "w");
-    char line[300];
-    while (fgets(line, sizeof(line), file)) {
-        Account acc;
-        if (sscanf(line, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, &acc.account_number, &acc.balance) == 7) {
-            if (acc.account_number == user->account_number) {
-                fprintf(tempFile, "%s,%s,%s,%s,%s,%d,%.2f\n", user->name, user->father_name, user->mobile_number, user->address, user->password, user->account_number, user->balance);
-            } else {
-                fprintf(tempFile, "%s", line);
-            }
-        }
-    }
-    fclose(file);
-    fclose(tempFile);
-    remove(ACCOUNT_FILE);
-    rename("temp.txt", ACCOUNT_FILE);
-}
-
-// Delete account - removes user account
-void deleteAccount(Account *user) {
-    FILE *file = fopen(ACCOUNT_FILE, "r");
-    FILE *tempFile = fopen("temp.txt", "w");
-    char line[300];
-    while (fgets(line, sizeof(line), file)) {
-        Account acc;
-        if (sscanf(line, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, &acc.account_number, &acc.balance) == 7) {
-            if (acc.account_number != user->account_number) {
-                fprintf(tempFile, "%s", line);
-            }
-        }
-    }
-    fclose(file);
-    fclose(tempFile);
-    remove(ACCOUNT_FILE);
-    rename("temp.txt", ACCOUNT_FILE);
-
-    char filename[50];
-    sprintf(filename, "transactions_%d.txt", user->account_number);
-    remove(filename);
-}
-
-// Deposit money - adds money to balance
-void depositMoney(Account *user) {
-    FILE *file = fopen(ACCOUNT_FILE, "r");
-    FILE *tempFile = fopen("temp.txt", "w");
-    char line[300];
-    while (fgets(line, sizeof(line), file)) {
-        Account acc;
-        if (sscanf(line, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, &acc.account_number, &acc.balance) == 7) {
-            if (acc.account_number == user->account_number) {
-                fprintf(tempFile, "%s,%s,%s,%s,%s,%d,%.2f\n", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, acc.account_number, user->balance);
-            } else {
-                fprintf(tempFile, "%s", line);
-            }
-        }
-    }
-    fclose(file);
-    fclose(tempFile);
-    remove(ACCOUNT_FILE);
-    rename("temp.txt", ACCOUNT_FILE);
-}
-
-// Withdraw money - subtracts money from balance
-void withdrawMoney(Account *user) {
-    FILE *file = fopen(ACCOUNT_FILE, "r");
-    FILE *tempFile = fopen("temp.txt", "w");
-    char line[300];
-    while (fgets(line, sizeof(line), file)) {
-        Account acc;
-        if (sscanf(line, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, &acc.account_number, &acc.balance) == 7) {
-            if (acc.account_number == user->account_number) {
-                fprintf(tempFile, "%s,%s,%s,%s,%s,%d,%.2f\n", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, acc.account_number, user->balance);
-            } else {
-                fprintf(tempFile, "%s", line);
-            }
-        }
-    }
-    fclose(file);
-    fclose(tempFile);
-    remove(ACCOUNT_FILE);
-    rename("temp.txt", ACCOUNT_FILE);
-}
-
-// Global variables
-State currentState = MAIN_MENU;
-Account currentUser;
-char message[200] = "";
-int messageTimer = 0;
-int accountCreatedSuccessfully = 0;  // Flag to show login button after account creation
-float pendingWithdrawAmount = 0.0f;
-int withdrawQuestionIndex = -1;
-float depositSuccessAmount = 0.0f;
-int depositSuccessTimer = 0;
-float withdrawSuccessAmount = 0.0f;
-int withdrawSuccessTimer = 0;
-int withdrawFailedTimer = 0;
-int logoutTimer = 0;
-
-// Main function
-int main() {
-    int winW = 1200;
-    int winH = 720;
-    InitWindow(winW, winH, "Bank Management System");
-    SetTargetFPS(60);
-    srand((unsigned)time(NULL));
-
-    // Sidebar and content layout
-    int sidebarX = 20;
-    int sidebarY = 40;
-    int sidebarW = 320;
-    int sidebarH = winH - 2*sidebarY;
-    int contentX = sidebarX + sidebarW + 20;
-    int contentInnerX = contentX + 20;
-    int contentW = winW - contentX - 20;
-
-    // set globals for helpers used in drawing functions
-    gSidebarRightX = sidebarX + sidebarW;
-    gContentInnerX = contentInnerX;
-    gWinH = winH;
-
-    // Define UI elements with professional banking colors (rects set below for sidebar/content layout)
-    Button btnCreate = {{0,0,0,0}, "Create Account", (Color){25, 55, 109, 255}};
-    Button btnLogin = {{0,0,0,0}, "Login", (Color){25, 55, 109, 255}};
-    Button btnExit = {{0,0,0,0}, "Exit", (Color){191, 144, 0, 255}};
-
-    Button btnSubmitCreate = {{0,0,0,0}, "Submit", (Color){25, 55, 109, 255}};
-    TextBox tbName = {{0,0,0,0}, "", 0, 49, 0};
-    TextBox tbFatherName = {{0,0,0,0}, "", 0, 49, 0};
-    TextBox tbMobile = {{0,0,0,0}, "", 0, 11, 1};
-    TextBox tbAddress = {{0,0,0,0}, "", 0, 99, 0};
-    TextBox tbPassword = {{0,0,0,0}, "", 0, 19, 0};
-
-    Button btnSubmitLogin = {{0,0,0,0}, "Login", (Color){25, 55, 109, 255}};
-    TextBox tbLoginMobile = {{0,0,0,0}, "", 0, 11, 1};
-    TextBox tbLoginPassword = {{0,0,0,0}, "", 0, 19, 0};
-    
-    // Confirm delete UI elements
-    Button btnConfirmDelete = {{0,0,0,0}, "Confirm Delete", (Color){200, 50, 50, 255}};
-    Button btnCancelDelete = {{0,0,0,0}, "Cancel", (Color){100,100,100,255}};
-    TextBox tbConfirmPassword = {{0,0,0,0}, "", 0, 19, 0};
-
-    Button btnCheckBalance = {{0,0,0,0}, "Check Balance", (Color){25, 55, 109, 255}};
-    Button btnUpdateInfo = {{0,0,0,0}, "Update Info", (Color){191, 144, 0, 255}};
-    Button btnViewInfo = {{0,0,0,0}, "View Info", (Color){25, 100, 100, 255}};
-    Button btnDeposit = {{0,0,0,0}, "Deposit", (Color){25, 55, 109, 255}};
-    Button btnWithdraw = {{0,0,0,0}, "Withdraw", (Color){25, 55, 109, 255}};
-    Button btnViewHistory = {{0,0,0,0}, "View History", (Color){191, 144, 0, 255}};
-    Button btnDelete = {{0,0,0,0}, "Delete Account", (Color){200, 50, 50, 255}};
-    Button btnLogout = {{0,0,0,0}, "Logout", (Color){100, 100, 100, 255}};
-
-    Button btnSubmitUpdate = {{0,0,0,0}, "Update", (Color){191, 144, 0, 255}};
-    TextBox tbUpdateName = {{0,0,0,0}, "", 0, 49, 0};
-    TextBox tbUpdateFather = {{0,0,0,0}, "", 0, 49, 0};
-    TextBox tbUpdateAddress = {{0,0,0,0}, "", 0, 99, 0};
-    TextBox tbUpdatePassword = {{0,0,0,0}, "", 0, 19, 0};
-
-    Button btnSubmitDeposit = {{0,0,0,0}, "Deposit", (Color){25, 55, 109, 255}};
-    TextBox tbDepositAmount = {{0,0,0,0}, "", 0, 10, 2};
-
-    Button btnSubmitWithdraw = {{0,0,0,0}, "Withdraw", (Color){25, 55, 109, 255}};
-    TextBox tbWithdrawAmount = {{0,0,0,0}, "", 0, 10, 2};
-
-    Button btnVerifyWithdraw = {{0,0,0,0}, "Verify", (Color){25, 55, 109, 255}};
-    Button btnCancelVerify = {{0,0,0,0}, "Cancel", (Color){100,100,100,255}};
-    TextBox tbWithdrawSecurity = {{0,0,0,0}, "", 0, 50, 0};
-
-    // Compute positions for sidebar buttons and content fields
-    int sbBtnW = sidebarW - 40;
-    int sbBtnH = 50;
-    int sbBtnX = sidebarX + 20;
-    int sbBtnY = sidebarY + 80; // increased top padding so buttons sit clearly below header
-    int sbSpacing = 14;
-
-    // Main menu sidebar buttons
-    btnCreate.rect.x = sbBtnX; btnCreate.rect.y = sbBtnY; btnCreate.rect.width = sbBtnW; btnCreate.rect.height = sbBtnH;
-    btnLogin.rect.x = sbBtnX; btnLogin.rect.y = sbBtnY + (sbBtnH + sbSpacing); btnLogin.rect.width = sbBtnW; btnLogin.rect.height = sbBtnH;
-    btnExit.rect.x = sbBtnX; btnExit.rect.y = sbBtnY + 2*(sbBtnH + sbSpacing); btnExit.rect.width = sbBtnW; btnExit.rect.height = sbBtnH;
-
-    // User menu sidebar buttons (stacked) - compute start Y so the group fits inside the sidebar
-    int nUserBtns = 8;
-    int totalUserHeight = nUserBtns * sbBtnH + (nUserBtns - 1) * sbSpacing;
-    int userStartY = sidebarY + (sidebarH - totalUserHeight) / 2; // center vertically in sidebar
-    btnCheckBalance.rect.x = sbBtnX; btnCheckBalance.rect.y = userStartY; btnCheckBalance.rect.width = sbBtnW; btnCheckBalance.rect.height = sbBtnH;
-    btnUpdateInfo.rect.x = sbBtnX; btnUpdateInfo.rect.y = userStartY + (sbBtnH + sbSpacing); btnUpdateInfo.rect.width = sbBtnW; btnUpdateInfo.rect.height = sbBtnH;
-    btnViewInfo.rect.x = sbBtnX; btnViewInfo.rect.y = userStartY + 2*(sbBtnH + sbSpacing); btnViewInfo.rect.width = sbBtnW; btnViewInfo.rect.height = sbBtnH;
-    btnDeposit.rect.x = sbBtnX; btnDeposit.rect.y = userStartY + 3*(sbBtnH + sbSpacing); btnDeposit.rect.width = sbBtnW; btnDeposit.rect.height = sbBtnH;
-    btnWithdraw.rect.x = sbBtnX; btnWithdraw.rect.y = userStartY + 4*(sbBtnH + sbSpacing); btnWithdraw.rect.width = sbBtnW; btnWithdraw.rect.height = sbBtnH;
-    btnViewHistory.rect.x = sbBtnX; btnViewHistory.rect.y = userStartY + 5*(sbBtnH + sbSpacing); btnViewHistory.rect.width = sbBtnW; btnViewHistory.rect.height = sbBtnH;
-    btnDelete.rect.x = sbBtnX; btnDelete.rect.y = userStartY + 6*(sbBtnH + sbSpacing); btnDelete.rect.width = sbBtnW; btnDelete.rect.height = sbBtnH;
-    btnLogout.rect.x = sbBtnX; btnLogout.rect.y = userStartY + 7*(sbBtnH + sbSpacing); btnLogout.rect.width = sbBtnW; btnLogout.rect.height = sbBtnH;
-
-    // Confirm/cancel and action buttons placed in content area
-    btnSubmitCreate.rect = (Rectangle){contentInnerX + 40, 480, 240, 56};
-    btnSubmitLogin.rect = (Rectangle){contentInnerX + 40, 360, 240, 56};
-    btnConfirmDelete.rect = (Rectangle){contentInnerX + 20, 300, 280, 56};
-    btnCancelDelete.rect = (Rectangle){contentInnerX + 320, 300, 100, 56};
-    btnSubmitUpdate.rect = (Rectangle){contentInnerX + 40, 420, 200, 50};
-    btnSubmitDeposit.rect = (Rectangle){contentInnerX + 40, 230, 200, 50};
-    btnSubmitWithdraw.rect = (Rectangle){contentInnerX + 40, 230, 200, 50};
-    btnVerifyWithdraw.rect = (Rectangle){contentInnerX + 40, 230, 140, 50};
-    btnCancelVerify.rect = (Rectangle){contentInnerX + 220, 230, 140, 50};
-
-    // TextBoxes in content area (common x and widths)
-    int inputX = contentInnerX + 20;
-    int inputW = contentW - 60;
-
-    tbName.rect = (Rectangle){inputX, 110, inputW, 44};
-    tbFatherName.rect = (Rectangle){inputX, 174, inputW, 44};
-    tbMobile.rect = (Rectangle){inputX, 238, inputW, 44};
-    tbAddress.rect = (Rectangle){inputX, 302, inputW, 44};
-    tbPassword.rect = (Rectangle){inputX, 366, inputW, 44};
-
-    tbLoginMobile.rect = (Rectangle){inputX, 170, inputW, 44};
-    tbLoginPassword.rect = (Rectangle){inputX, 236, inputW, 44};
-
-    tbConfirmPassword.rect = (Rectangle){inputX, 240, inputW, 44};
-
-    tbUpdateName.rect = (Rectangle){inputX, 100, inputW - 60, 30};
-    tbUpdateFather.rect = (Rectangle){inputX, 150, inputW - 60, 30};
-    tbUpdateAddress.rect = (Rectangle){inputX, 200, inputW - 60, 30};
-    tbUpdatePassword.rect = (Rectangle){inputX, 250, inputW - 60, 30};
-
-    tbDepositAmount.rect = (Rectangle){inputX, 150, inputW - 60, 30};
-    tbWithdrawAmount.rect = (Rectangle){inputX, 150, inputW - 60, 30};
-    tbWithdrawSecurity.rect = (Rectangle){inputX, 180, inputW, 44};
-
-    while (!WindowShouldClose()) {
-        BeginDrawing();
-        ClearBackground((Color){255, 255, 255, 255});
-
-            // Draw left sidebar background and header
-            DrawRectangleRounded((Rectangle){sidebarX, sidebarY, sidebarW, sidebarH}, 0.08f, 8, (Color){245,245,250,255});
-            DrawRectangleRoundedLines((Rectangle){sidebarX, sidebarY, sidebarW, sidebarH}, 0.08f, 8, (Color){200,200,210,255});
-            DrawText("Bank System", sidebarX + 20, sidebarY + 12, 20, (Color){25,55,109,255});
-            // Small subtitle or user info
-            if (currentState >= USER_MENU && currentState != LOGOUT && strlen(currentUser.name) > 0) {
-                char userInfo[60];
-                sprintf(userInfo, "%s", currentUser.name);
-                DrawText(userInfo, sidebarX + 20, sidebarY + 36, 14, (Color){80,80,90,255});
-            }
-
-            // Static sidebar: choose which set to show based on whether a user is logged in
-            if (currentUser.account_number == 0) {
-                // Not logged in: show primary navigation on main screen and while filling Create/Login forms
-                if (currentState == MAIN_MENU || currentState == CREATE_ACCOUNT || currentState == LOGIN) {
-                    DrawInteractiveButton(&btnCreate, currentState == CREATE_ACCOUNT);
-                    DrawInteractiveButton(&btnLogin, currentState == LOGIN);
-                    DrawInteractiveButton(&btnExit, 0);
-
-                    if (IsButtonClicked(&btnCreate)) {
-                        currentState = CREATE_ACCOUNT;
-                        strcpy(message, "");
-                    } else if (IsButtonClicked(&btnLogin)) {
-                        currentState = LOGIN;
-                        strcpy(message, "");
-                    } else if (IsButtonClicked(&btnExit)) {
-                        CloseWindow();
-                        return 0;
-                    }
-                }
-            } else {
-                // Logged-in sidebar (static across user screens)
-                DrawInteractiveButton(&btnCheckBalance, currentState == CHECK_BALANCE);
-                DrawInteractiveButton(&btnUpdateInfo, currentState == UPDATE_INFO);
-                DrawInteractiveButton(&btnViewInfo, currentState == VIEW_INFO);
-                DrawInteractiveButton(&btnDeposit, currentState == DEPOSIT);
-                DrawInteractiveButton(&btnWithdraw, currentState == WITHDRAW || currentState == WITHDRAW_VERIFY);
-                DrawInteractiveButton(&btnViewHistory, currentState == VIEW_HISTORY);
-                DrawInteractiveButton(&btnDelete, currentState == CONFIRM_DELETE);
-                DrawInteractiveButton(&btnLogout, currentState == LOGOUT);
-
-                if (IsButtonClicked(&btnCheckBalance)) {
-                    currentState = CHECK_BALANCE;
-                } else if (IsButtonClicked(&btnUpdateInfo)) {
-                    currentState = UPDATE_INFO;
-                    strcpy(tbUpdateName.text, currentUser.name);
-                    strcpy(tbUpdateFather.text, currentUser.father_name);
-                    strcpy(tbUpdateAddress.text, currentUser.address);
-                    strcpy(tbUpdatePassword.text, currentUser.password);
-                } else if (IsButtonClicked(&btnViewInfo)) {
-                    currentState = VIEW_INFO;
-                } else if (IsButtonClicked(&btnDeposit)) {
-                    currentState = DEPOSIT;
-                } else if (IsButtonClicked(&btnWithdraw)) {
-                    currentState = WITHDRAW;
-                } else if (IsButtonClicked(&btnViewHistory)) {
-                    currentState = VIEW_HISTORY;
-                } else if (IsButtonClicked(&btnDelete)) {
-                    currentState = CONFIRM_DELETE;
-                    strcpy(tbConfirmPassword.text, "");
-                } else if (IsButtonClicked(&btnLogout)) {
-                    logoutTimer = 240;
-                    currentState = LOGOUT;
-                }
-            }
-
-        Button btnBack;
-        switch (currentState) {
-            case MAIN_MENU:
-                DrawText("Bank Management System", contentInnerX + 40, 100, 30, BLACK);
-                break;
-
-            case CREATE_ACCOUNT:
-                DrawText("Create New Account", contentInnerX + 40, 50, 25, BLACK);
-                
-                if (!accountCreatedSuccessfully) {
-                    // Show form for creating account
-                    // Draw labels above the input fields to avoid overlap
-                    DrawLabelLeft(&tbName, "Name:");
-                    DrawTextBox(&tbName);
-                    DrawLabelLeft(&tbFatherName, "Father's Name:");
-                    DrawTextBox(&tbFatherName);
-                    DrawLabelLeft(&tbMobile, "Mobile (11 digits):");
-                    DrawTextBox(&tbMobile);
-                    DrawLabelLeft(&tbAddress, "Address:");
-                    DrawTextBox(&tbAddress);
-                    DrawLabelLeft(&tbPassword, "Password:");
-                    DrawTextBox(&tbPassword);
-                    DrawButton(&btnSubmitCreate);
-
-                    HandleTextBox(&tbName);
-                    HandleTextBox(&tbFatherName);
-                    HandleTextBox(&tbMobile);
-                    HandleTextBox(&tbAddress);
-                    HandleTextBox(&tbPassword);
-
-                    if (IsButtonClicked(&btnSubmitCreate)) {
-                        if (strlen(tbName.text) == 0 || strlen(tbFatherName.text) == 0 || strlen(tbMobile.text) != 11 || strlen(tbAddress.text) == 0 || strlen(tbPassword.text) == 0) {
-                            strcpy(message, "All fields must be filled correctly!");
-                            messageTimer = 180;  // 3 seconds at 60 FPS
-                        } else {
-                            // Check if mobile number already exists
-                            int mobileExists = 0;
-                            FILE *fileCheck = fopen(ACCOUNT_FILE, "r");
-                            if (fileCheck) {
-                                char lineChk[300];
-                                Account tempAcc;
-                                while (fgets(lineChk, sizeof(lineChk), fileCheck)) {
-                                    if (sscanf(lineChk, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", tempAcc.name, tempAcc.father_name, tempAcc.mobile_number, tempAcc.address, tempAcc.password, &tempAcc.account_number, &tempAcc.balance) == 7) {
-                                        if (strcmp(tempAcc.mobile_number, tbMobile.text) == 0) {
-                                            mobileExists = 1;
-                                            break;
-                                        }
-                                    }
-                                }
-                                fclose(fileCheck);
-                            }
-
-                            if (mobileExists) {
-                                strcpy(message, "Mobile number already exists!");
-                                messageTimer = 180;
-                            } else {
-                                Account acc;
-                                strcpy(acc.name, tbName.text);
-                                strcpy(acc.father_name, tbFatherName.text);
-                                strcpy(acc.mobile_number, tbMobile.text);
-                                strcpy(acc.address, tbAddress.text);
-                                strcpy(acc.password, tbPassword.text);
-
-                                acc.account_number = generateAccountNumber();
-                                acc.balance = 0.0;
-
-                                FILE *file = fopen(ACCOUNT_FILE, "a");
-                                if (file) {
-                                    fprintf(file, "%s,%s,%s,%s,%s,%d,%.2f\n", acc.name, acc.father_name, acc.mobile_number, acc.address, acc.password, acc.account_number, acc.balance);
-                                    fclose(file);
-                                    sprintf(message, "Account created! Number: %d", acc.account_number);
-                                    messageTimer = 180;
-                                    // Clear text boxes
-                                    strcpy(tbName.text, "");
-                                    strcpy(tbFatherName.text, "");
-                                    strcpy(tbMobile.text, "");
-                                    strcpy(tbAddress.text, "");
-                                    strcpy(tbPassword.text, "");
-                                    accountCreatedSuccessfully = 1;  // Set flag to show login button
-                                } else {
-                                    strcpy(message, "Unable to save account!");
-                                    messageTimer = 180;
-                                }
-                            }
-                        }
-                    }
-                } else {
-                    // Show message and login button after account created
-                    DrawText(message, gContentInnerX, 180, 20, (Color){25, 55, 109, 255});
-                    DrawText("Click Login to continue", gContentInnerX, 250, 18, BLACK);
-                    Button btnGoToLogin = {{gContentInnerX, 330, 240, 60}, "Go to Login", (Color){25, 55, 109, 255}};
-                    DrawButton(&btnGoToLogin);
-                    
-                    if (IsButtonClicked(&btnGoToLogin)) {
-                        currentState = LOGIN;
-                        accountCreatedSuccessfully = 0;  // Reset flag
-                        strcpy(message, "");
-                        strcpy(tbLoginMobile.text, "");
-                        strcpy(tbLoginPassword.text, "");
-                    }
-                }
-                break;
-
-            case LOGIN:
-                DrawText("Login", contentInnerX + 40, 100, 25, BLACK);
-                // Draw labels to the left of the input fields (same-line)
-                DrawLabelLeft(&tbLoginMobile, "Mobile:");
-                DrawTextBox(&tbLoginMobile);
-                DrawLabelLeft(&tbLoginPassword, "Password:");
-                DrawTextBox(&tbLoginPassword);
-                DrawButton(&btnSubmitLogin);
-
-                HandleTextBox(&tbLoginMobile);
-                HandleTextBox(&tbLoginPassword);
-
-                if (IsButtonClicked(&btnSubmitLogin)) {
-                    FILE *file = fopen(ACCOUNT_FILE, "r");
-                    if (!file) {
-                        strcpy(message, "No accounts found!");
-                        messageTimer = 180;
-                    } else {
-                        char line[300];
-                        int found = 0;
-                        while (fgets(line, sizeof(line), file)) {
-                            if (sscanf(line, "%49[^,],%49[^,],%11[^,],%99[^,],%19[^,],%d,%f", currentUser.name, currentUser.father_name, currentUser.mobile_number, currentUser.address, currentUser.password, &currentUser.account_number, &currentUser.balance) == 7) {
-                                if (strcmp(currentUser.mobile_number, tbLoginMobile.text) == 0 && strcmp(currentUser.password, tbLoginPassword.text) == 0) {
-                                    found = 1;
-                                    break;
-                                }
-                            }
-                        }
-                        fclose(file);
-                        if (found) {
-                            currentState = USER_MENU;
-                            strcpy(message, "");
-                            strcpy(tbLoginMobile.text, "");
-                            strcpy(tbLoginPassword.text, "");
-                        } else {
-                            strcpy(message, "Invalid credentials!");
-                            messageTimer = 180;
-                        }
-                    }
-                }
-                break;
-
-            case USER_MENU:
-              
-                break;
-
-            case CHECK_BALANCE:
-                DrawText("Check Balance", contentInnerX + 40, 100, 25, BLACK);
-                char balanceStr[50];
-                sprintf(balanceStr, "Balance: %.2f", currentUser.balance);
-                DrawText(balanceStr, contentInnerX + 40, 200, 20, BLACK);
-                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 300; btnBack.rect.width = 100; btnBack.rect.height = 40;
-                btnBack.text = "Back"; btnBack.color = GRAY;
-                DrawButton(&btnBack);
-                if (IsButtonClicked(&btnBack)) {
-                    currentState = USER_MENU;
-                }
-                break;
-
-            case UPDATE_INFO:
-                DrawText("Update Information", contentInnerX + 40, 50, 25, BLACK);
-                DrawLabelLeft(&tbUpdateName, "Name:");
-                DrawTextBox(&tbUpdateName);
-                DrawLabelLeft(&tbUpdateFather, "Father's Name:");
-                DrawTextBox(&tbUpdateFather);
-                DrawLabelLeft(&tbUpdateAddress, "Address:");
-                DrawTextBox(&tbUpdateAddress);
-                DrawLabelLeft(&tbUpdatePassword, "Password:");
-                DrawTextBox(&tbUpdatePassword);
-                DrawButton(&btnSubmitUpdate);
-                HandleTextBox(&tbUpdateName);
-                HandleTextBox(&tbUpdateFather);
-                HandleTextBox(&tbUpdateAddress);
-                HandleTextBox(&tbUpdatePassword);
-                if (IsButtonClicked(&btnSubmitUpdate)) {
-                    strcpy(currentUser.name, tbUpdateName.text);
-                    strcpy(currentUser.father_name, tbUpdateFather.text);
-                    strcpy(currentUser.address, tbUpdateAddress.text);
-                    strcpy(currentUser.password, tbUpdatePassword.text);
-                    updateInformation(&currentUser);
-                    currentState = USER_MENU;
-                }
-                break;
-            case DEPOSIT:
-                DrawText("Deposit Money", contentInnerX + 40, 50, 25, BLACK);
-                DrawLabelLeft(&tbDepositAmount, "Amount:");
-                DrawTextBox(&tbDepositAmount);
-                DrawButton(&btnSubmitDeposit);
-                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 310; btnBack.rect.width = 100; btnBack.rect.height = 40;
-                btnBack.text = "Back"; btnBack.color = GRAY;
-                DrawButton(&btnBack);
-                HandleTextBox(&tbDepositAmount);
-                if (IsButtonClicked(&btnSubmitDeposit)) {
-                    float amount = atof(tbDepositAmount.text);
-                    if (amount > 0) {
-                        currentUser.balance += amount;
-                        depositMoney(&currentUser);
-                        logTransaction(currentUser.account_number, "Deposit", amount, currentUser.balance);
-                        depositSuccessAmount = amount;
-                        depositSuccessTimer = 240;  // 4 seconds at 60 FPS
-                        strcpy(tbDepositAmount.text, "");
-                        currentState = DEPOSIT_SUCCESS;
-                    } else {
-                        strcpy(message, "Enter a valid amount!");
-                        messageTimer = 120;
-                    }
-                }
-                if (IsButtonClicked(&btnBack)) {
-                    currentState = USER_MENU;
-                    strcpy(tbDepositAmount.text, "");
-                }
-                break;
-            case DEPOSIT_SUCCESS:
-                DrawText("Deposit Successful", contentInnerX + 40, 100, 30, BLACK);
-                char depositMsg[100];
-                sprintf(depositMsg, "Amount %.2f submitted successfully!", depositSuccessAmount);
-                DrawText(depositMsg, contentInnerX + 40, 200, 20, (Color){0, 128, 0, 255});
-                DrawText("Returning to menu...", contentInnerX + 40, 300, 18, GRAY);
-                depositSuccessTimer--;
-                if (depositSuccessTimer <= 0) {
-                    currentState = USER_MENU;
-                    depositSuccessAmount = 0.0f;
-                }
-                break;
-            case WITHDRAW:
-                DrawText("Withdraw Money", contentInnerX + 40, 50, 25, BLACK);
-                if (currentUser.balance <= 0.0f) {
-                    DrawText("No funds available in this account.", contentInnerX + 40, 200, 20, RED);
-                    btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 300; btnBack.rect.width = 100; btnBack.rect.height = 40;
-                    btnBack.text = "Back"; btnBack.color = GRAY;
-                    DrawButton(&btnBack);
-                    if (IsButtonClicked(&btnBack)) {
-                        currentState = USER_MENU;
-                    }
-                } else {
-                    DrawLabelLeft(&tbWithdrawAmount, "Amount:");
-                    DrawTextBox(&tbWithdrawAmount);
-                    DrawButton(&btnSubmitWithdraw);
-                    btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 310; btnBack.rect.width = 100; btnBack.rect.height = 40;
-                    btnBack.text = "Back"; btnBack.color = GRAY;
-                    DrawButton(&btnBack);
-                    HandleTextBox(&tbWithdrawAmount);
-                    if (IsButtonClicked(&btnSubmitWithdraw)) {
-                        float amount = atof(tbWithdrawAmount.text);
-                        if (amount > 0 && amount <= currentUser.balance) {
-                            if (amount > 50000.0f) {
-                                // Require security question verification for withdrawals > 50000
-                                pendingWithdrawAmount = amount;
-                                withdrawQuestionIndex = rand() % 4;
-                                strcpy(tbWithdrawSecurity.text, "");
-                                currentState = WITHDRAW_VERIFY;
-                            } else {
-                                currentUser.balance -= amount;
-                                withdrawMoney(&currentUser);
-                                logTransaction(currentUser.account_number, "Withdraw", amount, currentUser.balance);
-                                withdrawSuccessAmount = amount;
-                                withdrawSuccessTimer = 120;  
-                                strcpy(tbWithdrawAmount.text, "");
-                                currentState = WITHDRAW_SUCCESS;
-                            }
-                        } else {
-                            strcpy(message, "Insufficient amount! please enter a valid amount.");
-                            messageTimer = 120;
-                        }
-                    }
-                    if (IsButtonClicked(&btnBack)) {
-                        currentState = USER_MENU;
-                        strcpy(tbWithdrawAmount.text, "");
-                    }
-                }
-                break;
-            case WITHDRAW_VERIFY:
-                DrawText("Verify Withdrawal", contentInnerX + 40, 50, 25, BLACK);
-                {
-                    char qbuf[200];
-                    char expected[100];
-                    switch (withdrawQuestionIndex) {
-                        case 0:
-                            sprintf(qbuf, "What is your father's name?");
-                            strcpy(expected, currentUser.father_name);
-                            break;
-                        case 1:
-                            sprintf(qbuf, "What is your registered mobile number?");
-                            strcpy(expected, currentUser.mobile_number);
-                            break;
-                        case 2:
-                            sprintf(qbuf, "What is your address?");
-                            strcpy(expected, currentUser.address);
-                            break;
-                        case 3:
-                            sprintf(qbuf, "What is your account number?");
-                            sprintf(expected, "%d", currentUser.account_number);
-                            break;
-                        default:
-                            sprintf(qbuf, "Security question:");
-                            expected[0] = '\0';
-                            break;
-                    }
-                    DrawText(qbuf, contentInnerX + 10, 120, 20, BLACK);
-                    DrawLabelLeft(&tbWithdrawSecurity, "Answer:");
-                    DrawTextBox(&tbWithdrawSecurity);
-                    DrawButton(&btnVerifyWithdraw);
-                    DrawButton(&btnCancelVerify);
-                    HandleTextBox(&tbWithdrawSecurity);
-
-                    if (IsButtonClicked(&btnVerifyWithdraw)) {
-                        if (strcmp(tbWithdrawSecurity.text, expected) == 0) {
-                            float amount = pendingWithdrawAmount;
-                            currentUser.balance -= amount;
-                            withdrawMoney(&currentUser);
-                            logTransaction(currentUser.account_number, "Withdraw", amount, currentUser.balance);
-                            strcpy(tbWithdrawAmount.text, "");
-                            withdrawSuccessAmount = amount;
-                            withdrawSuccessTimer = 120;  // 4 seconds at 60 FPS
-                            pendingWithdrawAmount = 0.0f;
-                            withdrawQuestionIndex = -1;
-                            strcpy(tbWithdrawSecurity.text, "");
-                            currentState = WITHDRAW_SUCCESS;
-                        } else {
-                            withdrawFailedTimer = 120;  // 4 seconds at 60 FPS
-                            currentState = WITHDRAW_FAILED;
-                            strcpy(tbWithdrawSecurity.text, "");
-                        }
-                    }
-                    if (IsButtonClicked(&btnCancelVerify)) {
-                        currentState = LOGOUT;
-                    }
-                }
-                break;
-            case WITHDRAW_FAILED:
-                DrawText("Withdrawal Failed", contentInnerX + 40, 100, 30, BLACK);
-                DrawText("Incorrect answer!", contentInnerX + 40, 200, 24, RED);
-                DrawText("Withdrawal cancelled.", contentInnerX + 40, 260, 20, BLACK);
-//                DrawText("Returning to menu...", contentInnerX + 40, 340, 18, GRAY);
-                withdrawFailedTimer--;
-                if (withdrawFailedTimer <= 0) {
-                    currentState = LOGOUT;
-                    pendingWithdrawAmount = 0.0f;
-                    withdrawQuestionIndex = -1;
-                }
-                break;
-            case WITHDRAW_SUCCESS:
-                DrawText("Withdrawal Successful", contentInnerX + 40, 100, 30, BLACK);
-                char withdrawMsg[100];
-                sprintf(withdrawMsg, "Amount %.2f withdrawn successfully!", withdrawSuccessAmount);
-                DrawText(withdrawMsg, contentInnerX + 40, 200, 20, (Color){0, 128, 0, 255});
-                DrawText("Returning to menu...", contentInnerX + 40, 300, 18, GRAY);
-                withdrawSuccessTimer--;
-                if (withdrawSuccessTimer <= 0) {
-                    currentState = USER_MENU;
-                    withdrawSuccessAmount = 0.0f;
-                }
-                break;
-            case VIEW_HISTORY:
-                DrawText("Transaction History", contentInnerX + 40, 50, 25, BLACK);
-                {
-                    char filename[50];
-                    sprintf(filename, "transactions_%d.txt", currentUser.account_number);
-                    FILE *file = fopen(filename, "r");
-                    if (file) {
-                            char line[200];
-                            int y = 100;
-                            // Increased font size for better readability
-                            while (fgets(line, sizeof(line), file) && y < 550) {
-                                DrawText(line, contentInnerX + 10, y, 20, BLACK);
-                                y += 28;
-                            }
-                            fclose(file);
-                        } else {
-                            DrawText("No transactions found.", contentInnerX + 40, 200, 20, BLACK);
-                        }
-                }
-                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 500; btnBack.rect.width = 100; btnBack.rect.height = 40;
-                btnBack.text = "Back"; btnBack.color = GRAY;
-                DrawButton(&btnBack);
-
-                if (IsButtonClicked(&btnBack)) {
-                    currentState = USER_MENU;
-                }
-                break;
-            case VIEW_INFO:
-                DrawText("Account Information", gContentInnerX, 50, 26, BLACK);
-                // Display user fields
-                DrawText("Name:", gContentInnerX, 110, 20, BLACK);
-                DrawText(currentUser.name, gContentInnerX + 160, 110, 20, (Color){25,55,109,255});
-                DrawText("Father's Name:", gContentInnerX, 150, 20, BLACK);
-                DrawText(currentUser.father_name, gContentInnerX + 160, 150, 20, (Color){25,55,109,255});
-                DrawText("Mobile:", gContentInnerX, 190, 20, BLACK);
-                DrawText(currentUser.mobile_number, gContentInnerX + 160, 190, 20, (Color){25,55,109,255});
-                DrawText("Address:", gContentInnerX, 230, 20, BLACK);
-                DrawText(currentUser.address, gContentInnerX + 160, 230, 20, (Color){25,55,109,255});
-                DrawText("Password:", gContentInnerX, 270, 20, BLACK);
-                DrawText(currentUser.password, gContentInnerX + 160, 270, 20, (Color){25,55,109,255});
-                DrawText("Account No:", gContentInnerX, 310, 20, BLACK);
-                char accBuf[32]; sprintf(accBuf, "%d", currentUser.account_number);
-                DrawText(accBuf, gContentInnerX + 160, 310, 20, (Color){25,55,109,255});
-                DrawText("Balance:", gContentInnerX, 350, 20, BLACK);
-                char balBuf[32]; sprintf(balBuf, "%.2f", currentUser.balance);
-                DrawText(balBuf, gContentInnerX + 160, 350, 20, (Color){25,55,109,255});
-                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 420; btnBack.rect.width = 100; btnBack.rect.height = 40;
-                btnBack.text = "Back"; btnBack.color = GRAY;
-                DrawButton(&btnBack);
-                if (IsButtonClicked(&btnBack)) {
-                    currentState = USER_MENU;
-                }
-                break;
-            case LOGOUT:
-                DrawText("Thank You!", contentInnerX + 40, 150, 40, (Color){25, 55, 109, 255});
-                DrawText("Thanks for visiting our bank", contentInnerX + 40, 250, 24, BLACK);
-                DrawText("Returning to main menu...", contentInnerX + 40, 340, 18, GRAY);
-                logoutTimer--;
-                if (logoutTimer <= 0) {
-                    // clear current user on logout so sidebar returns to main nav
-                    memset(&currentUser, 0, sizeof(currentUser));
-                    currentState = MAIN_MENU;
-                }
-                break;
-            case CONFIRM_DELETE:
-                DrawText("Confirm Delete", contentInnerX + 40, 180, 25, BLACK);
-                DrawLabelLeft(&tbConfirmPassword, "Password:");
-                DrawTextBox(&tbConfirmPassword);
-                DrawButton(&btnConfirmDelete);
-                DrawButton(&btnCancelDelete);
-                HandleTextBox(&tbConfirmPassword);
-                if (IsButtonClicked(&btnConfirmDelete)) {
-                    if (strcmp(tbConfirmPassword.text, currentUser.password) == 0) {
-                        deleteAccount(&currentUser);
-                        // clear user after deletion and go to main menu
-                        memset(&currentUser, 0, sizeof(currentUser));
-                        strcpy(message, "Account deleted.");
-                        messageTimer = 180;
-                        currentState = MAIN_MENU;
-                    } else {
-                        strcpy(message, "Incorrect password!");
-                        messageTimer = 180;
-                    }
-                }
-                if (IsButtonClicked(&btnCancelDelete)) {
-                    currentState = USER_MENU;
-                }
-                break;
-        }
-        // Display message if any
-        if (messageTimer > 0) {
-            DrawText(message, gContentInnerX, gWinH - 40, 20, RED);
-            messageTimer--;
-        }
-        EndDrawing();
-    }
-    CloseWindow();
-    return 0;
-}
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "raylib.h"
+#include "bank_client.h"
+#include "bank_money.h"
+#include "bank_profile.h"
+
+// Struct for TextBox
+typedef struct {
+    Rectangle rect;
+    char text[100];
+    int active;
+    int maxLength;
+    int numericType; // 0 = any, 1 = digits only, 2 = number with decimal point
+    int textWidth;   // MeasureText() of text at size 20, -1 once text changes
+} TextBox;
+
+// Struct for Button
+typedef struct {
+    Rectangle rect;
+    const char *text;
+    Color color;
+} Button;
+
+// Enum for states
+typedef enum {
+    MAIN_MENU,
+    CREATE_ACCOUNT,
+    LOGIN,
+    USER_MENU,
+    CHECK_BALANCE,
+    UPDATE_INFO,
+    DEPOSIT,
+    DEPOSIT_SUCCESS,
+    WITHDRAW,
+    WITHDRAW_VERIFY,
+    WITHDRAW_SUCCESS,
+    WITHDRAW_FAILED,
+    VIEW_HISTORY,
+    VIEW_INFO,
+    LOGOUT,
+    CONFIRM_DELETE,
+    PENDING         // a request is with the I/O worker; its completion picks the next state
+} State;
+
+// History screen cache - loaded when VIEW_HISTORY is entered and kept current after each posting.
+// Only a window of formatted rows around the visible page is held, so any history length opens instantly.
+// Windows are fetched by the I/O worker; rows outside the cache read "Loading..." until they arrive.
+#define HISTORY_PAGE_ROWS 14
+#define HISTORY_CACHE_ROWS CLIENT_JOB_ROWS  // one history job fills the cache
+
+typedef struct {
+    int account_number;   // 0 = nothing loaded
+    int total;            // entries in the account's history
+    int scroll;           // first visible row
+    int cacheStart;       // first row held in lines[]
+    int cacheCount;
+    int loading;          // history jobs still in flight
+    char lines[HISTORY_CACHE_ROWS][128];
+} HistoryView;
+
+HistoryView historyView = {0, 0, 0, 0, 0, 0};
+
+// Queue a fetch of the cache window starting at row start (and of the current total)
+void requestHistoryWindow(int start) {
+    ClientJob job;
+    memset(&job, 0, sizeof(job));
+    job.type = JOB_HISTORY;
+    job.account_number = historyView.account_number;
+    job.first = start;
+    job.count = HISTORY_CACHE_ROWS;
+    if (clientSubmit(&job)) historyView.loading++;
+}
+
+void openHistoryView(int account_number) {
+    historyView.account_number = account_number;
+    historyView.total = 0;
+    historyView.scroll = 0;
+    historyView.cacheStart = 0;
+    historyView.cacheCount = 0;
+    historyView.loading = 0;
+    if (account_number != 0) requestHistoryWindow(0);
+}
+
+// Take a finished history job into the cache; replies for an account no longer shown are dropped
+void applyHistoryJob(const ClientJob *job) {
+    if (job->account_number != historyView.account_number) return;
+    if (historyView.loading > 0) historyView.loading--;
+    historyView.total = job->total;
+    historyView.cacheStart = job->first;
+    historyView.cacheCount = job->count;
+    for (int k = 0; k < job->count; k++) {
+        formatLedgerRecord(&job->records[k], historyView.lines[k]);
+    }
+}
+
+void scrollHistoryView(int rows) {
+    int maxScroll = historyView.total - HISTORY_PAGE_ROWS;
+    historyView.scroll += rows;
+    if (historyView.scroll > maxScroll) historyView.scroll = maxScroll;
+    if (historyView.scroll < 0) historyView.scroll = 0;
+}
+
+// Pick up entries posted since the screen was opened; cached rows stay valid because history only grows
+void refreshHistoryView(int account_number) {
+    if (historyView.account_number == account_number) {
+        requestHistoryWindow(historyView.cacheStart);
+    }
+}
+
+// Formatted text of history row i; outside the cache window one refill request is queued
+const char *historyRow(int i) {
+    if (i < historyView.cacheStart || i >= historyView.cacheStart + historyView.cacheCount) {
+        if (!historyView.loading) {
+            int start = i - HISTORY_CACHE_ROWS / 4;  // keep some rows above for scrolling back
+            if (start > historyView.total - HISTORY_CACHE_ROWS) start = historyView.total - HISTORY_CACHE_ROWS;
+            if (start < 0) start = 0;
+            requestHistoryWindow(start);
+        }
+        return "Loading...";
+    }
+    return historyView.lines[i - historyView.cacheStart];
+}
+
+// Global variables - declared early for use in functions
+int buttonPressed = 0;  // Debounce flag for buttons
+
+// Idle rendering - a frame is only drawn after input, a state change, a finished job, or once
+// the time in redrawAt is reached. Anything animated (caret, spinner, timers) lowers redrawAt
+// while it is drawn; until then the loop just polls input and sleeps.
+#define IDLE_POLL_SECONDS 0.02
+double redrawAt = 0.0;
+
+void wakeAt(double t) {
+    if (t < redrawAt) redrawAt = t;
+}
+
+// Wall-clock timers hold the GetTime() at which they run out, so skipped frames cannot stretch them
+double timerIn(double seconds) {
+    return GetTime() + seconds;
+}
+
+int timerExpired(double deadline) {
+    if (GetTime() >= deadline) return 1;
+    wakeAt(deadline);
+    return 0;
+}
+
+// Any input since the last poll: a key, mouse movement, a click or release, the wheel, or a resize
+int inputArrived(void) {
+    Vector2 delta = GetMouseDelta();
+    return GetKeyPressed() != 0 || delta.x != 0 || delta.y != 0 || GetMouseWheelMove() != 0 ||
+           IsMouseButtonPressed(MOUSE_LEFT_BUTTON) || IsMouseButtonReleased(MOUSE_LEFT_BUTTON) ||
+           IsKeyDown(KEY_BACKSPACE) || IsWindowResized();
+}
+// Global layout helpers (set in main)
+int gSidebarRightX = 0;
+int gContentInnerX = 0;
+int gWinH = 0;
+
+// Text measure cache - MeasureText() walks every glyph, so widths of the labels, buttons and
+// field contents drawn each frame are kept here, keyed by string content and font size.
+// Direct-mapped: a colliding string simply replaces the older entry.
+#define TEXT_CACHE_SIZE 256
+#define TEXT_CACHE_CHARS 64
+
+typedef struct {
+    int fontSize;    // 0 = empty slot
+    int width;
+    char text[TEXT_CACHE_CHARS];
+} TextCacheEntry;
+
+TextCacheEntry textCache[TEXT_CACHE_SIZE];
+
+int MeasureTextCached(const char *text, int fontSize) {
+    unsigned int hash = 2166136261u ^ (unsigned int)fontSize;
+    size_t len = 0;
+    for (const char *c = text; *c; c++, len++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    if (len >= TEXT_CACHE_CHARS) return MeasureText(text, fontSize);
+    TextCacheEntry *entry = &textCache[hash & (TEXT_CACHE_SIZE - 1)];
+    if (entry->fontSize != fontSize || strcmp(entry->text, text) != 0) {
+        entry->fontSize = fontSize;
+        entry->width = MeasureText(text, fontSize);
+        memcpy(entry->text, text, len + 1);
+    }
+    return entry->width;
+}
+
+// Replace a TextBox's contents; its cached width is measured again on the next draw
+void SetTextBoxText(TextBox *tb, const char *text) {
+    snprintf(tb->text, sizeof(tb->text), "%s", text);
+    tb->textWidth = -1;
+}
+
+// Helper function to draw rounded rectangle
+void DrawRoundedRectangle(Rectangle rec, float roundness, int segments, Color color) {
+    DrawRectangleRounded(rec, roundness, segments, color);
+}
+
+// Helper function to draw rounded button without border
+void DrawRoundedButton(Button *btn, float roundness, int segments) {
+    DrawRoundedRectangle(btn->rect, roundness, segments, btn->color);
+    // No border - clean modern look
+    int textWidth = MeasureTextCached(btn->text, 20);
+    DrawText(btn->text, btn->rect.x + (btn->rect.width - textWidth) / 2, btn->rect.y + (btn->rect.height - 20) / 2, 20, WHITE);
+}
+
+// Draw TextBox
+void DrawTextBox(TextBox *tb) {
+    // Background changes when active for better affordance
+    Color bg = tb->active ? (Color){235, 245, 255, 255} : (Color){245, 245, 250, 255};
+    DrawRectangleRounded(tb->rect, 0.08f, 8, bg);
+    // Highlight border when active
+    Color border = tb->active ? (Color){25, 100, 200, 255} : (Color){25, 55, 109, 255};
+    DrawRectangleRoundedLines(tb->rect, 0.08f, 8, border);
+    // Vertically center the text inside the input
+    int textY = (int)(tb->rect.y + (tb->rect.height - 20) / 2);
+    if (tb->textWidth < 0) tb->textWidth = MeasureTextCached(tb->text, 20);
+    DrawText(tb->text, tb->rect.x + 8, textY, 20, (Color){25, 55, 109, 255});
+    // Draw blinking caret when active
+    if (tb->active) {
+        double t = GetTime();
+        wakeAt((double)((long long)(t * 2) + 1) / 2);  // redraw at the next blink edge
+        if (((int)(t * 2) % 2) == 0) { // blink ~2 times per second
+            int cx = (int)(tb->rect.x + 8 + tb->textWidth + 1);
+            int cy1 = (int)(tb->rect.y + 8);
+            int cy2 = (int)(tb->rect.y + tb->rect.height - 8);
+            DrawLine(cx, cy1, cx, cy2, border);
+        }
+    }
+}
+
+// Draw a label to the left of a TextBox, vertically centered
+void DrawLabelLeft(TextBox *tb, const char *label) {
+    int labelWidth = MeasureTextCached(label, 20);
+    int x = (int)tb->rect.x - labelWidth - 12; // 12px padding
+    int y = (int)(tb->rect.y + (tb->rect.height - 20) / 2);
+    // If label would overlap the sidebar, draw the label above the textbox instead
+    if (gSidebarRightX > 0 && x < gSidebarRightX + 8) {
+        DrawText(label, (int)tb->rect.x, (int)tb->rect.y - 22, 18, BLACK);
+    } else {
+        DrawText(label, x, y, 20, BLACK);
+    }
+}
+
+// Draw an interactive sidebar button: hover & active states
+void DrawInteractiveButton(Button *btn, int isActive) {
+    Vector2 m = GetMousePosition();
+    int hover = CheckCollisionPointRec(m, btn->rect);
+    Color base = btn->color;
+    Color drawColor;
+    if (isActive) drawColor = (Color){15, 80, 150, 255};
+    else if (hover) drawColor = (Color){45, 110, 200, 255};
+    else drawColor = base;
+    Button tmp = *btn;
+    tmp.color = drawColor;
+    DrawRoundedButton(&tmp, 0.15f, 12);
+}
+
+// Handle TextBox input
+void HandleTextBox(TextBox *tb) {
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), tb->rect)) {
+        tb->active = 1;
+    } else if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+        tb->active = 0;
+    }
+
+    if (tb->active) {
+        int key = GetCharPressed();
+        while (key > 0) {
+            int len = strlen(tb->text);
+            if (strlen(tb->text) < (size_t)tb->maxLength) {
+                if (tb->numericType == 0) {
+                    if ((key >= 32) && (key <= 125)) {
+                        tb->text[len] = (char)key;
+                        tb->text[len + 1] = '\0';
+                        tb->textWidth = -1;
+                    }
+                } else if (tb->numericType == 1) { // digits only
+                    if (key >= '0' && key <= '9') {
+                        tb->text[len] = (char)key;
+                        tb->text[len + 1] = '\0';
+                        tb->textWidth = -1;
+                    }
+                } else if (tb->numericType == 2) { // number with optional single decimal point
+                    if ((key >= '0' && key <= '9')) {
+                        // allow only one decimal point
+                      
+                            tb->text[len] = (char)key;
+                            tb->text[len + 1] = '\0';
+                            tb->textWidth = -1;
+                        
+                    }
+                }
+            }
+            key = GetCharPressed();
+        }
+
+        if (IsKeyPressed(KEY_BACKSPACE) && strlen(tb->text) > 0) {
+            tb->text[strlen(tb->text) - 1] = '\0';
+            tb->textWidth = -1;
+        }
+    }
+}
+
+// Draw Button
+void DrawButton(Button *btn) {
+    DrawRoundedButton(btn, 0.15f, 12);
+}
+
+// Check if button is clicked (with debounce)
+int IsButtonClicked(Button *btn) {
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), btn->rect) && !buttonPressed) {
+        buttonPressed = 1;
+        return 1;
+    }
+    if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+        buttonPressed = 0;
+    }
+    return 0;
+}
+
+// Global variables
+State currentState = MAIN_MENU;
+Account currentUser;
+char message[200] = "";
+double messageTimer = 0;  // timers are deadlines, see timerIn()
+int accountCreatedSuccessfully = 0;  // Flag to show login button after account creation
+ClientJobType pendingVerifyJob = JOB_WITHDRAW;  // posting the velocity rules held for the security question
+Money pendingVerifyAmount = 0;
+int withdrawQuestionIndex = -1;
+Money depositSuccessAmount = 0;
+double depositSuccessTimer = 0;
+Money withdrawSuccessAmount = 0;
+double withdrawSuccessTimer = 0;
+double withdrawFailedTimer = 0;
+double logoutTimer = 0;
+char pendingText[64] = "";
+
+// Profiler overlay (F3) - draw time of each frame by State and I/O job latency by request type
+// as rolling histograms. F4 writes the recorded spans to bank_trace.json (Chrome trace format).
+#define STATE_COUNT (PENDING + 1)
+#define JOB_TYPE_COUNT (JOB_LOGOUT + 1)
+
+const char *stateNames[STATE_COUNT] = {
+    "MAIN_MENU", "CREATE_ACCOUNT", "LOGIN", "USER_MENU", "CHECK_BALANCE", "UPDATE_INFO",
+    "DEPOSIT", "DEPOSIT_SUCCESS", "WITHDRAW", "WITHDRAW_VERIFY", "WITHDRAW_SUCCESS",
+    "WITHDRAW_FAILED", "VIEW_HISTORY", "VIEW_INFO", "LOGOUT", "CONFIRM_DELETE", "PENDING"
+};
+const char *jobNames[JOB_TYPE_COUNT] = {"open", "create", "login", "deposit", "withdraw", "update", "delete", "history", "verify", "logout"};
+ProfileSeries drawProfile[STATE_COUNT];
+ProfileSeries jobProfile[JOB_TYPE_COUNT];
+int profilerVisible = 0;
+
+// Latency is submit to finish, so it includes time spent queued behind other jobs
+void profileJob(const ClientJob *job) {
+    profileSpan(jobNames[job->type], "io", PROFILE_THREAD_IO, job->startedAt, job->finishedAt);
+    profileSample(&jobProfile[job->type], (job->finishedAt - job->queuedAt) * 1000.0);
+}
+
+// One overlay row: label, mean and max, then a bar per sample scaled to the window's max
+int DrawProfileRow(int x, int y, const char *label, const ProfileSeries *series) {
+    if (series->count == 0) return y;
+    char line[96];
+    double max = profileMax(series);
+    sprintf(line, "%-16s avg %7.2f  max %7.2f ms", label, profileMean(series), max);
+    DrawText(line, x, y, 14, WHITE);
+    double scale = max > 1.0 ? max : 1.0;
+    for (int i = 0; i < series->count; i++) {
+        int h = (int)(profileSampleAt(series, i) / scale * 14);
+        if (h < 1) h = 1;
+        DrawRectangle(x + 330 + i * 2, y + 14 - h, 2, h, (Color){120, 200, 255, 255});
+    }
+    return y + 18;
+}
+
+void DrawProfilerOverlay(void) {
+    int x = gSidebarRightX + 30;
+    int y = 30;
+    int rows = 2;
+    for (int i = 0; i < STATE_COUNT; i++) rows += drawProfile[i].count > 0;
+    for (int i = 0; i < JOB_TYPE_COUNT; i++) rows += jobProfile[i].count > 0;
+    DrawRectangle(x - 10, y - 10, 600, rows * 18 + 20, (Color){20, 20, 30, 220});
+    DrawText("Draw time by state (F3 hides, F4 saves trace)", x, y, 14, (Color){191, 144, 0, 255});
+    y += 18;
+    for (int i = 0; i < STATE_COUNT; i++) y = DrawProfileRow(x, y, stateNames[i], &drawProfile[i]);
+    DrawText("I/O job latency", x, y, 14, (Color){191, 144, 0, 255});
+    y += 18;
+    for (int i = 0; i < JOB_TYPE_COUNT; i++) y = DrawProfileRow(x, y, jobNames[i], &jobProfile[i]);
+}
+
+void initJob(ClientJob *job, ClientJobType type, int account_number) {
+    memset(job, 0, sizeof(*job));
+    job->type = type;
+    job->account_number = account_number;
+}
+
+// The amount typed into a text box; returns 0 unless the whole text is a positive amount
+int parseAmountText(const char *text, Money *amount) {
+    int used = moneyParse(text, amount);
+    return used > 0 && text[used] == '\0' && *amount > 0;
+}
+
+// Hand a request to the I/O worker and show the PENDING screen until it finishes
+void submitJob(const ClientJob *job, const char *text) {
+    if (!clientSubmit(job)) {
+        strcpy(message, "Busy, please try again.");
+        messageTimer = timerIn(2.0);
+        return;
+    }
+    snprintf(pendingText, sizeof(pendingText), "%s", text);
+    currentState = PENDING;
+}
+
+// A deposit or withdrawal came back BANK_ERR_VERIFY: keep it and fetch the security question
+// the server picked; the answer goes back with the posting and the server checks it
+void askSecurityQuestion(const ClientJob *held) {
+    pendingVerifyJob = held->type;
+    pendingVerifyAmount = held->amount;
+    ClientJob question;
+    initJob(&question, JOB_VERIFY, held->account_number);
+    submitJob(&question, "Loading security question...");
+}
+
+// Main function
+int main() {
+    int winW = 1200;
+    int winH = 720;
+    InitWindow(winW, winH, "Bank Management System");
+    SetTargetFPS(60);
+    srand((unsigned)time(NULL));
+
+    // All storage and server requests run on the I/O worker; the first one opens the client
+    ClientJob job;
+    clientStartWorker();
+    initJob(&job, JOB_OPEN, 0);
+    submitJob(&job, "Opening accounts...");
+
+    // Sidebar and content layout
+    int sidebarX = 20;
+    int sidebarY = 40;
+    int sidebarW = 320;
+    int sidebarH = winH - 2*sidebarY;
+    int contentX = sidebarX + sidebarW + 20;
+    int contentInnerX = contentX + 20;
+    int contentW = winW - contentX - 20;
+
+    // set globals for helpers used in drawing functions
+    gSidebarRightX = sidebarX + sidebarW;
+    gContentInnerX = contentInnerX;
+    gWinH = winH;
+
+    // Define UI elements with professional banking colors (rects set below for sidebar/content layout)
+    Button btnCreate = {{0,0,0,0}, "Create Account", (Color){25, 55, 109, 255}};
+    Button btnLogin = {{0,0,0,0}, "Login", (Color){25, 55, 109, 255}};
+    Button btnExit = {{0,0,0,0}, "Exit", (Color){191, 144, 0, 255}};
+
+    Button btnSubmitCreate = {{0,0,0,0}, "Submit", (Color){25, 55, 109, 255}};
+    TextBox tbName = {{0,0,0,0}, "", 0, 49, 0};
+    TextBox tbFatherName = {{0,0,0,0}, "", 0, 49, 0};
+    TextBox tbMobile = {{0,0,0,0}, "", 0, 11, 1};
+    TextBox tbAddress = {{0,0,0,0}, "", 0, 99, 0};
+    TextBox tbPassword = {{0,0,0,0}, "", 0, 19, 0};
+
+    Button btnSubmitLogin = {{0,0,0,0}, "Login", (Color){25, 55, 109, 255}};
+    TextBox tbLoginMobile = {{0,0,0,0}, "", 0, 11, 1};
+    TextBox tbLoginPassword = {{0,0,0,0}, "", 0, 19, 0};
+    
+    // Confirm delete UI elements
+    Button btnConfirmDelete = {{0,0,0,0}, "Confirm Delete", (Color){200, 50, 50, 255}};
+    Button btnCancelDelete = {{0,0,0,0}, "Cancel", (Color){100,100,100,255}};
+    TextBox tbConfirmPassword = {{0,0,0,0}, "", 0, 19, 0};
+
+    Button btnCheckBalance = {{0,0,0,0}, "Check Balance", (Color){25, 55, 109, 255}};
+    Button btnUpdateInfo = {{0,0,0,0}, "Update Info", (Color){191, 144, 0, 255}};
+    Button btnViewInfo = {{0,0,0,0}, "View Info", (Color){25, 100, 100, 255}};
+    Button btnDeposit = {{0,0,0,0}, "Deposit", (Color){25, 55, 109, 255}};
+    Button btnWithdraw = {{0,0,0,0}, "Withdraw", (Color){25, 55, 109, 255}};
+    Button btnViewHistory = {{0,0,0,0}, "View History", (Color){191, 144, 0, 255}};
+    Button btnDelete = {{0,0,0,0}, "Delete Account", (Color){200, 50, 50, 255}};
+    Button btnLogout = {{0,0,0,0}, "Logout", (Color){100, 100, 100, 255}};
+
+    Button btnSubmitUpdate = {{0,0,0,0}, "Update", (Color){191, 144, 0, 255}};
+    TextBox tbUpdateName = {{0,0,0,0}, "", 0, 49, 0};
+    TextBox tbUpdateFather = {{0,0,0,0}, "", 0, 49, 0};
+    TextBox tbUpdateAddress = {{0,0,0,0}, "", 0, 99, 0};
+    TextBox tbUpdatePassword = {{0,0,0,0}, "", 0, 19, 0};
+
+    Button btnSubmitDeposit = {{0,0,0,0}, "Deposit", (Color){25, 55, 109, 255}};
+    TextBox tbDepositAmount = {{0,0,0,0}, "", 0, 10, 2};
+
+    Button btnSubmitWithdraw = {{0,0,0,0}, "Withdraw", (Color){25, 55, 109, 255}};
+    TextBox tbWithdrawAmount = {{0,0,0,0}, "", 0, 10, 2};
+
+    Button btnHistoryPrev = {{0,0,0,0}, "Prev", (Color){25, 55, 109, 255}};
+    Button btnHistoryNext = {{0,0,0,0}, "Next", (Color){25, 55, 109, 255}};
+
+    Button btnVerifyWithdraw = {{0,0,0,0}, "Verify", (Color){25, 55, 109, 255}};
+    Button btnCancelVerify = {{0,0,0,0}, "Cancel", (Color){100,100,100,255}};
+    TextBox tbWithdrawSecurity = {{0,0,0,0}, "", 0, 50, 0};
+
+    // Compute positions for sidebar buttons and content fields
+    int sbBtnW = sidebarW - 40;
+    int sbBtnH = 50;
+    int sbBtnX = sidebarX + 20;
+    int sbBtnY = sidebarY + 80; // increased top padding so buttons sit clearly below header
+    int sbSpacing = 14;
+
+    // Main menu sidebar buttons
+    btnCreate.rect.x = sbBtnX; btnCreate.rect.y = sbBtnY; btnCreate.rect.width = sbBtnW; btnCreate.rect.height = sbBtnH;
+    btnLogin.rect.x = sbBtnX; btnLogin.rect.y = sbBtnY + (sbBtnH + sbSpacing); btnLogin.rect.width = sbBtnW; btnLogin.rect.height = sbBtnH;
+    btnExit.rect.x = sbBtnX; btnExit.rect.y = sbBtnY + 2*(sbBtnH + sbSpacing); btnExit.rect.width = sbBtnW; btnExit.rect.height = sbBtnH;
+
+    // User menu sidebar buttons (stacked) - compute start Y so the group fits inside the sidebar
+    int nUserBtns = 8;
+    int totalUserHeight = nUserBtns * sbBtnH + (nUserBtns - 1) * sbSpacing;
+    int userStartY = sidebarY + (sidebarH - totalUserHeight) / 2; // center vertically in sidebar
+    btnCheckBalance.rect.x = sbBtnX; btnCheckBalance.rect.y = userStartY; btnCheckBalance.rect.width = sbBtnW; btnCheckBalance.rect.height = sbBtnH;
+    btnUpdateInfo.rect.x = sbBtnX; btnUpdateInfo.rect.y = userStartY + (sbBtnH + sbSpacing); btnUpdateInfo.rect.width = sbBtnW; btnUpdateInfo.rect.height = sbBtnH;
+    btnViewInfo.rect.x = sbBtnX; btnViewInfo.rect.y = userStartY + 2*(sbBtnH + sbSpacing); btnViewInfo.rect.width = sbBtnW; btnViewInfo.rect.height = sbBtnH;
+    btnDeposit.rect.x = sbBtnX; btnDeposit.rect.y = userStartY + 3*(sbBtnH + sbSpacing); btnDeposit.rect.width = sbBtnW; btnDeposit.rect.height = sbBtnH;
+    btnWithdraw.rect.x = sbBtnX; btnWithdraw.rect.y = userStartY + 4*(sbBtnH + sbSpacing); btnWithdraw.rect.width = sbBtnW; btnWithdraw.rect.height = sbBtnH;
+    btnViewHistory.rect.x = sbBtnX; btnViewHistory.rect.y = userStartY + 5*(sbBtnH + sbSpacing); btnViewHistory.rect.width = sbBtnW; btnViewHistory.rect.height = sbBtnH;
+    btnDelete.rect.x = sbBtnX; btnDelete.rect.y = userStartY + 6*(sbBtnH + sbSpacing); btnDelete.rect.width = sbBtnW; btnDelete.rect.height = sbBtnH;
+    btnLogout.rect.x = sbBtnX; btnLogout.rect.y = userStartY + 7*(sbBtnH + sbSpacing); btnLogout.rect.width = sbBtnW; btnLogout.rect.height = sbBtnH;
+
+    // Confirm/cancel and action buttons placed in content area
+    btnSubmitCreate.rect = (Rectangle){contentInnerX + 40, 480, 240, 56};
+    btnSubmitLogin.rect = (Rectangle){contentInnerX + 40, 360, 240, 56};
+    btnConfirmDelete.rect = (Rectangle){contentInnerX + 20, 300, 280, 56};
+    btnCancelDelete.rect = (Rectangle){contentInnerX + 320, 300, 100, 56};
+    btnSubmitUpdate.rect = (Rectangle){contentInnerX + 40, 420, 200, 50};
+    btnSubmitDeposit.rect = (Rectangle){contentInnerX + 40, 230, 200, 50};
+    btnSubmitWithdraw.rect = (Rectangle){contentInnerX + 40, 230, 200, 50};
+    btnHistoryPrev.rect = (Rectangle){contentInnerX + 10, 500, 120, 40};
+    btnHistoryNext.rect = (Rectangle){contentInnerX + 270, 500, 120, 40};
+    btnVerifyWithdraw.rect = (Rectangle){contentInnerX + 40, 230, 140, 50};
+    btnCancelVerify.rect = (Rectangle){contentInnerX + 220, 230, 140, 50};
+
+    // TextBoxes in content area (common x and widths)
+    int inputX = contentInnerX + 20;
+    int inputW = contentW - 60;
+
+    tbName.rect = (Rectangle){inputX, 110, inputW, 44};
+    tbFatherName.rect = (Rectangle){inputX, 174, inputW, 44};
+    tbMobile.rect = (Rectangle){inputX, 238, inputW, 44};
+    tbAddress.rect = (Rectangle){inputX, 302, inputW, 44};
+    tbPassword.rect = (Rectangle){inputX, 366, inputW, 44};
+
+    tbLoginMobile.rect = (Rectangle){inputX, 170, inputW, 44};
+    tbLoginPassword.rect = (Rectangle){inputX, 236, inputW, 44};
+
+    tbConfirmPassword.rect = (Rectangle){inputX, 240, inputW, 44};
+
+    tbUpdateName.rect = (Rectangle){inputX, 100, inputW - 60, 30};
+    tbUpdateFather.rect = (Rectangle){inputX, 150, inputW - 60, 30};
+    tbUpdateAddress.rect = (Rectangle){inputX, 200, inputW - 60, 30};
+    tbUpdatePassword.rect = (Rectangle){inputX, 250, inputW - 60, 30};
+
+    tbDepositAmount.rect = (Rectangle){inputX, 150, inputW - 60, 30};
+    tbWithdrawAmount.rect = (Rectangle){inputX, 150, inputW - 60, 30};
+    tbWithdrawSecurity.rect = (Rectangle){inputX, 180, inputW, 44};
+
+    int drawnState = -1;
+    while (!WindowShouldClose()) {
+        // Finished jobs move the state machine on before this frame's input is handled
+        int jobFinished = 0;
+        while (clientPollJob(&job)) {
+            jobFinished = 1;
+            profileJob(&job);
+            switch (job.type) {
+                case JOB_OPEN:
+                    if (job.status != BANK_OK) {
+                        strcpy(message, job.status == BANK_ERR_IO ? "Unable to open account data!" : bankStatusMessage(job.status));
+                        messageTimer = timerIn(5.0);
+                    }
+                    currentState = MAIN_MENU;
+                    break;
+                case JOB_CREATE:
+                    if (job.status == BANK_OK) {
+                        sprintf(message, "Account created! Number: %d", job.account.account_number);
+                        // Clear text boxes
+                        SetTextBoxText(&tbName, "");
+                        SetTextBoxText(&tbFatherName, "");
+                        SetTextBoxText(&tbMobile, "");
+                        SetTextBoxText(&tbAddress, "");
+                        SetTextBoxText(&tbPassword, "");
+                        accountCreatedSuccessfully = 1;  // Set flag to show login button
+                    } else {
+                        strcpy(message, bankStatusMessage(job.status));
+                    }
+                    messageTimer = timerIn(3.0);
+                    currentState = CREATE_ACCOUNT;
+                    break;
+                case JOB_LOGIN:
+                    if (job.status == BANK_OK) {
+                        currentUser = job.account;
+                        currentState = USER_MENU;
+                        strcpy(message, "");
+                        SetTextBoxText(&tbLoginMobile, "");
+                        SetTextBoxText(&tbLoginPassword, "");
+                    } else {
+                        strcpy(message, job.status == BANK_ERR_NOT_FOUND ? "No accounts found!" : "Invalid credentials!");
+                        messageTimer = timerIn(3.0);
+                        currentState = LOGIN;
+                    }
+                    break;
+                case JOB_DEPOSIT:
+                    if (job.status == BANK_OK) {
+                        currentUser = job.account;
+                        refreshHistoryView(currentUser.account_number);
+                        depositSuccessAmount = job.amount;
+                        depositSuccessTimer = timerIn(4.0);
+                        SetTextBoxText(&tbDepositAmount, "");
+                        currentState = DEPOSIT_SUCCESS;
+                    } else if (job.status == BANK_ERR_VERIFY) {
+                        askSecurityQuestion(&job);
+                        SetTextBoxText(&tbWithdrawSecurity, "");
+                    } else if (job.status == BANK_ERR_AUTH && job.answer[0]) {
+                        withdrawFailedTimer = timerIn(2.0);
+                        currentState = WITHDRAW_FAILED;
+                    } else {
+                        strcpy(message, job.status == BANK_ERR_AMOUNT ? "Enter a valid amount!" : bankStatusMessage(job.status));
+                        messageTimer = timerIn(2.0);
+                        currentState = DEPOSIT;
+                    }
+                    break;
+                case JOB_WITHDRAW:
+                    if (job.status == BANK_OK) {
+                        currentUser = job.account;
+                        refreshHistoryView(currentUser.account_number);
+                        SetTextBoxText(&tbWithdrawAmount, "");
+                        withdrawSuccessAmount = job.amount;
+                        withdrawSuccessTimer = timerIn(2.0);
+                        currentState = WITHDRAW_SUCCESS;
+                    } else if (job.status == BANK_ERR_VERIFY) {
+                        askSecurityQuestion(&job);
+                        SetTextBoxText(&tbWithdrawSecurity, "");
+                    } else if (job.status == BANK_ERR_AUTH && job.answer[0]) {
+                        withdrawFailedTimer = timerIn(2.0);
+                        currentState = WITHDRAW_FAILED;
+                    } else {
+                        strcpy(message, bankStatusMessage(job.status));
+                        messageTimer = timerIn(2.0);
+                        currentState = WITHDRAW;
+                    }
+                    break;
+                case JOB_UPDATE:
+                    if (job.status != BANK_OK) {
+                        strcpy(message, bankStatusMessage(job.status));
+                        messageTimer = timerIn(3.0);
+                    }
+                    currentState = USER_MENU;
+                    break;
+                case JOB_DELETE:
+                    if (job.status == BANK_OK) {
+                        openHistoryView(0);
+                        // clear user after deletion and go to main menu
+                        memset(&currentUser, 0, sizeof(currentUser));
+                        strcpy(message, "Account deleted. The bank can restore it within 30 days.");
+                        currentState = MAIN_MENU;
+                    } else {
+                        strcpy(message, bankStatusMessage(job.status));
+                        currentState = USER_MENU;
+                    }
+                    messageTimer = timerIn(3.0);
+                    break;
+                case JOB_HISTORY:
+                    applyHistoryJob(&job);
+                    break;
+                case JOB_VERIFY:
+                    if (job.status == BANK_OK) {
+                        withdrawQuestionIndex = job.count;
+                        currentState = WITHDRAW_VERIFY;
+                    } else {
+                        strcpy(message, bankStatusMessage(job.status));
+                        messageTimer = timerIn(2.0);
+                        currentState = USER_MENU;
+                    }
+                    break;
+                case JOB_LOGOUT:
+                    break;
+            }
+        }
+
+        // Idle: the last frame is still current, so only poll input until something changes
+        if (!jobFinished && (int)currentState == drawnState && GetTime() < redrawAt && !inputArrived()) {
+            double wait = redrawAt - GetTime();
+            WaitTime(wait < IDLE_POLL_SECONDS ? wait : IDLE_POLL_SECONDS);
+            PollInputEvents();
+            continue;
+        }
+        drawnState = (int)currentState;
+        redrawAt = GetTime() + 1.0;  // refresh once a second even when nothing asks for it
+
+        double frameStart = profileNow();
+        BeginDrawing();
+        ClearBackground((Color){255, 255, 255, 255});
+
+            // Draw left sidebar background and header
+            DrawRectangleRounded((Rectangle){sidebarX, sidebarY, sidebarW, sidebarH}, 0.08f, 8, (Color){245,245,250,255});
+            DrawRectangleRoundedLines((Rectangle){sidebarX, sidebarY, sidebarW, sidebarH}, 0.08f, 8, (Color){200,200,210,255});
+            DrawText("Bank System", sidebarX + 20, sidebarY + 12, 20, (Color){25,55,109,255});
+            // Small subtitle or user info
+            if (currentState >= USER_MENU && currentState != LOGOUT && strlen(currentUser.name) > 0) {
+                DrawText(currentUser.name, sidebarX + 20, sidebarY + 36, 14, (Color){80,80,90,255});
+            }
+
+            // Static sidebar: choose which set to show based on whether a user is logged in
+            if (currentUser.account_number == 0) {
+                // Not logged in: show primary navigation on main screen and while filling Create/Login forms
+                if (currentState == MAIN_MENU || currentState == CREATE_ACCOUNT || currentState == LOGIN || currentState == PENDING) {
+                    DrawInteractiveButton(&btnCreate, currentState == CREATE_ACCOUNT);
+                    DrawInteractiveButton(&btnLogin, currentState == LOGIN);
+                    DrawInteractiveButton(&btnExit, 0);
+
+                    if (currentState == PENDING) {
+                        // Navigation waits for the job in flight
+                    } else if (IsButtonClicked(&btnCreate)) {
+                        currentState = CREATE_ACCOUNT;
+                        strcpy(message, "");
+                    } else if (IsButtonClicked(&btnLogin)) {
+                        currentState = LOGIN;
+                        strcpy(message, "");
+                    } else if (IsButtonClicked(&btnExit)) {
+                        clientStopWorker();
+                        CloseWindow();
+                        return 0;
+                    }
+                }
+            } else {
+                // Logged-in sidebar (static across user screens)
+                DrawInteractiveButton(&btnCheckBalance, currentState == CHECK_BALANCE);
+                DrawInteractiveButton(&btnUpdateInfo, currentState == UPDATE_INFO);
+                DrawInteractiveButton(&btnViewInfo, currentState == VIEW_INFO);
+                DrawInteractiveButton(&btnDeposit, currentState == DEPOSIT || (currentState == WITHDRAW_VERIFY && pendingVerifyJob == JOB_DEPOSIT));
+                DrawInteractiveButton(&btnWithdraw, currentState == WITHDRAW || (currentState == WITHDRAW_VERIFY && pendingVerifyJob == JOB_WITHDRAW));
+                DrawInteractiveButton(&btnViewHistory, currentState == VIEW_HISTORY);
+                DrawInteractiveButton(&btnDelete, currentState == CONFIRM_DELETE);
+                DrawInteractiveButton(&btnLogout, currentState == LOGOUT);
+
+                if (currentState == PENDING) {
+                    // Navigation waits for the job in flight
+                } else if (IsButtonClicked(&btnCheckBalance)) {
+                    currentState = CHECK_BALANCE;
+                } else if (IsButtonClicked(&btnUpdateInfo)) {
+                    currentState = UPDATE_INFO;
+                    SetTextBoxText(&tbUpdateName, currentUser.name);
+                    SetTextBoxText(&tbUpdateFather, currentUser.father_name);
+                    SetTextBoxText(&tbUpdateAddress, currentUser.address);
+                    SetTextBoxText(&tbUpdatePassword, currentUser.password);
+                } else if (IsButtonClicked(&btnViewInfo)) {
+                    currentState = VIEW_INFO;
+                } else if (IsButtonClicked(&btnDeposit)) {
+                    currentState = DEPOSIT;
+                } else if (IsButtonClicked(&btnWithdraw)) {
+                    currentState = WITHDRAW;
+                } else if (IsButtonClicked(&btnViewHistory)) {
+                    currentState = VIEW_HISTORY;
+                    openHistoryView(currentUser.account_number);
+                } else if (IsButtonClicked(&btnDelete)) {
+                    currentState = CONFIRM_DELETE;
+                    SetTextBoxText(&tbConfirmPassword, "");
+                } else if (IsButtonClicked(&btnLogout)) {
+                    logoutTimer = timerIn(4.0);
+                    currentState = LOGOUT;
+                }
+            }
+
+        Button btnBack;
+        switch (currentState) {
+            case MAIN_MENU:
+                DrawText("Bank Management System", contentInnerX + 40, 100, 30, BLACK);
+                break;
+
+            case CREATE_ACCOUNT:
+                DrawText("Create New Account", contentInnerX + 40, 50, 25, BLACK);
+                
+                if (!accountCreatedSuccessfully) {
+                    // Show form for creating account
+                    // Draw labels above the input fields to avoid overlap
+                    DrawLabelLeft(&tbName, "Name:");
+                    DrawTextBox(&tbName);
+                    DrawLabelLeft(&tbFatherName, "Father's Name:");
+                    DrawTextBox(&tbFatherName);
+                    DrawLabelLeft(&tbMobile, "Mobile (11 digits):");
+                    DrawTextBox(&tbMobile);
+                    DrawLabelLeft(&tbAddress, "Address:");
+                    DrawTextBox(&tbAddress);
+                    DrawLabelLeft(&tbPassword, "Password:");
+                    DrawTextBox(&tbPassword);
+                    DrawButton(&btnSubmitCreate);
+
+                    HandleTextBox(&tbName);
+                    HandleTextBox(&tbFatherName);
+                    HandleTextBox(&tbMobile);
+                    HandleTextBox(&tbAddress);
+                    HandleTextBox(&tbPassword);
+
+                    if (IsButtonClicked(&btnSubmitCreate)) {
+                        if (strlen(tbName.text) == 0 || strlen(tbFatherName.text) == 0 || strlen(tbMobile.text) != 11 || strlen(tbAddress.text) == 0 || strlen(tbPassword.text) == 0) {
+                            strcpy(message, "All fields must be filled correctly!");
+                            messageTimer = timerIn(3.0);
+                        } else {
+                            initJob(&job, JOB_CREATE, 0);
+                            strcpy(job.account.name, tbName.text);
+                            strcpy(job.account.father_name, tbFatherName.text);
+                            strcpy(job.account.mobile_number, tbMobile.text);
+                            strcpy(job.account.address, tbAddress.text);
+                            strcpy(job.account.password, tbPassword.text);
+                            submitJob(&job, "Creating account...");
+                        }
+                    }
+                } else {
+                    // Show message and login button after account created
+                    DrawText(message, gContentInnerX, 180, 20, (Color){25, 55, 109, 255});
+                    DrawText("Click Login to continue", gContentInnerX, 250, 18, BLACK);
+                    Button btnGoToLogin = {{gContentInnerX, 330, 240, 60}, "Go to Login", (Color){25, 55, 109, 255}};
+                    DrawButton(&btnGoToLogin);
+                    
+                    if (IsButtonClicked(&btnGoToLogin)) {
+                        currentState = LOGIN;
+                        accountCreatedSuccessfully = 0;  // Reset flag
+                        strcpy(message, "");
+                        SetTextBoxText(&tbLoginMobile, "");
+                        SetTextBoxText(&tbLoginPassword, "");
+                    }
+                }
+                break;
+
+            case LOGIN:
+                DrawText("Login", contentInnerX + 40, 100, 25, BLACK);
+                // Draw labels to the left of the input fields (same-line)
+                DrawLabelLeft(&tbLoginMobile, "Mobile:");
+                DrawTextBox(&tbLoginMobile);
+                DrawLabelLeft(&tbLoginPassword, "Password:");
+                DrawTextBox(&tbLoginPassword);
+                DrawButton(&btnSubmitLogin);
+
+                HandleTextBox(&tbLoginMobile);
+                HandleTextBox(&tbLoginPassword);
+
+                if (IsButtonClicked(&btnSubmitLogin)) {
+                    initJob(&job, JOB_LOGIN, 0);
+                    strcpy(job.account.mobile_number, tbLoginMobile.text);
+                    strcpy(job.account.password, tbLoginPassword.text);
+                    submitJob(&job, "Signing in...");
+                }
+                break;
+
+            case USER_MENU:
+              
+                break;
+
+            case CHECK_BALANCE:
+                DrawText("Check Balance", contentInnerX + 40, 100, 25, BLACK);
+                char balanceStr[50];
+                strcpy(balanceStr, "Balance: ");
+                moneyFormat(currentUser.balance, balanceStr + strlen(balanceStr));
+                DrawText(balanceStr, contentInnerX + 40, 200, 20, BLACK);
+                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 300; btnBack.rect.width = 100; btnBack.rect.height = 40;
+                btnBack.text = "Back"; btnBack.color = GRAY;
+                DrawButton(&btnBack);
+                if (IsButtonClicked(&btnBack)) {
+                    currentState = USER_MENU;
+                }
+                break;
+
+            case UPDATE_INFO:
+                DrawText("Update Information", contentInnerX + 40, 50, 25, BLACK);
+                DrawLabelLeft(&tbUpdateName, "Name:");
+                DrawTextBox(&tbUpdateName);
+                DrawLabelLeft(&tbUpdateFather, "Father's Name:");
+                DrawTextBox(&tbUpdateFather);
+                DrawLabelLeft(&tbUpdateAddress, "Address:");
+                DrawTextBox(&tbUpdateAddress);
+                DrawLabelLeft(&tbUpdatePassword, "Password:");
+                DrawTextBox(&tbUpdatePassword);
+                DrawButton(&btnSubmitUpdate);
+                HandleTextBox(&tbUpdateName);
+                HandleTextBox(&tbUpdateFather);
+                HandleTextBox(&tbUpdateAddress);
+                HandleTextBox(&tbUpdatePassword);
+                if (IsButtonClicked(&btnSubmitUpdate)) {
+                    strcpy(currentUser.name, tbUpdateName.text);
+                    strcpy(currentUser.father_name, tbUpdateFather.text);
+                    strcpy(currentUser.address, tbUpdateAddress.text);
+                    strcpy(currentUser.password, tbUpdatePassword.text);
+                    initJob(&job, JOB_UPDATE, currentUser.account_number);
+                    job.account = currentUser;
+                    submitJob(&job, "Saving changes...");
+                }
+                break;
+            case DEPOSIT:
+                DrawText("Deposit Money", contentInnerX + 40, 50, 25, BLACK);
+                DrawLabelLeft(&tbDepositAmount, "Amount:");
+                DrawTextBox(&tbDepositAmount);
+                DrawButton(&btnSubmitDeposit);
+                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 310; btnBack.rect.width = 100; btnBack.rect.height = 40;
+                btnBack.text = "Back"; btnBack.color = GRAY;
+                DrawButton(&btnBack);
+                HandleTextBox(&tbDepositAmount);
+                if (IsButtonClicked(&btnSubmitDeposit)) {
+                    Money amount = 0;
+                    if (parseAmountText(tbDepositAmount.text, &amount)) {
+                        initJob(&job, JOB_DEPOSIT, currentUser.account_number);
+                        job.amount = amount;
+                        submitJob(&job, "Processing deposit...");
+                    } else {
+                        strcpy(message, "Enter a valid amount!");
+                        messageTimer = timerIn(2.0);
+                    }
+                }
+                if (IsButtonClicked(&btnBack)) {
+                    currentState = USER_MENU;
+                    SetTextBoxText(&tbDepositAmount, "");
+                }
+                break;
+            case DEPOSIT_SUCCESS:
+                DrawText("Deposit Successful", contentInnerX + 40, 100, 30, BLACK);
+                char depositMsg[100];
+                char depositText[MONEY_TEXT_MAX];
+                moneyFormat(depositSuccessAmount, depositText);
+                sprintf(depositMsg, "Amount %s submitted successfully!", depositText);
+                DrawText(depositMsg, contentInnerX + 40, 200, 20, (Color){0, 128, 0, 255});
+                DrawText("Returning to menu...", contentInnerX + 40, 300, 18, GRAY);
+                if (timerExpired(depositSuccessTimer)) {
+                    currentState = USER_MENU;
+                    depositSuccessAmount = 0;
+                }
+                break;
+            case WITHDRAW:
+                DrawText("Withdraw Money", contentInnerX + 40, 50, 25, BLACK);
+                if (currentUser.balance <= 0) {
+                    DrawText("No funds available in this account.", contentInnerX + 40, 200, 20, RED);
+                    btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 300; btnBack.rect.width = 100; btnBack.rect.height = 40;
+                    btnBack.text = "Back"; btnBack.color = GRAY;
+                    DrawButton(&btnBack);
+                    if (IsButtonClicked(&btnBack)) {
+                        currentState = USER_MENU;
+                    }
+                } else {
+                    DrawLabelLeft(&tbWithdrawAmount, "Amount:");
+                    DrawTextBox(&tbWithdrawAmount);
+                    DrawButton(&btnSubmitWithdraw);
+                    btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 310; btnBack.rect.width = 100; btnBack.rect.height = 40;
+                    btnBack.text = "Back"; btnBack.color = GRAY;
+                    DrawButton(&btnBack);
+                    HandleTextBox(&tbWithdrawAmount);
+                    if (IsButtonClicked(&btnSubmitWithdraw)) {
+                        Money amount = 0;
+                        if (parseAmountText(tbWithdrawAmount.text, &amount) && amount <= currentUser.balance) {
+                            // The core's velocity rules decide whether the security question is needed
+                            initJob(&job, JOB_WITHDRAW, currentUser.account_number);
+                            job.amount = amount;
+                            submitJob(&job, "Processing withdrawal...");
+                        } else {
+                            strcpy(message, "Insufficient amount! please enter a valid amount.");
+                            messageTimer = timerIn(2.0);
+                        }
+                    }
+                    if (IsButtonClicked(&btnBack)) {
+                        currentState = USER_MENU;
+                        SetTextBoxText(&tbWithdrawAmount, "");
+                    }
+                }
+                break;
+            case WITHDRAW_VERIFY:
+                DrawText(pendingVerifyJob == JOB_DEPOSIT ? "Verify Deposit" : "Verify Withdrawal", contentInnerX + 40, 50, 25, BLACK);
+                {
+                    DrawText(bankSecurityQuestion(withdrawQuestionIndex), contentInnerX + 10, 120, 20, BLACK);
+                    DrawLabelLeft(&tbWithdrawSecurity, "Answer:");
+                    DrawTextBox(&tbWithdrawSecurity);
+                    DrawButton(&btnVerifyWithdraw);
+                    DrawButton(&btnCancelVerify);
+                    HandleTextBox(&tbWithdrawSecurity);
+
+                    if (IsButtonClicked(&btnVerifyWithdraw) && tbWithdrawSecurity.text[0] != '\0') {
+                        // The server checks the answer; a wrong one comes back as BANK_ERR_AUTH
+                        initJob(&job, pendingVerifyJob, currentUser.account_number);
+                        job.amount = pendingVerifyAmount;
+                        snprintf(job.answer, sizeof(job.answer), "%s", tbWithdrawSecurity.text);
+                        withdrawQuestionIndex = -1;
+                        SetTextBoxText(&tbWithdrawSecurity, "");
+                        submitJob(&job, job.type == JOB_DEPOSIT ? "Processing deposit..." : "Processing withdrawal...");
+                    }
+                    if (IsButtonClicked(&btnCancelVerify)) {
+                        currentState = LOGOUT;
+                    }
+                }
+                break;
+            case WITHDRAW_FAILED:
+                DrawText(pendingVerifyJob == JOB_DEPOSIT ? "Deposit Failed" : "Withdrawal Failed", contentInnerX + 40, 100, 30, BLACK);
+                DrawText("Incorrect answer!", contentInnerX + 40, 200, 24, RED);
+                DrawText(pendingVerifyJob == JOB_DEPOSIT ? "Deposit cancelled." : "Withdrawal cancelled.", contentInnerX + 40, 260, 20, BLACK);
+//                DrawText("Returning to menu...", contentInnerX + 40, 340, 18, GRAY);
+                if (timerExpired(withdrawFailedTimer)) {
+                    currentState = LOGOUT;
+                    pendingVerifyAmount = 0;
+                    withdrawQuestionIndex = -1;
+                }
+                break;
+            case WITHDRAW_SUCCESS:
+                DrawText("Withdrawal Successful", contentInnerX + 40, 100, 30, BLACK);
+                char withdrawMsg[100];
+                char withdrawText[MONEY_TEXT_MAX];
+                moneyFormat(withdrawSuccessAmount, withdrawText);
+                sprintf(withdrawMsg, "Amount %s withdrawn successfully!", withdrawText);
+                DrawText(withdrawMsg, contentInnerX + 40, 200, 20, (Color){0, 128, 0, 255});
+                DrawText("Returning to menu...", contentInnerX + 40, 300, 18, GRAY);
+                if (timerExpired(withdrawSuccessTimer)) {
+                    currentState = USER_MENU;
+                    withdrawSuccessAmount = 0;
+                }
+                break;
+            case VIEW_HISTORY:
+                DrawText("Transaction History", contentInnerX + 40, 50, 25, BLACK);
+                if (historyView.account_number != currentUser.account_number) {
+                    openHistoryView(currentUser.account_number);
+                }
+                {
+                    if (historyView.total > 0) {
+                            // Draw only the visible page; rows come from the cache
+                            int y = 100;
+                            int last = historyView.scroll + HISTORY_PAGE_ROWS;
+                            if (last > historyView.total) last = historyView.total;
+                            for (int i = historyView.scroll; i < last; i++) {
+                                DrawText(historyRow(i), contentInnerX + 10, y, 20, BLACK);
+                                y += 28;
+                            }
+                            // Scrollbar thumb sized to the visible fraction of the history
+                            if (historyView.total > HISTORY_PAGE_ROWS) {
+                                int trackY = 100;
+                                int trackH = HISTORY_PAGE_ROWS * 28;
+                                int thumbH = trackH * HISTORY_PAGE_ROWS / historyView.total;
+                                if (thumbH < 20) thumbH = 20;
+                                int thumbY = trackY + (int)((long long)(trackH - thumbH) * historyView.scroll / (historyView.total - HISTORY_PAGE_ROWS));
+                                DrawRectangle(contentInnerX + contentW - 70, trackY, 6, trackH, (Color){230, 230, 235, 255});
+                                DrawRectangle(contentInnerX + contentW - 70, thumbY, 6, thumbH, (Color){25, 55, 109, 255});
+                            }
+                            char pageInfo[64];
+                            sprintf(pageInfo, "Showing %d-%d of %d", historyView.scroll + 1, last, historyView.total);
+                            DrawText(pageInfo, contentInnerX + 420, 510, 18, GRAY);
+                        } else if (historyView.loading) {
+                            DrawText("Loading...", contentInnerX + 40, 200, 20, GRAY);
+                        } else {
+                            DrawText("No transactions found.", contentInnerX + 40, 200, 20, BLACK);
+                        }
+                }
+                // Mouse wheel scrolls a few rows, Page Up/Down and the buttons move a page, Home/End jump to the ends
+                scrollHistoryView((int)(-GetMouseWheelMove() * 3));
+                if (IsKeyPressed(KEY_DOWN)) scrollHistoryView(1);
+                if (IsKeyPressed(KEY_UP)) scrollHistoryView(-1);
+                if (IsKeyPressed(KEY_PAGE_DOWN)) scrollHistoryView(HISTORY_PAGE_ROWS);
+                if (IsKeyPressed(KEY_PAGE_UP)) scrollHistoryView(-HISTORY_PAGE_ROWS);
+                if (IsKeyPressed(KEY_HOME)) scrollHistoryView(-historyView.total);
+                if (IsKeyPressed(KEY_END)) scrollHistoryView(historyView.total);
+                DrawButton(&btnHistoryPrev);
+                DrawButton(&btnHistoryNext);
+                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 500; btnBack.rect.width = 100; btnBack.rect.height = 40;
+                btnBack.text = "Back"; btnBack.color = GRAY;
+                DrawButton(&btnBack);
+
+                if (IsButtonClicked(&btnHistoryPrev)) {
+                    scrollHistoryView(-HISTORY_PAGE_ROWS);
+                } else if (IsButtonClicked(&btnHistoryNext)) {
+                    scrollHistoryView(HISTORY_PAGE_ROWS);
+                } else if (IsButtonClicked(&btnBack)) {
+                    currentState = USER_MENU;
+                }
+                break;
+            case VIEW_INFO:
+                DrawText("Account Information", gContentInnerX, 50, 26, BLACK);
+                // Display user fields
+                DrawText("Name:", gContentInnerX, 110, 20, BLACK);
+                DrawText(currentUser.name, gContentInnerX + 160, 110, 20, (Color){25,55,109,255});
+                DrawText("Father's Name:", gContentInnerX, 150, 20, BLACK);
+                DrawText(currentUser.father_name, gContentInnerX + 160, 150, 20, (Color){25,55,109,255});
+                DrawText("Mobile:", gContentInnerX, 190, 20, BLACK);
+                DrawText(currentUser.mobile_number, gContentInnerX + 160, 190, 20, (Color){25,55,109,255});
+                DrawText("Address:", gContentInnerX, 230, 20, BLACK);
+                DrawText(currentUser.address, gContentInnerX + 160, 230, 20, (Color){25,55,109,255});
+                DrawText("Password:", gContentInnerX, 270, 20, BLACK);
+                DrawText(currentUser.password, gContentInnerX + 160, 270, 20, (Color){25,55,109,255});
+                DrawText("Account No:", gContentInnerX, 310, 20, BLACK);
+                char accBuf[32]; sprintf(accBuf, "%d", currentUser.account_number);
+                DrawText(accBuf, gContentInnerX + 160, 310, 20, (Color){25,55,109,255});
+                DrawText("Balance:", gContentInnerX, 350, 20, BLACK);
+                char balBuf[MONEY_TEXT_MAX]; moneyFormat(currentUser.balance, balBuf);
+                DrawText(balBuf, gContentInnerX + 160, 350, 20, (Color){25,55,109,255});
+                btnBack.rect.x = gContentInnerX + 150; btnBack.rect.y = 420; btnBack.rect.width = 100; btnBack.rect.height = 40;
+                btnBack.text = "Back"; btnBack.color = GRAY;
+                DrawButton(&btnBack);
+                if (IsButtonClicked(&btnBack)) {
+                    currentState = USER_MENU;
+                }
+                break;
+            case LOGOUT:
+                DrawText("Thank You!", contentInnerX + 40, 150, 40, (Color){25, 55, 109, 255});
+                DrawText("Thanks for visiting our bank", contentInnerX + 40, 250, 24, BLACK);
+                DrawText("Returning to main menu...", contentInnerX + 40, 340, 18, GRAY);
+                if (timerExpired(logoutTimer)) {
+                    // clear current user on logout so sidebar returns to main nav
+                    memset(&currentUser, 0, sizeof(currentUser));
+                    initJob(&job, JOB_LOGOUT, 0);
+                    clientSubmit(&job);  // ends the server session's login; nothing waits for it
+                    currentState = MAIN_MENU;
+                }
+                break;
+            case CONFIRM_DELETE:
+                DrawText("Confirm Delete", contentInnerX + 40, 180, 25, BLACK);
+                DrawLabelLeft(&tbConfirmPassword, "Password:");
+                DrawTextBox(&tbConfirmPassword);
+                DrawButton(&btnConfirmDelete);
+                DrawButton(&btnCancelDelete);
+                HandleTextBox(&tbConfirmPassword);
+                if (IsButtonClicked(&btnConfirmDelete)) {
+                    if (strcmp(tbConfirmPassword.text, currentUser.password) == 0) {
+                        initJob(&job, JOB_DELETE, currentUser.account_number);
+                        submitJob(&job, "Deleting account...");
+                    } else {
+                        strcpy(message, "Incorrect password!");
+                        messageTimer = timerIn(3.0);
+                    }
+                }
+                if (IsButtonClicked(&btnCancelDelete)) {
+                    currentState = USER_MENU;
+                }
+                break;
+            case PENDING:
+                DrawText(pendingText, contentInnerX + 40, 150, 25, BLACK);
+                {
+                    // Three dots lighting up in turn show the window is still live
+                    double t = GetTime();
+                    int lit = (int)(t * 4) % 3;
+                    wakeAt((double)((long long)(t * 4) + 1) / 4);
+                    for (int i = 0; i < 3; i++) {
+                        DrawCircle(contentInnerX + 60 + i * 30, 230, 8, i == lit ? (Color){25, 55, 109, 255} : (Color){200, 200, 210, 255});
+                    }
+                }
+                break;
+        }
+        // Display message if any
+        if (!timerExpired(messageTimer)) {
+            DrawText(message, gContentInnerX, gWinH - 40, 20, RED);
+        }
+
+        double frameEnd = profileNow();
+        profileSample(&drawProfile[drawnState], (frameEnd - frameStart) * 1000.0);
+        profileSpan(stateNames[drawnState], "draw", PROFILE_THREAD_UI, frameStart, frameEnd);
+        if (IsKeyPressed(KEY_F3)) {
+            profilerVisible = !profilerVisible;
+        } else if (IsKeyPressed(KEY_F4)) {
+            int spans = profileWriteTrace("bank_trace.json");
+            if (spans < 0) strcpy(message, "Could not write bank_trace.json");
+            else sprintf(message, "Saved %d spans to bank_trace.json", spans);
+            messageTimer = timerIn(3.0);
+            redrawAt = 0.0;  // show the message on the next frame
+        }
+        if (profilerVisible) DrawProfilerOverlay();
+        EndDrawing();
+    }
+    clientStopWorker();
+    CloseWindow();
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+#include "bank_core.h"
+#include "bank_metrics.h"
+
+// Histogram bucket upper bounds in microseconds; one more bucket catches everything slower
+#define LATENCY_BUCKETS 14
+const long long latencyBounds[LATENCY_BUCKETS] = {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000, 1000000};
+
+typedef struct {
+    unsigned long long buckets[LATENCY_BUCKETS + 1];   // not cumulative; summed when rendered
+    unsigned long long count;
+    unsigned long long sumNanos;
+} LatencyHistogram;
+
+unsigned long long metricCounters[METRIC_COUNTERS];
+LatencyHistogram metricLatencies[METRIC_LATENCIES];
+
+const char *latencyNames[METRIC_LATENCIES] = {
+    "login", "deposit", "withdraw", "create", "update", "delete", "history",
+    "journal", "ledger", "account_file", "fsync"
+};
+
+long long metricNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void metricCount(MetricCounter counter) {
+    __atomic_fetch_add(&metricCounters[counter], 1, __ATOMIC_RELAXED);
+}
+
+void metricLatency(MetricLatency latency, long long start) {
+    long long nanos = metricNow() - start;
+    if (nanos < 0) nanos = 0;
+    long long micros = nanos / 1000;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS && micros > latencyBounds[bucket]) bucket++;
+    LatencyHistogram *h = &metricLatencies[latency];
+    __atomic_fetch_add(&h->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sumNanos, (unsigned long long)nanos, __ATOMIC_RELAXED);
+}
+
+unsigned long long readMetric(const unsigned long long *value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+void bankRecordWithdrawVerify(int failed) {
+    metricCount(failed ? METRIC_VERIFY_FAILED : METRIC_LARGE_WITHDRAWALS);
+}
+
+// Append printf output to out, keeping *used within size
+void appendMetric(char *out, int size, int *used, const char *format, ...) {
+    if (*used >= size - 1) return;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(out + *used, size - *used, format, args);
+    va_end(args);
+    if (n > 0) *used = *used + n < size - 1 ? *used + n : size - 1;
+}
+
+int bankMetricsText(char *out, int size) {
+    int used = 0;
+    if (size <= 0) return 0;
+    out[0] = '\0';
+    appendMetric(out, size, &used, "# HELP bank_logins_total Login attempts by result.\n# TYPE bank_logins_total counter\n");
+    appendMetric(out, size, &used, "bank_logins_total{result=\"ok\"} %llu\n", readMetric(&metricCounters[METRIC_LOGIN_OK]));
+    appendMetric(out, size, &used, "bank_logins_total{result=\"failed\"} %llu\n", readMetric(&metricCounters[METRIC_LOGIN_FAILED]));
+    appendMetric(out, size, &used, "# HELP bank_deposits_total Deposits posted.\n# TYPE bank_deposits_total counter\nbank_deposits_total %llu\n",
+                 readMetric(&metricCounters[METRIC_DEPOSITS]));
+    appendMetric(out, size, &used, "# HELP bank_withdrawals_total Withdrawals posted.\n# TYPE bank_withdrawals_total counter\nbank_withdrawals_total %llu\n",
+                 readMetric(&metricCounters[METRIC_WITHDRAWALS]));
+    appendMetric(out, size, &used, "# HELP bank_large_withdrawals_total Postings that required the security question.\n# TYPE bank_large_withdrawals_total counter\nbank_large_withdrawals_total %llu\n",
+                 readMetric(&metricCounters[METRIC_LARGE_WITHDRAWALS]));
+    appendMetric(out, size, &used, "# HELP bank_verification_failures_total Wrong answers to the security question.\n# TYPE bank_verification_failures_total counter\nbank_verification_failures_total %llu\n",
+                 readMetric(&metricCounters[METRIC_VERIFY_FAILED]));
+    appendMetric(out, size, &used, "# HELP bank_velocity_blocked_total Postings refused by the velocity rules.\n# TYPE bank_velocity_blocked_total counter\nbank_velocity_blocked_total %llu\n",
+                 readMetric(&metricCounters[METRIC_VELOCITY_BLOCKED]));
+    appendMetric(out, size, &used, "# HELP bank_accounts_created_total Accounts created.\n# TYPE bank_accounts_created_total counter\nbank_accounts_created_total %llu\n",
+                 readMetric(&metricCounters[METRIC_ACCOUNTS_CREATED]));
+    appendMetric(out, size, &used, "# HELP bank_accounts_deleted_total Accounts deleted.\n# TYPE bank_accounts_deleted_total counter\nbank_accounts_deleted_total %llu\n",
+                 readMetric(&metricCounters[METRIC_ACCOUNTS_DELETED]));
+    appendMetric(out, size, &used, "# HELP bank_accounts Live accounts.\n# TYPE bank_accounts gauge\nbank_accounts %d\n", bankAccountCount());
+    appendMetric(out, size, &used, "# HELP bank_group_commits_total Group commit sync rounds.\n# TYPE bank_group_commits_total counter\nbank_group_commits_total %lld\n", bankCommitRounds());
+
+    for (int kind = 0; kind < 2; kind++) {
+        // Whole operations first, then the storage writes inside them
+        const char *name = kind == 0 ? "bank_operation_seconds" : "bank_storage_seconds";
+        int first = kind == 0 ? LATENCY_LOGIN : LATENCY_JOURNAL;
+        int last = kind == 0 ? LATENCY_HISTORY : LATENCY_FSYNC;
+        appendMetric(out, size, &used, "# HELP %s %s latency.\n# TYPE %s histogram\n", name, kind == 0 ? "Operation" : "Storage write", name);
+        for (int i = first; i <= last; i++) {
+            const LatencyHistogram *h = &metricLatencies[i];
+            unsigned long long cumulative = 0;
+            for (int b = 0; b < LATENCY_BUCKETS; b++) {
+                cumulative += readMetric(&h->buckets[b]);
+                appendMetric(out, size, &used, "%s_bucket{op=\"%s\",le=\"%g\"} %llu\n", name, latencyNames[i], latencyBounds[b] / 1e6, cumulative);
+            }
+            cumulative += readMetric(&h->buckets[LATENCY_BUCKETS]);
+            appendMetric(out, size, &used, "%s_bucket{op=\"%s\",le=\"+Inf\"} %llu\n", name, latencyNames[i], cumulative);
+            appendMetric(out, size, &used, "%s_sum{op=\"%s\"} %.9f\n", name, latencyNames[i], readMetric(&h->sumNanos) / 1e9);
+            appendMetric(out, size, &used, "%s_count{op=\"%s\"} %llu\n", name, latencyNames[i], readMetric(&h->count));
+        }
+    }
+    return used;
+}
+
+// Metrics file - rewritten whole (temp file + rename) so a scraper never reads half of it
+#define METRICS_TEXT_MAX 32768
+
+pthread_t metricsThread;
+int metricsRunning = 0;
+int metricsInterval = 0;
+char metricsPath[256];
+pthread_mutex_t metricsLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t metricsStop = PTHREAD_COND_INITIALIZER;
+char metricsText[METRICS_TEXT_MAX];
+
+void writeMetricsFile() {
+    char tmpPath[272];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", metricsPath);
+    int length = bankMetricsText(metricsText, METRICS_TEXT_MAX);
+    FILE *f = fopen(tmpPath, "w");
+    if (!f) return;
+    int ok = fwrite(metricsText, 1, length, f) == (size_t)length;
+    if (fclose(f) != 0) ok = 0;
+#ifdef _WIN32
+    if (ok) remove(metricsPath);  // rename() does not replace an existing file on Windows
+#endif
+    if (!ok || rename(tmpPath, metricsPath) != 0) remove(tmpPath);
+}
+
+void *metricsMain(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&metricsLock);
+    while (metricsRunning) {
+        writeMetricsFile();
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += metricsInterval;
+        pthread_cond_timedwait(&metricsStop, &metricsLock, &deadline);
+    }
+    pthread_mutex_unlock(&metricsLock);
+    return NULL;
+}
+
+void bankStartMetricsFile(const char *path, int intervalSeconds) {
+    pthread_mutex_lock(&metricsLock);
+    if (!metricsRunning) {
+        snprintf(metricsPath, sizeof(metricsPath), "%s", path);
+        metricsRunning = 1;
+        metricsInterval = intervalSeconds > 0 ? intervalSeconds : 1;
+        pthread_create(&metricsThread, NULL, metricsMain, NULL);
+    }
+    pthread_mutex_unlock(&metricsLock);
+}
+
+// Stop the file writer after one last rewrite - called by bankClose() while the data is still open
+void stopMetricsFile(void) {
+    pthread_mutex_lock(&metricsLock);
+    int running = metricsRunning;
+    metricsRunning = 0;
+    pthread_cond_signal(&metricsStop);
+    pthread_mutex_unlock(&metricsLock);
+    if (running) {
+        pthread_join(metricsThread, NULL);
+        writeMetricsFile();
+    }
+}
@@ -0,0 +1,126 @@
+#include <string.h>
+#include "bank_money.h"
+
+int moneyParse(const char *text, Money *out) {
+    const char *p = text;
+    int negative = *p == '-';
+    if (negative) p++;
+    long long rupees = 0;
+    int digits = 0;
+    while (*p >= '0' && *p <= '9') {
+        rupees = rupees * 10 + (*p++ - '0');
+        if (rupees >= MONEY_MAX_RUPEES) return 0;
+        digits++;
+    }
+    long long paisa = 0;
+    if (*p == '.') {
+        p++;
+        int decimals = 0;
+        while (*p >= '0' && *p <= '9') {
+            if (++decimals > 2) return 0;
+            paisa = paisa * 10 + (*p++ - '0');
+        }
+        if (decimals == 1) paisa *= 10;
+        digits += decimals;
+    }
+    if (digits == 0) return 0;
+    Money value = rupees * 100 + paisa;
+    *out = negative ? -value : value;
+    return (int)(p - text);
+}
+
+int moneyFormat(Money value, char *out) {
+    // Digits are produced backwards into the end of a scratch buffer, paisa first
+    char digits[MONEY_TEXT_MAX];
+    int pos = MONEY_TEXT_MAX;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    digits[--pos] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+    digits[--pos] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+    digits[--pos] = '.';
+    do {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) digits[--pos] = '-';
+    int length = MONEY_TEXT_MAX - pos;
+    memcpy(out, digits + pos, length);
+    out[length] = '\0';
+    return length;
+}
+
+Money moneyFromDouble(double rupees) {
+    double paisa = rupees * 100.0;
+    if (!(paisa < 9.0e18 && paisa > -9.0e18)) return 0;   // out of range, or NaN
+    return (Money)(paisa >= 0 ? paisa + 0.5 : paisa - 0.5);
+}
+
+// Copy a non-empty text field up to the next comma into dest (size bytes); returns the
+// characters read, 0 if the field is empty or does not fit
+int parseRecordField(const char *text, char *dest, int size) {
+    int n = 0;
+    while (text[n] != ',' && text[n] != '\0' && text[n] != '\n') {
+        if (n == size - 1) return 0;
+        dest[n] = text[n];
+        n++;
+    }
+    dest[n] = '\0';
+    return n;
+}
+
+int accountParseRecord(const char *text, Account *out) {
+    char *fields[5] = {out->name, out->father_name, out->mobile_number, out->address, out->password};
+    const int sizes[5] = {(int)sizeof(out->name), (int)sizeof(out->father_name), (int)sizeof(out->mobile_number),
+                          (int)sizeof(out->address), (int)sizeof(out->password)};
+    const char *p = text;
+    for (int f = 0; f < 5; f++) {
+        int n = parseRecordField(p, fields[f], sizes[f]);
+        if (n == 0 || p[n] != ',') return 0;
+        p += n + 1;
+    }
+    int negative = *p == '-';
+    if (negative) p++;
+    if (*p < '0' || *p > '9') return 0;
+    long long number = 0;
+    while (*p >= '0' && *p <= '9') {
+        number = number * 10 + (*p++ - '0');
+        if (number > 2147483647LL) return 0;
+    }
+    if (*p++ != ',') return 0;
+    out->account_number = (int)(negative ? -number : number);
+    int n = moneyParse(p, &out->balance);
+    if (n == 0) return 0;
+    return (int)(p + n - text);
+}
+
+// Append the string src at out + pos; returns the new position
+int appendText(char *out, int pos, const char *src) {
+    while (*src) out[pos++] = *src++;
+    return pos;
+}
+
+int accountFormatRecord(const Account *acc, char *out) {
+    int pos = appendText(out, 0, acc->name);
+    out[pos++] = ',';
+    pos = appendText(out, pos, acc->father_name);
+    out[pos++] = ',';
+    pos = appendText(out, pos, acc->mobile_number);
+    out[pos++] = ',';
+    pos = appendText(out, pos, acc->address);
+    out[pos++] = ',';
+    pos = appendText(out, pos, acc->password);
+    out[pos++] = ',';
+    char digits[12];
+    int d = 12;
+    unsigned int magnitude = acc->account_number < 0 ? 0u - (unsigned int)acc->account_number : (unsigned int)acc->account_number;
+    do {
+        digits[--d] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (acc->account_number < 0) digits[--d] = '-';
+    memcpy(out + pos, digits + d, 12 - d);
+    pos += 12 - d;
+    out[pos++] = ',';
+    return pos + moneyFormat(acc->balance, out + pos);
+}
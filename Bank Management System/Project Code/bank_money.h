@@ -0,0 +1,43 @@
+#ifndef BANK_MONEY_H
+#define BANK_MONEY_H
+
+#include "bank_core.h"
+
+// Money as text - "<rupees>.<paisa>", as the protocol, the journal, statements and the old
+// accounts.txt carry it. Hand-written single-pass parsers and formatters for amounts and for the
+// whole account record line: no locale, no allocation and no floating point, so a value read
+// back is exactly the one written.
+
+#define MONEY_TEXT_MAX 24        // "-92233720368547758.08" and the terminator
+#define MONEY_MAX_RUPEES 10000000000000000LL   // parsed amounts stay below this (1e16)
+#define MONEY_MAX 9223372036854775807LL         // largest balance; postings that would pass it fail
+#define ACCOUNT_RECORD_MAX 272   // a record with every field at its longest, and the terminator
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parse an amount - optional '-', digits, then optionally '.' and one or two decimals - at
+// the start of text into *out; returns the characters read, 0 if text does not start with an
+// amount, it has more than two decimals or it is MONEY_MAX_RUPEES or more
+int moneyParse(const char *text, Money *out);
+// Write value as "1234.50" ("-0.05" when negative) into out, which needs MONEY_TEXT_MAX bytes;
+// returns the length
+int moneyFormat(Money value, char *out);
+// Nearest Money to an amount of rupees held as floating point - for data written before Money
+Money moneyFromDouble(double rupees);
+
+// The account record "name,father_name,mobile,address,password,account_number,balance" - the
+// line of the old accounts.txt and the protocol's <account>. Parses one at the start of text
+// into out; returns the characters read, 0 if it is malformed. As with the old sscanf format,
+// text fields must be non-empty and fit their Account member, and anything after the balance
+// is left unread.
+int accountParseRecord(const char *text, Account *out);
+// Write acc as a record, without a newline, into out (ACCOUNT_RECORD_MAX bytes); returns the length
+int accountFormatRecord(const Account *acc, char *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+#include <string.h>
+#include "bank_net.h"
+
+int netStartup(void) {
+#ifdef _WIN32
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    return 1;
+#endif
+}
+
+void netInitConn(NetConn *conn, socket_t sock) {
+    conn->sock = sock;
+    conn->start = 0;
+    conn->end = 0;
+}
+
+// Next byte of the connection into *c; returns 1, 0 on EOF and -1 on error
+int netReadByte(NetConn *conn, char *c) {
+    if (conn->start == conn->end) {
+        int n = recv(conn->sock, conn->buffer, sizeof(conn->buffer), 0);
+        if (n <= 0) return n < 0 ? -1 : 0;
+        conn->start = 0;
+        conn->end = n;
+    }
+    *c = conn->buffer[conn->start++];
+    return 1;
+}
+
+int netReadLine(NetConn *conn, char *line, int size) {
+    int len = 0;
+    char c = 0;
+    while (len < size - 1) {
+        int got = netReadByte(conn, &c);
+        if (got < 0) return -1;
+        if (got == 0) break;
+        line[len++] = c;
+        if (c == '\n') break;
+    }
+    line[len] = '\0';
+    if (len < size - 1 || c == '\n') return len;
+    // No room left before the end of the line: drop the rest of it too
+    int got;
+    while ((got = netReadByte(conn, &c)) > 0 && c != '\n') {
+    }
+    if (got < 0) return -1;
+    line[0] = '\0';
+    return NET_LINE_TOO_LONG;
+}
+
+int netSendAll(socket_t sock, const char *data, int len) {
+    while (len > 0) {
+        int n = send(sock, data, len, 0);
+        if (n <= 0) return 0;
+        data += n;
+        len -= n;
+    }
+    return 1;
+}
+
+socket_t netConnect(const char *host, int port) {
+    socket_t sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == INVALID_SOCKET) return INVALID_SOCKET;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = inet_addr(host);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        closeSocket(sock);
+        return INVALID_SOCKET;
+    }
+    // Requests are small and answered one at a time - don't let Nagle delay them
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+    return sock;
+}
+
+void netSetReadTimeout(socket_t sock, int millis) {
+#ifdef _WIN32
+    DWORD timeout = (DWORD)millis;
+#else
+    struct timeval timeout;
+    timeout.tv_sec = millis / 1000;
+    timeout.tv_usec = (millis % 1000) * 1000;
+#endif
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+}
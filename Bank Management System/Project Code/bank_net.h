@@ -0,0 +1,49 @@
+#ifndef BANK_NET_H
+#define BANK_NET_H
+
+// Small socket layer shared by bank_server and the client - loopback TCP,
+// line-oriented, with the Winsock differences hidden behind a few names.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define closeSocket closesocket
+#define SHUT_RDWR SD_BOTH
+#define SHUT_RD SD_BOTH   // SD_RECEIVE need not wake a recv() that is already waiting
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define closeSocket close
+#endif
+
+// Buffered reader over one connection
+typedef struct {
+    socket_t sock;
+    char buffer[4096];
+    int start;
+    int end;
+} NetConn;
+
+// Call once before any socket use (starts Winsock on Windows)
+int netStartup(void);
+void netInitConn(NetConn *conn, socket_t sock);
+#define NET_LINE_TOO_LONG (-2)
+
+// Read one line including its '\n' into line, returns its length, 0 on EOF and -1 on error.
+// A line that does not fit is read to its end and dropped, returning NET_LINE_TOO_LONG.
+int netReadLine(NetConn *conn, char *line, int size);
+// Send all len bytes, returns 1 on success
+int netSendAll(socket_t sock, const char *data, int len);
+// Connect to host:port, returns INVALID_SOCKET on failure
+socket_t netConnect(const char *host, int port);
+// Make a recv() that waits longer than millis fail, so netReadLine returns -1
+void netSetReadTimeout(socket_t sock, int millis);
+
+#endif
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "bank_profile.h"
+
+typedef struct {
+    const char *name;
+    const char *category;
+    int thread;
+    double start;
+    double end;
+} ProfileSpan;
+
+ProfileSpan profileSpans[PROFILE_SPANS];
+int profileSpanNext = 0;
+int profileSpanCount = 0;
+double profileEpoch = -1.0;   // first profileNow() seen by a span; trace timestamps start there
+
+double profileNow(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+void profileSample(ProfileSeries *series, double ms) {
+    series->samples[series->next] = (float)ms;
+    series->next = (series->next + 1) % PROFILE_WINDOW;
+    if (series->count < PROFILE_WINDOW) series->count++;
+}
+
+float profileSampleAt(const ProfileSeries *series, int i) {
+    int oldest = (series->next - series->count + PROFILE_WINDOW) % PROFILE_WINDOW;
+    return series->samples[(oldest + i) % PROFILE_WINDOW];
+}
+
+double profileMean(const ProfileSeries *series) {
+    if (series->count == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < series->count; i++) sum += series->samples[i];
+    return sum / series->count;
+}
+
+double profileMax(const ProfileSeries *series) {
+    double max = 0.0;
+    for (int i = 0; i < series->count; i++) {
+        if (series->samples[i] > max) max = series->samples[i];
+    }
+    return max;
+}
+
+void profileSpan(const char *name, const char *category, int thread, double start, double end) {
+    if (profileEpoch < 0 || start < profileEpoch) profileEpoch = start;
+    ProfileSpan *span = &profileSpans[profileSpanNext];
+    span->name = name;
+    span->category = category;
+    span->thread = thread;
+    span->start = start;
+    span->end = end;
+    profileSpanNext = (profileSpanNext + 1) % PROFILE_SPANS;
+    if (profileSpanCount < PROFILE_SPANS) profileSpanCount++;
+}
+
+int profileWriteTrace(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"ui\"}},\n", PROFILE_THREAD_UI);
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"io worker\"}}", PROFILE_THREAD_IO);
+    int oldest = (profileSpanNext - profileSpanCount + PROFILE_SPANS) % PROFILE_SPANS;
+    for (int i = 0; i < profileSpanCount; i++) {
+        const ProfileSpan *span = &profileSpans[(oldest + i) % PROFILE_SPANS];
+        // Complete events: ts and dur are microseconds
+        fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                span->name, span->category, span->thread, (span->start - profileEpoch) * 1e6, (span->end - span->start) * 1e6);
+    }
+    fprintf(f, "\n]}\n");
+    int ok = ferror(f) == 0;
+    if (fclose(f) != 0) ok = 0;
+    return ok ? profileSpanCount : -1;
+}
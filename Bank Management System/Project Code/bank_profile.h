@@ -0,0 +1,42 @@
+#ifndef BANK_PROFILE_H
+#define BANK_PROFILE_H
+
+// Frame and I/O profiler for the raylib client. Rolling sample windows feed the on-screen
+// overlay, and a log of the most recent spans can be written as a Chrome trace
+// (load it in chrome://tracing or ui.perfetto.dev). Only the UI thread records.
+
+#define PROFILE_WINDOW 120    // samples per series shown in the overlay histograms
+#define PROFILE_SPANS 8192    // spans kept for the trace; the oldest are overwritten
+
+#define PROFILE_THREAD_UI 1
+#define PROFILE_THREAD_IO 2
+
+typedef struct {
+    float samples[PROFILE_WINDOW];   // milliseconds, oldest first from next
+    int next;
+    int count;
+} ProfileSeries;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Monotonic seconds; shared by the UI and the I/O worker so their spans line up
+double profileNow(void);
+
+void profileSample(ProfileSeries *series, double ms);
+// Sample i of the window, 0 = oldest
+float profileSampleAt(const ProfileSeries *series, int i);
+double profileMean(const ProfileSeries *series);
+double profileMax(const ProfileSeries *series);
+
+// name and category must be string literals (or otherwise outlive the trace)
+void profileSpan(const char *name, const char *category, int thread, double start, double end);
+// Write the recorded spans as Chrome trace JSON; returns how many were written, -1 on error
+int profileWriteTrace(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+#include "bank_core.h"
+#include "bank_money.h"
+
+// Line protocol - one request per line, comma separated, answered by one status line:
+//   OK [<result>]        or        ERR <status code> <message>
+//
+//   create,<name>,<father name>,<mobile>,<address>,<password>   -> OK <account number>
+//   login,<mobile>,<password>                                   -> OK <account>
+//   logout                                                      -> OK
+//   get,<account>            (alias: balance)                   -> OK <account>
+//   deposit,<account>,<amount>[,<answer>]                       -> OK <account>
+//   withdraw,<account>,<amount>[,<answer>]                      -> OK <account>
+//   question,<account>                                          -> OK <security question number>
+//   update,<account>,<name>,<father name>,<address>,<password>  -> OK <account>
+//   delete,<account>                                            -> OK
+//   count                                                       -> OK <number of accounts>
+//   history,<account>[,<first>,<count>]                         -> OK <total> <n>, then n lines
+// and for admin sessions only:
+//   admin,<key>              (makes the session an admin one)   -> OK
+//   deposit|withdraw,<account>,<amount>,verified  (staff verified the customer) -> OK <account>
+//   undelete,<account>                                          -> OK <account>
+//   compact                                                     -> OK <accounts removed>
+//   statements,<from>,<to>,<directory>[,<workers>]  (dd/mm/yyyy) -> OK <statements written>
+//   reconcile,<report>,full|incremental[,<workers>]             -> OK <accounts checked> <discrepancies>
+//   class,<account>,<interest class>                            -> OK
+//   interest,<days>                                             -> OK <accounts credited> <total interest>
+//
+// <account> in a request must be the account logged in on the session (any account for an
+// admin session), otherwise the request fails with BANK_ERR_DENIED. The statements directory
+// and the report are plain names (letters, digits, '_', '-' and '.') under BANK_REPORT_DIR.
+// A deposit or withdrawal the velocity rules hold for the security question fails with
+// BANK_ERR_VERIFY. The client asks "question" which one to put to the customer (the session
+// picks it, and keeps it until answered) and sends the request again with the answer, which
+// the core checks against the profile. A wrong answer fails with BANK_ERR_AUTH and logs the
+// session out. The answer is the rest of the line, commas included.
+// <account> is name,father_name,mobile,address,password,account_number,balance (the old
+// accounts.txt line) and history lines are timestamp,type,amount,balance. Amounts are
+// <rupees>[.<paisa>] with at most two decimals.
+
+#define MAX_FIELDS 8
+#define ADMIN_KEY_MAX 128
+
+char adminKey[ADMIN_KEY_MAX] = "";
+
+void bankInitSession(BankSession *session, int admin) {
+    session->account_number = 0;
+    session->admin = admin;
+    session->question = -1;
+    session->questionAccount = 0;
+}
+
+void bankSetAdminKey(const char *key) {
+    snprintf(adminKey, sizeof(adminKey), "%s", key ? key : "");
+}
+
+// Compare every byte whatever the first difference, so the time taken gives nothing away
+int adminKeyMatches(const char *key) {
+    size_t length = strlen(adminKey);
+    if (length == 0 || strlen(key) != length) return 0;
+    int diff = 0;
+    for (size_t i = 0; i < length; i++) diff |= adminKey[i] ^ key[i];
+    return diff == 0;
+}
+
+// May the session act on account_number?
+int sessionOwns(const BankSession *session, int account_number) {
+    return session->admin || (session->account_number != 0 && session->account_number == account_number);
+}
+
+// Undo the split from field first on, so it holds the rest of the line
+char *joinFields(char *f[], int first, int n) {
+    for (int i = first + 1; i < n; i++) f[i][-1] = ',';
+    return f[first];
+}
+
+// BANK_REPORT_DIR/name for a statements directory or report named by a client; returns 0 unless
+// name is a plain file name, so nothing outside BANK_REPORT_DIR can be written
+int reportPath(const char *name, char *path, int size) {
+    if (name[0] == '\0' || name[0] == '.' || strlen(name) > 64) return 0;
+    for (const char *p = name; *p; p++) {
+        if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_' || *p == '-' || *p == '.')) return 0;
+    }
+#ifdef _WIN32
+    _mkdir(BANK_REPORT_DIR);
+#else
+    mkdir(BANK_REPORT_DIR, 0755);
+#endif
+    snprintf(path, size, "%s/%s", BANK_REPORT_DIR, name);
+    return 1;
+}
+
+// Split a line in place on commas, returns the number of fields
+int splitFields(char *line, char *fields[], int maxFields) {
+    int n = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    char *p = line;
+    while (n < maxFields) {
+        fields[n++] = p;
+        char *comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
+    }
+    return n;
+}
+
+// Copy a field into a fixed-size Account member
+void copyField(char *dest, size_t size, const char *src) {
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
+
+int formatAccountReply(const Account *acc, char *reply, int replySize) {
+    char record[ACCOUNT_RECORD_MAX];
+    accountFormatRecord(acc, record);
+    return snprintf(reply, replySize, "OK %s\n", record);
+}
+
+// A whole field holding an amount; returns 0 for anything else
+int parseAmountField(const char *field, Money *amount) {
+    int used = moneyParse(field, amount);
+    return used > 0 && field[used] == '\0';
+}
+
+// Reply with up to count history entries starting at first, as many as fit in the buffer
+void formatHistoryReply(int account_number, int first, int count, char *reply, int replySize) {
+    int total = bankHistoryCount(account_number);
+    if (first < 0) first = 0;
+    if (count < 0 || first + count > total) count = total > first ? total - first : 0;
+
+    // Entries go after room for the status line, which is written last once n is known
+    char status[48];
+    int headerRoom = (int)sizeof(status);
+    int used = headerRoom;
+    int n = 0;
+    LedgerRecord rec;
+    for (; n < count; n++) {
+        if (!bankHistoryEntry(account_number, first + n, &rec)) break;
+        char amount[MONEY_TEXT_MAX];
+        char balance[MONEY_TEXT_MAX];
+        moneyFormat(rec.amount, amount);
+        moneyFormat(rec.balance, balance);
+        int len = snprintf(reply + used, replySize - used, "%lld,%d,%s,%s\n", rec.timestamp, rec.type, amount, balance);
+        if (len < 0 || used + len >= replySize) break;
+        used += len;
+    }
+    int statusLen = snprintf(status, sizeof(status), "OK %d %d\n", total, n);
+    memmove(reply + statusLen, reply + headerRoom, used - headerRoom);
+    memcpy(reply, status, statusLen);
+    reply[statusLen + used - headerRoom] = '\0';
+}
+
+BankStatus bankExecute(BankSession *session, char *request, char *reply, int replySize) {
+    char *f[MAX_FIELDS];
+    int n = splitFields(request, f, MAX_FIELDS);
+    const char *op = f[0];
+    Account acc;
+    BankStatus status = BANK_ERR_INVALID;
+    memset(&acc, 0, sizeof(acc));
+    // Every request naming an account has it in f[1]
+    int account_number = n >= 2 ? atoi(f[1]) : 0;
+    int owns = sessionOwns(session, account_number);
+
+    if (strcmp(op, "create") == 0 && n == 6) {
+        copyField(acc.name, sizeof(acc.name), f[1]);
+        copyField(acc.father_name, sizeof(acc.father_name), f[2]);
+        copyField(acc.mobile_number, sizeof(acc.mobile_number), f[3]);
+        copyField(acc.address, sizeof(acc.address), f[4]);
+        copyField(acc.password, sizeof(acc.password), f[5]);
+        status = bankCreateAccount(&acc);
+        if (status == BANK_OK) snprintf(reply, replySize, "OK %d\n", acc.account_number);
+    } else if (strcmp(op, "login") == 0 && n == 3) {
+        session->account_number = 0;
+        session->question = -1;
+        status = bankLogin(f[1], f[2], &acc);
+        if (status == BANK_OK) {
+            session->account_number = acc.account_number;
+            formatAccountReply(&acc, reply, replySize);
+        }
+    } else if (strcmp(op, "logout") == 0 && n == 1) {
+        session->account_number = 0;
+        session->question = -1;
+        status = BANK_OK;
+        snprintf(reply, replySize, "OK\n");
+    } else if (strcmp(op, "admin") == 0 && n == 2) {
+        status = adminKeyMatches(f[1]) ? BANK_OK : BANK_ERR_AUTH;
+        if (status == BANK_OK) {
+            session->admin = 1;
+            snprintf(reply, replySize, "OK\n");
+        }
+    } else if (strcmp(op, "count") == 0 && n == 1) {
+        status = BANK_OK;
+        snprintf(reply, replySize, "OK %d\n", bankAccountCount());
+    } else if ((strcmp(op, "get") == 0 || strcmp(op, "balance") == 0) && n == 2) {
+        status = owns ? bankGetAccount(account_number, &acc) : BANK_ERR_DENIED;
+        if (status == BANK_OK) formatAccountReply(&acc, reply, replySize);
+    } else if ((strcmp(op, "deposit") == 0 || strcmp(op, "withdraw") == 0) && n >= 3) {
+        int deposit = op[0] == 'd';
+        int staffVerified = session->admin && n == 4 && strcmp(f[3], "verified") == 0;
+        Money amount = 0;
+        if (!owns) {
+            status = BANK_ERR_DENIED;
+        } else if (!parseAmountField(f[2], &amount)) {
+            status = BANK_ERR_AMOUNT;
+        } else if (staffVerified) {
+            status = deposit ? bankDepositVerified(account_number, amount, &acc) : bankWithdrawVerified(account_number, amount, &acc);
+        } else if (n >= 4) {
+            // One answer per question: right or wrong, the next held posting needs a new one
+            int question = session->questionAccount == account_number ? session->question : -1;
+            session->question = -1;
+            if (question < 0) status = BANK_ERR_VERIFY;
+            else if (deposit) status = bankDepositAnswered(account_number, amount, question, joinFields(f, 3, n), &acc);
+            else status = bankWithdrawAnswered(account_number, amount, question, joinFields(f, 3, n), &acc);
+            if (status == BANK_ERR_AUTH) session->account_number = 0;
+        } else {
+            status = deposit ? bankDeposit(account_number, amount, &acc) : bankWithdraw(account_number, amount, &acc);
+        }
+        if (status == BANK_OK) formatAccountReply(&acc, reply, replySize);
+    } else if (strcmp(op, "question") == 0 && n == 2) {
+        status = owns ? bankGetAccount(account_number, &acc) : BANK_ERR_DENIED;
+        if (status == BANK_OK) {
+            // Asking again gets the same question, so a client cannot pick an easier one
+            if (session->question < 0 || session->questionAccount != account_number) {
+                session->question = rand() % BANK_SECURITY_QUESTIONS;
+                session->questionAccount = account_number;
+                bankRecordWithdrawVerify(0);
+            }
+            snprintf(reply, replySize, "OK %d\n", session->question);
+        }
+    } else if (strcmp(op, "update") == 0 && n == 6) {
+        acc.account_number = account_number;
+        copyField(acc.name, sizeof(acc.name), f[2]);
+        copyField(acc.father_name, sizeof(acc.father_name), f[3]);
+        copyField(acc.address, sizeof(acc.address), f[4]);
+        copyField(acc.password, sizeof(acc.password), f[5]);
+        status = owns ? bankUpdateAccount(&acc) : BANK_ERR_DENIED;
+        if (status == BANK_OK) status = bankGetAccount(account_number, &acc);
+        if (status == BANK_OK) formatAccountReply(&acc, reply, replySize);
+    } else if (strcmp(op, "delete") == 0 && n == 2) {
+        status = owns ? bankDeleteAccount(account_number) : BANK_ERR_DENIED;
+        if (status == BANK_OK) {
+            if (session->account_number == account_number) session->account_number = 0;
+            snprintf(reply, replySize, "OK\n");
+        }
+    } else if (strcmp(op, "history") == 0 && (n == 2 || n == 4)) {
+        status = owns ? bankGetAccount(account_number, &acc) : BANK_ERR_DENIED;
+        if (status == BANK_OK) formatHistoryReply(account_number, n == 4 ? atoi(f[2]) : 0, n == 4 ? atoi(f[3]) : -1, reply, replySize);
+    } else if (!session->admin && (strcmp(op, "undelete") == 0 || strcmp(op, "compact") == 0 || strcmp(op, "class") == 0 ||
+                                   strcmp(op, "interest") == 0 || strcmp(op, "statements") == 0 || strcmp(op, "reconcile") == 0)) {
+        status = BANK_ERR_DENIED;
+    } else if (strcmp(op, "undelete") == 0 && n == 2) {
+        status = bankUndeleteAccount(account_number, &acc);
+        if (status == BANK_OK) formatAccountReply(&acc, reply, replySize);
+    } else if (strcmp(op, "compact") == 0 && n == 1) {
+        status = BANK_OK;
+        snprintf(reply, replySize, "OK %d\n", bankCompact());
+    } else if (strcmp(op, "statements") == 0 && (n == 4 || n == 5)) {
+        long long from = bankParseDate(f[1]);
+        long long to = bankParseDate(f[2]);
+        char dir[128];
+        if (from >= 0 && to >= from && reportPath(f[3], dir, sizeof(dir))) {
+            int written = bankStatements(from, to + 24 * 3600 - 1, dir, n == 5 ? atoi(f[4]) : 0);
+            status = written >= 0 ? BANK_OK : BANK_ERR_IO;
+            if (status == BANK_OK) snprintf(reply, replySize, "OK %d\n", written);
+        }
+    } else if (strcmp(op, "reconcile") == 0 && (n == 3 || n == 4) &&
+               (strcmp(f[2], "full") == 0 || strcmp(f[2], "incremental") == 0)) {
+        char path[128];
+        if (reportPath(f[1], path, sizeof(path))) {
+            int checked = 0;
+            int found = bankReconcile(path, strcmp(f[2], "incremental") == 0, n == 4 ? atoi(f[3]) : 0, &checked);
+            status = found >= 0 ? BANK_OK : BANK_ERR_IO;
+            if (status == BANK_OK) snprintf(reply, replySize, "OK %d %d\n", checked, found);
+        }
+    } else if (strcmp(op, "class") == 0 && n == 3) {
+        status = bankSetAccountClass(account_number, atoi(f[2]));
+        if (status == BANK_OK) snprintf(reply, replySize, "OK\n");
+    } else if (strcmp(op, "interest") == 0 && n == 2 && atoi(f[1]) >= 1 && atoi(f[1]) <= 365) {
+        Money total = 0;
+        char text[MONEY_TEXT_MAX];
+        int credited = bankAccrueInterest(atoi(f[1]), &total);
+        status = credited >= 0 ? BANK_OK : BANK_ERR_IO;
+        moneyFormat(total, text);
+        if (status == BANK_OK) snprintf(reply, replySize, "OK %d %s\n", credited, text);
+    }
+
+    if (status != BANK_OK) {
+        snprintf(reply, replySize, "ERR %d %s\n", (int)status, bankStatusMessage(status));
+    }
+    return status;
+}
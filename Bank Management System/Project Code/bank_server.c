@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+#include "bank_core.h"
+#include "bank_net.h"
+
+// Multi-session server - owns the data files in the current directory and serves the
+// line protocol (bank_protocol.c) to tellers, kiosks and the raylib client over loopback TCP.
+// Each connection is a session handled by one worker of a fixed thread pool for as long as it
+// stays open, so the server takes at most as many sessions as it has workers: a connection
+// beyond that is answered with BANK_ERR_BUSY and closed. The core's per-account locks let
+// sessions posting to different accounts run in parallel.
+//
+// Usage: bank_server [-p port] [-t threads] [-g micros] [-b batch] [-r days] [-m port] [-M file] [-c seconds] [-a days] [-v rules] [-i rates] [-k keyfile]
+//   -p, -t  port and worker count - the most sessions at once (defaults: 5125, 32 threads, at most 256)
+//   -g      group commit: postings are acknowledged once fsynced, and postings arriving within
+//           this many microseconds share one fsync (0 = share only what queues up during a sync)
+//   -b      most postings per group commit (default: no limit)
+//   -r      days a deleted account stays restorable (default: 30); compaction runs hourly
+//   -m      serve metrics for Prometheus at http://127.0.0.1:<port>/metrics (default: off)
+//   -M      rewrite this file with the metrics every 15 seconds, for the node_exporter textfile
+//           collector (default: off)
+//   -c      seconds between ledger checkpoints, which bound the startup scan (default: 300, 0 = off)
+//   -a      days after which compaction moves ledger segments to the compressed archive (default: 90, -1 = never)
+//   -v      file of velocity rules for deposits and withdrawals (see bankSetVelocityRules)
+//   -i      file of interest rates per account class (see bankSetInterestRates)
+//   -k      file whose first line is the admin key: a session that sends "admin,<key>" may use
+//           every account and the admin operations (default: none - they are bank_cli only)
+// A session acts only on the account it logged in to (see bank_protocol.c).
+// A session ends when the client disconnects or sends "quit". Ctrl+C stops the server.
+
+#define SESSION_QUEUE_SIZE 256
+#define METRICS_REPLY_MAX 65536
+#define METRICS_READ_TIMEOUT_MS 2000   // a scrape that goes quiet this long is dropped
+#define METRICS_HEADER_LINES 100
+#define METRICS_FILE_SECONDS 15
+
+// Accepted connections waiting for a free worker, and the ones being served
+typedef struct {
+    socket_t items[SESSION_QUEUE_SIZE];
+    int head;
+    int count;
+    int stopping;
+    int limit;           // workers; queued plus served sessions stay within it
+    int active;          // sessions being served
+    socket_t *live;      // live[worker] = the connection that worker serves, or INVALID_SOCKET
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+} SessionQueue;
+
+SessionQueue sessions = {{0}, 0, 0, 0, 0, 0, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+volatile sig_atomic_t serverStopping = 0;
+socket_t listenSocket = INVALID_SOCKET;
+socket_t metricsSocket = INVALID_SOCKET;
+volatile socket_t metricsClient = INVALID_SOCKET;   // the scrape being answered
+
+// Listening TCP socket on 127.0.0.1:port, or INVALID_SOCKET
+socket_t listenLoopback(int port) {
+    socket_t sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == INVALID_SOCKET) return INVALID_SOCKET;
+    int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // local sessions only
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(sock, 64) != 0) {
+        closeSocket(sock);
+        return INVALID_SOCKET;
+    }
+    return sock;
+}
+
+// Queue a connection for a worker; returns 0 when every worker already has a session
+int pushSession(socket_t sock) {
+    pthread_mutex_lock(&sessions.lock);
+    int admitted = !sessions.stopping && sessions.count + sessions.active < sessions.limit;
+    if (admitted) {
+        sessions.items[(sessions.head + sessions.count) % SESSION_QUEUE_SIZE] = sock;
+        sessions.count++;
+        pthread_cond_signal(&sessions.notEmpty);
+    }
+    pthread_mutex_unlock(&sessions.lock);
+    return admitted;
+}
+
+// Next connection for worker to serve, or INVALID_SOCKET once the server is stopping
+socket_t popSession(int worker) {
+    pthread_mutex_lock(&sessions.lock);
+    while (sessions.count == 0 && !sessions.stopping) {
+        pthread_cond_wait(&sessions.notEmpty, &sessions.lock);
+    }
+    socket_t sock = INVALID_SOCKET;
+    if (!sessions.stopping) {
+        sock = sessions.items[sessions.head];
+        sessions.head = (sessions.head + 1) % SESSION_QUEUE_SIZE;
+        sessions.count--;
+        sessions.active++;
+        sessions.live[worker] = sock;
+    }
+    pthread_mutex_unlock(&sessions.lock);
+    return sock;
+}
+
+void endSession(int worker) {
+    pthread_mutex_lock(&sessions.lock);
+    sessions.active--;
+    sessions.live[worker] = INVALID_SOCKET;
+    pthread_mutex_unlock(&sessions.lock);
+}
+
+// Over the limit: say so instead of leaving the connection waiting for a worker
+void refuseSession(socket_t sock) {
+    char reply[96];
+    int length = snprintf(reply, sizeof(reply), "ERR %d %s\n", (int)BANK_ERR_BUSY, bankStatusMessage(BANK_ERR_BUSY));
+    netSendAll(sock, reply, length);
+    closeSocket(sock);
+}
+
+// Answer requests on one connection until it closes
+void serveSession(socket_t sock) {
+    NetConn conn;
+    BankSession session;
+    bankInitSession(&session, 0);
+    char request[BANK_REQUEST_MAX];
+    char *reply = (char *)malloc(BANK_REPLY_MAX);
+    netInitConn(&conn, sock);
+    int length;
+    while ((length = netReadLine(&conn, request, sizeof(request))) > 0 || length == NET_LINE_TOO_LONG) {
+        if (strncmp(request, "quit", 4) == 0 && (request[4] == '\0' || request[4] == '\r' || request[4] == '\n')) break;
+        if (length == NET_LINE_TOO_LONG) {
+            snprintf(reply, BANK_REPLY_MAX, "ERR %d Request too long!\n", (int)BANK_ERR_INVALID);
+        } else {
+            bankExecute(&session, request, reply, BANK_REPLY_MAX);
+        }
+        if (!netSendAll(sock, reply, (int)strlen(reply))) break;
+    }
+    free(reply);
+    closeSocket(sock);
+}
+
+void *sessionWorker(void *arg) {
+    int worker = (int)(size_t)arg;
+    socket_t sock;
+    while ((sock = popSession(worker)) != INVALID_SOCKET) {
+        serveSession(sock);
+        endSession(worker);
+    }
+    return NULL;
+}
+
+// Metrics endpoint - a minimal HTTP/1.0 responder: whatever the request path, it answers with
+// bankMetricsText() and closes the connection, which is all a Prometheus scrape needs. Scrapes
+// are answered one at a time, so one that stalls or never ends its headers is dropped.
+void *metricsServer(void *arg) {
+    (void)arg;
+    char *body = (char *)malloc(METRICS_REPLY_MAX);
+    char line[BANK_REQUEST_MAX];
+    char header[160];
+    while (!serverStopping) {
+        socket_t client = accept(metricsSocket, NULL, NULL);
+        if (client == INVALID_SOCKET) continue;
+        metricsClient = client;
+        if (serverStopping) shutdown(client, SHUT_RD);  // the stop signal may have come before
+        netSetReadTimeout(client, METRICS_READ_TIMEOUT_MS);
+        NetConn conn;
+        netInitConn(&conn, client);
+        // Skip the request line and headers, up to the blank line
+        int lineLength = 0;
+        for (int lines = 0; lines < METRICS_HEADER_LINES; lines++) {
+            lineLength = netReadLine(&conn, line, sizeof(line));
+            if (lineLength == NET_LINE_TOO_LONG) continue;
+            if (lineLength <= 0 || line[0] == '\r' || line[0] == '\n') break;
+        }
+        if (lineLength > 0 && (line[0] == '\r' || line[0] == '\n')) {
+            int length = bankMetricsText(body, METRICS_REPLY_MAX);
+            int headerLength = snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\nConnection: close\r\n\r\n", length);
+            if (netSendAll(client, header, headerLength)) netSendAll(client, body, length);
+        }
+        metricsClient = INVALID_SOCKET;
+        closeSocket(client);
+    }
+    free(body);
+    return NULL;
+}
+
+void handleStopSignal(int sig) {
+    (void)sig;
+    serverStopping = 1;
+    // Unblocks accept() in the main thread and the metrics thread; closed once they are done
+    if (listenSocket != INVALID_SOCKET) shutdown(listenSocket, SHUT_RDWR);
+    if (metricsSocket != INVALID_SOCKET) shutdown(metricsSocket, SHUT_RDWR);
+    // and a scrape the metrics thread is waiting on
+    socket_t client = metricsClient;
+    if (client != INVALID_SOCKET) shutdown(client, SHUT_RD);
+}
+
+// Load the -v rules file; returns 0 if it cannot be read or has a malformed line
+int loadVelocityRules(const char *path) {
+    char *text = bankReadTextFile(path);
+    if (!text) {
+        fprintf(stderr, "bank_server: cannot read %s\n", path);
+        return 0;
+    }
+    int rules = bankSetVelocityRules(text);
+    free(text);
+    if (rules < 0) {
+        fprintf(stderr, "bank_server: %s:%d: bad velocity rule\n", path, -rules);
+        return 0;
+    }
+    fprintf(stderr, "bank_server: %d velocity rules from %s\n", rules, path);
+    return 1;
+}
+
+// Load the -i rates file; returns 0 if it cannot be read or has a malformed line
+int loadInterestRates(const char *path) {
+    char *text = bankReadTextFile(path);
+    if (!text) {
+        fprintf(stderr, "bank_server: cannot read %s\n", path);
+        return 0;
+    }
+    int classes = bankSetInterestRates(text);
+    free(text);
+    if (classes < 0) {
+        fprintf(stderr, "bank_server: %s:%d: bad interest rate line\n", path, -classes);
+        return 0;
+    }
+    fprintf(stderr, "bank_server: interest rates for %d classes from %s\n", classes, path);
+    return 1;
+}
+
+// Load the -k admin key - the first line of the file; returns 0 if it cannot be read or is empty
+int loadAdminKey(const char *path) {
+    char key[128];
+    FILE *file = fopen(path, "r");
+    if (!file || !fgets(key, sizeof(key), file)) {
+        if (file) fclose(file);
+        fprintf(stderr, "bank_server: cannot read %s\n", path);
+        return 0;
+    }
+    fclose(file);
+    key[strcspn(key, "\r\n")] = '\0';
+    if (key[0] == '\0' || strchr(key, ',')) {
+        fprintf(stderr, "bank_server: %s: the admin key must be one line with no commas\n", path);
+        return 0;
+    }
+    bankSetAdminKey(key);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int port = BANK_SERVER_PORT;
+    int threads = 32;
+    int commitMicros = -1;
+    int commitBatch = 0;
+    int retentionDays = 30;
+    int metricsPort = 0;
+    int checkpointSeconds = 300;
+    int archiveDays = 90;
+    const char *rulesPath = NULL;
+    const char *ratesPath = NULL;
+    const char *keyPath = NULL;
+    const char *metricsFile = NULL;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-p") == 0) port = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-t") == 0) threads = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-g") == 0) commitMicros = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-b") == 0) commitBatch = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-r") == 0) retentionDays = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-m") == 0) metricsPort = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-M") == 0) metricsFile = argv[i + 1];
+        else if (strcmp(argv[i], "-c") == 0) checkpointSeconds = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-a") == 0) archiveDays = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-v") == 0) rulesPath = argv[i + 1];
+        else if (strcmp(argv[i], "-i") == 0) ratesPath = argv[i + 1];
+        else if (strcmp(argv[i], "-k") == 0) keyPath = argv[i + 1];
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SESSION_QUEUE_SIZE) threads = SESSION_QUEUE_SIZE;
+
+    if (!netStartup() || !bankOpen()) {
+        fprintf(stderr, "bank_server: cannot open account data\n");
+        return 1;
+    }
+    if ((rulesPath && !loadVelocityRules(rulesPath)) || (ratesPath && !loadInterestRates(ratesPath)) || (keyPath && !loadAdminKey(keyPath))) {
+        bankClose();
+        return 1;
+    }
+    bankSetGroupCommit(commitMicros, commitBatch);
+    bankSetDeleteRetention((long long)retentionDays * 24 * 3600);
+    bankSetArchiveAge((long long)archiveDays * 24 * 3600);
+    bankStartCompactor(3600);
+    if (checkpointSeconds > 0) bankStartCheckpoints(checkpointSeconds);
+    if (metricsFile) bankStartMetricsFile(metricsFile, METRICS_FILE_SECONDS);
+
+    listenSocket = listenLoopback(port);
+    if (listenSocket == INVALID_SOCKET) {
+        fprintf(stderr, "bank_server: cannot listen on port %d\n", port);
+        bankClose();
+        return 1;
+    }
+    if (metricsPort > 0) {
+        metricsSocket = listenLoopback(metricsPort);
+        if (metricsSocket == INVALID_SOCKET) {
+            fprintf(stderr, "bank_server: cannot listen on metrics port %d\n", metricsPort);
+            closeSocket(listenSocket);
+            bankClose();
+            return 1;
+        }
+    }
+    signal(SIGINT, handleStopSignal);
+    signal(SIGTERM, handleStopSignal);
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);  // a client hanging up mid-reply must not kill the server
+#endif
+
+    sessions.limit = threads;
+    sessions.live = (socket_t *)malloc(threads * sizeof(socket_t));
+    for (int i = 0; i < threads; i++) sessions.live[i] = INVALID_SOCKET;
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&workers[i], NULL, sessionWorker, (void *)(size_t)i);
+    }
+    pthread_t metricsThread;
+    if (metricsSocket != INVALID_SOCKET) pthread_create(&metricsThread, NULL, metricsServer, NULL);
+    fprintf(stderr, "bank_server: %d accounts, listening on %s:%d with %d workers\n", bankAccountCount(), BANK_SERVER_HOST, port, threads);
+
+    while (!serverStopping) {
+        socket_t client = accept(listenSocket, NULL, NULL);
+        if (client == INVALID_SOCKET) continue;
+        int one = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+        if (!pushSession(client)) refuseSession(client);
+    }
+
+    // Workers finish the request in hand; shutting down the read side wakes the ones waiting in
+    // netReadLine for the next, so the joins do not wait for clients to hang up. Then flush everything.
+    pthread_mutex_lock(&sessions.lock);
+    sessions.stopping = 1;
+    for (int i = 0; i < threads; i++) {
+        if (sessions.live[i] != INVALID_SOCKET) shutdown(sessions.live[i], SHUT_RD);
+    }
+    pthread_cond_broadcast(&sessions.notEmpty);
+    pthread_mutex_unlock(&sessions.lock);
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    // Connections no worker picked up before the stop
+    for (; sessions.count > 0; sessions.count--) {
+        closeSocket(sessions.items[sessions.head]);
+        sessions.head = (sessions.head + 1) % SESSION_QUEUE_SIZE;
+    }
+    free(sessions.live);
+    if (metricsSocket != INVALID_SOCKET) {
+        pthread_join(metricsThread, NULL);
+        closeSocket(metricsSocket);
+    }
+    closeSocket(listenSocket);
+    if (commitMicros >= 0) fprintf(stderr, "bank_server: %lld group commits\n", bankCommitRounds());
+    bankClose();
+    fprintf(stderr, "bank_server: stopped\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <string.h>
+#include "bank_velocity.h"
+#include "bank_money.h"
+
+const char *velocityDefaultRules =
+    "# A large withdrawal, or several smaller ones adding up to it, needs the security question\n"
+    "withdraw amount 50000 verify\n"
+    "withdraw sum/24h 50000 verify\n";
+
+// Bucket width in seconds, ring length and first bucket of each window
+const int velocityWidth[VELOCITY_WINDOWS] = {300, 3600, 86400};
+const int velocityRing[VELOCITY_WINDOWS] = {12, 24, 7};
+const int velocityOffset[VELOCITY_WINDOWS] = {0, 12, 36};
+
+void velocityReset(VelocityState *state) {
+    memset(state, 0, sizeof(*state));
+}
+
+VelocityFlow *velocityFlow(VelocityState *state, int type) {
+    return &state->flows[type == LEDGER_WITHDRAW ? 1 : 0];
+}
+
+// Slide window w forward so bucket b is its newest, expiring the buckets that fall out. At most
+// one ring's worth of buckets is cleared, however long the account was idle.
+void velocityAdvance(VelocityFlow *flow, int w, long long b) {
+    long long newest = flow->newest[w];
+    if (b <= newest) return;
+    int ring = velocityRing[w];
+    int *counts = flow->bucketCount + velocityOffset[w];
+    long long *sums = flow->bucketSum + velocityOffset[w];
+    if (b - newest >= ring) {
+        memset(counts, 0, ring * sizeof(int));
+        memset(sums, 0, ring * sizeof(long long));
+        flow->count[w] = 0;
+        flow->sum[w] = 0;
+    } else {
+        for (long long k = newest + 1; k <= b; k++) {
+            int slot = (int)(k % ring);
+            flow->count[w] -= counts[slot];
+            flow->sum[w] -= sums[slot];
+            counts[slot] = 0;
+            sums[slot] = 0;
+        }
+    }
+    flow->newest[w] = b;
+}
+
+VelocityAction velocityCheck(VelocityState *state, const VelocityRule *rules, int ruleCount, int type, long long t, long long cents) {
+    VelocityFlow *flow = velocityFlow(state, type);
+    for (int w = 0; w < VELOCITY_WINDOWS; w++) velocityAdvance(flow, w, t / velocityWidth[w]);
+    int action = VELOCITY_ALLOW;
+    for (int i = 0; i < ruleCount; i++) {
+        const VelocityRule *rule = &rules[i];
+        if (rule->type != type || rule->action <= action) continue;
+        long long value = cents;
+        if (rule->measure == VELOCITY_COUNT) value = flow->count[rule->window] + 1;
+        if (rule->measure == VELOCITY_SUM) value = flow->sum[rule->window] + cents;
+        if (value > rule->limit) action = rule->action;
+    }
+    return (VelocityAction)action;
+}
+
+void velocityRecord(VelocityState *state, int type, long long t, long long cents) {
+    VelocityFlow *flow = velocityFlow(state, type);
+    for (int w = 0; w < VELOCITY_WINDOWS; w++) {
+        long long b = t / velocityWidth[w];
+        velocityAdvance(flow, w, b);
+        if (b <= flow->newest[w] - velocityRing[w]) continue;  // older than the window
+        int slot = velocityOffset[w] + (int)(b % velocityRing[w]);
+        flow->bucketCount[slot]++;
+        flow->bucketSum[slot] += cents;
+        flow->count[w]++;
+        flow->sum[w] += cents;
+    }
+}
+
+// Parse one rule line; returns 1 for a rule, 0 for a blank or comment line, -1 if malformed
+int velocityParseLine(const char *line, VelocityRule *rule) {
+    char type[16], measure[16], limitText[32], action[16];
+    int n = sscanf(line, " %15s %15s %31s %15s", type, measure, limitText, action);
+    if (n <= 0 || type[0] == '#') return 0;
+    // Amounts and sums are rupees read exactly as paisa, like every other amount
+    Money limit = 0;
+    int used = n == 4 ? moneyParse(limitText, &limit) : 0;
+    if (used == 0 || limitText[used] != '\0' || limit < 0) return -1;
+
+    if (strcmp(type, "deposit") == 0) rule->type = LEDGER_DEPOSIT;
+    else if (strcmp(type, "withdraw") == 0) rule->type = LEDGER_WITHDRAW;
+    else return -1;
+
+    if (strcmp(action, "verify") == 0) rule->action = VELOCITY_VERIFY;
+    else if (strcmp(action, "block") == 0) rule->action = VELOCITY_BLOCK;
+    else return -1;
+
+    rule->window = VELOCITY_HOUR;
+    if (strcmp(measure, "amount") == 0) {
+        rule->measure = VELOCITY_AMOUNT;
+    } else {
+        char *slash = strchr(measure, '/');
+        if (!slash) return -1;
+        *slash = '\0';
+        if (strcmp(measure, "count") == 0) rule->measure = VELOCITY_COUNT;
+        else if (strcmp(measure, "sum") == 0) rule->measure = VELOCITY_SUM;
+        else return -1;
+        if (strcmp(slash + 1, "1h") == 0) rule->window = VELOCITY_HOUR;
+        else if (strcmp(slash + 1, "24h") == 0) rule->window = VELOCITY_DAY;
+        else if (strcmp(slash + 1, "7d") == 0) rule->window = VELOCITY_WEEK;
+        else return -1;
+    }
+    // Counts are whole numbers of postings
+    if (rule->measure == VELOCITY_COUNT && limit % 100 != 0) return -1;
+    rule->limit = rule->measure == VELOCITY_COUNT ? limit / 100 : limit;
+    return 1;
+}
+
+int velocityParseRules(const char *text, VelocityRule *rules, int max) {
+    int count = 0;
+    int lineNumber = 0;
+    while (*text) {
+        const char *end = strchr(text, '\n');
+        int length = end ? (int)(end - text) : (int)strlen(text);
+        char line[128];
+        lineNumber++;
+        if (length >= (int)sizeof(line)) return -lineNumber;
+        memcpy(line, text, length);
+        line[length] = '\0';
+        VelocityRule rule;
+        int parsed = velocityParseLine(line, &rule);
+        if (parsed < 0 || (parsed > 0 && count == max)) return -lineNumber;
+        if (parsed > 0) rules[count++] = rule;
+        text += end ? length + 1 : length;
+    }
+    return count;
+}
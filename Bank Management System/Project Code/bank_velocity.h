@@ -0,0 +1,75 @@
+#ifndef BANK_VELOCITY_H
+#define BANK_VELOCITY_H
+
+#include "bank_core.h"
+
+// Velocity rules - per-account totals of deposits and withdrawals over the last hour, day and
+// week, and rules on them that allow a posting, ask for the security question or block it.
+// Each window is a ring of time buckets (5 minutes for the hour, 1 hour for the day, 1 day for
+// the week) with a running count and sum, so recording or checking an event costs O(1). Windows
+// slide a bucket at a time: they cover the last 55-60 minutes, 23-24 hours and 6-7 days.
+
+typedef enum {
+    VELOCITY_ALLOW = 0,
+    VELOCITY_VERIFY,       // allowed once the customer answers the security question
+    VELOCITY_BLOCK
+} VelocityAction;
+
+typedef enum {
+    VELOCITY_HOUR = 0,
+    VELOCITY_DAY,
+    VELOCITY_WEEK,
+    VELOCITY_WINDOWS
+} VelocityWindow;
+
+typedef enum {
+    VELOCITY_AMOUNT = 0,   // the posting on its own
+    VELOCITY_COUNT,        // postings in the window, this one included
+    VELOCITY_SUM           // amount posted in the window, this one included
+} VelocityMeasure;
+
+#define VELOCITY_BUCKETS 43    // 12 + 24 + 7
+#define VELOCITY_MAX_RULES 32
+
+typedef struct {
+    int type;              // LEDGER_DEPOSIT or LEDGER_WITHDRAW
+    int measure;           // VelocityMeasure
+    int window;            // VelocityWindow, unused for VELOCITY_AMOUNT
+    long long limit;       // cents for amount and sum; the rule fires above it
+    int action;            // VelocityAction
+} VelocityRule;
+
+// Totals of one direction (deposits or withdrawals) of one account
+typedef struct {
+    long long newest[VELOCITY_WINDOWS];   // bucket number (time / bucket width) of each window's newest bucket
+    int count[VELOCITY_WINDOWS];
+    long long sum[VELOCITY_WINDOWS];      // cents
+    int bucketCount[VELOCITY_BUCKETS];
+    long long bucketSum[VELOCITY_BUCKETS];
+} VelocityFlow;
+
+typedef struct {
+    VelocityFlow flows[2];  // deposits, withdrawals
+} VelocityState;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rules used until bankSetVelocityRules() replaces them
+extern const char *velocityDefaultRules;
+
+void velocityReset(VelocityState *state);
+// Strictest action of the rules that a posting of cents at time t would break
+VelocityAction velocityCheck(VelocityState *state, const VelocityRule *rules, int ruleCount, int type, long long t, long long cents);
+// Add a posting to the windows; postings older than a window are left out of it
+void velocityRecord(VelocityState *state, int type, long long t, long long cents);
+// Parse one rule per line ("withdraw sum/24h 50000 verify", '#' starts a comment) into rules;
+// returns how many, or -(line number) of the first malformed line
+int velocityParseRules(const char *text, VelocityRule *rules, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif